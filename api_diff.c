@@ -0,0 +1,395 @@
+/**
+ * Module api_diff.c
+ * This module implements the comparison of snapshots declared in api_diff.h.
+ * The functions of the old snapshot are put into an open addressing table keyed by their join
+ * hash; every function of the new snapshot is then looked up once, so the join is linear.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "api_diff.h"
+#include "utility.h"
+
+/* Flags naming the parts of a function that changed. */
+#define CHANGED_PROTOTYPE 1
+#define CHANGED_PARAMS    2
+#define CHANGED_RETURN    4
+
+/**
+ * @struct SymbolChange
+ * @brief A function present in both snapshots whose documentation differs.
+ */
+typedef struct {
+    const SnapshotSymbol *oldSymbol;  /* The function in the old snapshot. */
+    const SnapshotSymbol *newSymbol;  /* The function in the new snapshot. */
+    int changes;                      /* Combination of the CHANGED_ flags. */
+} SymbolChange;
+
+/**
+ * @struct ChangeReport
+ * @brief Result of the comparison of two snapshots.
+ */
+typedef struct {
+    const SnapshotSymbol **added;     /* Functions only in the new snapshot, in its order. */
+    int addedCount;                   /* Count of added functions. */
+    const SnapshotSymbol **removed;   /* Functions only in the old snapshot, in its order. */
+    int removedCount;                 /* Count of removed functions. */
+    SymbolChange *changed;            /* Changed functions, in the order of the new snapshot. */
+    int changedCount;                 /* Count of changed functions. */
+} ChangeReport;
+
+/**
+ * Parses the name of a report format.
+ * @param name The name of the format ("latex", "markdown" or "json").
+ * @param format Pointer to the variable receiving the format.
+ * @return true if the name is valid, false otherwise.
+ */
+bool parseDiffFormat(const char *name, DiffFormat *format) {
+    if (strcmp(name, "latex") == 0) {
+        *format = DIFF_LATEX;
+    }
+    else if (strcmp(name, "markdown") == 0) {
+        *format = DIFF_MARKDOWN;
+    }
+    else if (strcmp(name, "json") == 0) {
+        *format = DIFF_JSON;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Checks if two functions are the same function, which happens when module and identifier match.
+ * @param a The first function.
+ * @param b The second function.
+ * @return true if the functions have the same key.
+ */
+static bool sameSymbol(const SnapshotSymbol *a, const SnapshotSymbol *b) {
+    return a->keyHash == b->keyHash && strcmp(a->identifier, b->identifier) == 0 && strcmp(a->module, b->module) == 0;
+}
+
+/**
+ * Joins two snapshots and sorts their functions into added, removed and changed ones.
+ * @param oldSnapshot The snapshot of the old version.
+ * @param newSnapshot The snapshot of the new version.
+ * @param report The report to fill; its arrays must be released with freeChangeReport.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool buildChangeReport(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, ChangeReport *report) {
+    int oldCount = snapshotSymbolCount(oldSnapshot);
+    int newCount = snapshotSymbolCount(newSnapshot);
+    size_t slotCount = 1;
+    while (slotCount < 2 * (size_t)oldCount) {
+        slotCount <<= 1;
+    }
+
+    int *slots = calloc(slotCount, sizeof(int));          /* Old function index + 1, 0 if empty */
+    bool *matched = calloc(oldCount > 0 ? oldCount : 1, sizeof(bool));
+    memset(report, 0, sizeof(ChangeReport));
+    report->added = malloc((newCount > 0 ? newCount : 1) * sizeof(SnapshotSymbol *));
+    report->removed = malloc((oldCount > 0 ? oldCount : 1) * sizeof(SnapshotSymbol *));
+    report->changed = malloc((newCount > 0 ? newCount : 1) * sizeof(SymbolChange));
+    if (slots == NULL || matched == NULL || report->added == NULL || report->removed == NULL || report->changed == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for the comparison\n");
+        free(slots);
+        free(matched);
+        return false;
+    }
+
+    /* Index the old functions by their join hash */
+    for (int i = 0; i < oldCount; i++) {
+        size_t slot = snapshotSymbolAt(oldSnapshot, i)->keyHash & (slotCount - 1);
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        slots[slot] = i + 1;
+    }
+
+    /* Look up every new function; one that is not found was added */
+    for (int i = 0; i < newCount; i++) {
+        const SnapshotSymbol *newSymbol = snapshotSymbolAt(newSnapshot, i);
+        const SnapshotSymbol *oldSymbol = NULL;
+        for (size_t slot = newSymbol->keyHash & (slotCount - 1); slots[slot] != 0; slot = (slot + 1) & (slotCount - 1)) {
+            int index = slots[slot] - 1;
+            if (!matched[index] && sameSymbol(snapshotSymbolAt(oldSnapshot, index), newSymbol)) {
+                matched[index] = true;
+                oldSymbol = snapshotSymbolAt(oldSnapshot, index);
+                break;
+            }
+        }
+        if (oldSymbol == NULL) {
+            report->added[report->addedCount++] = newSymbol;
+            continue;
+        }
+
+        int changes = 0;
+        if (oldSymbol->prototypeHash != newSymbol->prototypeHash) {
+            changes |= CHANGED_PROTOTYPE;
+        }
+        if (oldSymbol->paramsHash != newSymbol->paramsHash) {
+            changes |= CHANGED_PARAMS;
+        }
+        if (oldSymbol->returnHash != newSymbol->returnHash) {
+            changes |= CHANGED_RETURN;
+        }
+        if (changes != 0) {
+            SymbolChange *change = &report->changed[report->changedCount++];
+            change->oldSymbol = oldSymbol;
+            change->newSymbol = newSymbol;
+            change->changes = changes;
+        }
+    }
+
+    /* Old functions that no new function matched were removed */
+    for (int i = 0; i < oldCount; i++) {
+        if (!matched[i]) {
+            report->removed[report->removedCount++] = snapshotSymbolAt(oldSnapshot, i);
+        }
+    }
+    free(slots);
+    free(matched);
+    return true;
+}
+
+/**
+ * Releases the arrays of a report.
+ * @param report The report to release.
+ */
+static void freeChangeReport(ChangeReport *report) {
+    free(report->added);
+    free(report->removed);
+    free(report->changed);
+}
+
+/**
+ * Writes a list of added or removed functions as a LaTeX section.
+ * @param outputFile The file where the section is written.
+ * @param title Title of the section.
+ * @param symbols The functions.
+ * @param count Count of functions.
+ */
+static void writeLaTeXSymbolList(FILE *outputFile, const char *title, const SnapshotSymbol **symbols, int count) {
+    fprintf(outputFile, "\\subsection{%s (%d)}\n\n", title, count);
+    if (count == 0) {
+        fprintf(outputFile, "None.\n\n");
+        return;
+    }
+    fprintf(outputFile, "\\begin{itemize}\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(outputFile, "\\item \\texttt{");
+        writeLaTeXString(outputFile, symbols[i]->prototype);
+        fprintf(outputFile, "} in \\texttt{");
+        writeLaTeXString(outputFile, symbols[i]->module);
+        fprintf(outputFile, "}\n");
+    }
+    fprintf(outputFile, "\\end{itemize}\n\n");
+}
+
+/**
+ * Writes the old and new text of a changed part of a function as a LaTeX description item.
+ * @param outputFile The file where the item is written.
+ * @param label Name of the changed part.
+ * @param oldText Text in the old version.
+ * @param newText Text in the new version.
+ */
+static void writeLaTeXFieldChange(FILE *outputFile, const char *label, const char *oldText, const char *newText) {
+    fprintf(outputFile, "\\item[%s] ", label);
+    writeLaTeXString(outputFile, oldText[0] ? oldText : "(none)");
+    fprintf(outputFile, " $\\rightarrow$ ");
+    writeLaTeXString(outputFile, newText[0] ? newText : "(none)");
+    fprintf(outputFile, "\n");
+}
+
+/**
+ * Writes a report as a complete LaTeX document.
+ * @param report The report.
+ * @param outputFile The file where the document is written.
+ */
+static void writeLaTeXReport(const ChangeReport *report, FILE *outputFile) {
+    fprintf(outputFile, "\\documentclass{article}\n");
+    fprintf(outputFile, "\\begin{document}\n\n");
+    fprintf(outputFile, "\\section{API changes}\n\n");
+    writeLaTeXSymbolList(outputFile, "Added functions", report->added, report->addedCount);
+    writeLaTeXSymbolList(outputFile, "Removed functions", report->removed, report->removedCount);
+
+    fprintf(outputFile, "\\subsection{Changed functions (%d)}\n\n", report->changedCount);
+    if (report->changedCount == 0) {
+        fprintf(outputFile, "None.\n\n");
+    }
+    for (int i = 0; i < report->changedCount; i++) {
+        const SymbolChange *change = &report->changed[i];
+        fprintf(outputFile, "\\subsubsection{\\texttt{");
+        writeLaTeXString(outputFile, change->newSymbol->identifier);
+        fprintf(outputFile, "} in \\texttt{");
+        writeLaTeXString(outputFile, change->newSymbol->module);
+        fprintf(outputFile, "}}\n\n\\begin{description}\n");
+        if (change->changes & CHANGED_PROTOTYPE) {
+            writeLaTeXFieldChange(outputFile, "Prototype:", change->oldSymbol->prototype, change->newSymbol->prototype);
+        }
+        if (change->changes & CHANGED_PARAMS) {
+            writeLaTeXFieldChange(outputFile, "Parameters:", change->oldSymbol->params, change->newSymbol->params);
+        }
+        if (change->changes & CHANGED_RETURN) {
+            writeLaTeXFieldChange(outputFile, "Return value:", change->oldSymbol->returnText, change->newSymbol->returnText);
+        }
+        fprintf(outputFile, "\\end{description}\n\n");
+    }
+    fprintf(outputFile, "\\end{document}\n");
+}
+
+/**
+ * Writes a list of added or removed functions as a Markdown section.
+ * @param outputFile The file where the section is written.
+ * @param title Title of the section.
+ * @param symbols The functions.
+ * @param count Count of functions.
+ */
+static void writeMarkdownSymbolList(FILE *outputFile, const char *title, const SnapshotSymbol **symbols, int count) {
+    fprintf(outputFile, "## %s (%d)\n\n", title, count);
+    if (count == 0) {
+        fprintf(outputFile, "None.\n\n");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(outputFile, "- `%s` in `%s`\n", symbols[i]->prototype, symbols[i]->module);
+    }
+    fprintf(outputFile, "\n");
+}
+
+/**
+ * Writes the old and new text of a changed part of a function as a Markdown list item.
+ * @param outputFile The file where the item is written.
+ * @param label Name of the changed part.
+ * @param oldText Text in the old version.
+ * @param newText Text in the new version.
+ */
+static void writeMarkdownFieldChange(FILE *outputFile, const char *label, const char *oldText, const char *newText) {
+    fprintf(outputFile, "- %s %s → %s\n", label, oldText[0] ? oldText : "(none)", newText[0] ? newText : "(none)");
+}
+
+/**
+ * Writes a report as a Markdown document.
+ * @param report The report.
+ * @param outputFile The file where the document is written.
+ */
+static void writeMarkdownReport(const ChangeReport *report, FILE *outputFile) {
+    fprintf(outputFile, "# API changes\n\n");
+    writeMarkdownSymbolList(outputFile, "Added functions", report->added, report->addedCount);
+    writeMarkdownSymbolList(outputFile, "Removed functions", report->removed, report->removedCount);
+
+    fprintf(outputFile, "## Changed functions (%d)\n\n", report->changedCount);
+    if (report->changedCount == 0) {
+        fprintf(outputFile, "None.\n\n");
+    }
+    for (int i = 0; i < report->changedCount; i++) {
+        const SymbolChange *change = &report->changed[i];
+        fprintf(outputFile, "### `%s` in `%s`\n\n", change->newSymbol->identifier, change->newSymbol->module);
+        if (change->changes & CHANGED_PROTOTYPE) {
+            fprintf(outputFile, "- Prototype: `%s` → `%s`\n", change->oldSymbol->prototype, change->newSymbol->prototype);
+        }
+        if (change->changes & CHANGED_PARAMS) {
+            writeMarkdownFieldChange(outputFile, "Parameters:", change->oldSymbol->params, change->newSymbol->params);
+        }
+        if (change->changes & CHANGED_RETURN) {
+            writeMarkdownFieldChange(outputFile, "Return value:", change->oldSymbol->returnText, change->newSymbol->returnText);
+        }
+        fprintf(outputFile, "\n");
+    }
+}
+
+/**
+ * Writes a list of added or removed functions as a JSON array.
+ * @param outputFile The file where the array is written.
+ * @param symbols The functions.
+ * @param count Count of functions.
+ */
+static void writeJSONSymbolList(FILE *outputFile, const SnapshotSymbol **symbols, int count) {
+    fprintf(outputFile, "[");
+    for (int i = 0; i < count; i++) {
+        fprintf(outputFile, "%s\n    {\"module\":", i > 0 ? "," : "");
+        writeJSONString(outputFile, symbols[i]->module);
+        fprintf(outputFile, ",\"name\":");
+        writeJSONString(outputFile, symbols[i]->identifier);
+        fprintf(outputFile, ",\"prototype\":");
+        writeJSONString(outputFile, symbols[i]->prototype);
+        fprintf(outputFile, "}");
+    }
+    fprintf(outputFile, "%s]", count > 0 ? "\n  " : "");
+}
+
+/**
+ * Writes the old and new text of a changed part of a function as a JSON member.
+ * @param outputFile The file where the member is written.
+ * @param key Name of the member.
+ * @param oldText Text in the old version.
+ * @param newText Text in the new version.
+ * @param first true for the first member of the object.
+ */
+static void writeJSONFieldChange(FILE *outputFile, const char *key, const char *oldText, const char *newText, bool first) {
+    fprintf(outputFile, "%s\"%s\":{\"old\":", first ? "" : ",", key);
+    writeJSONString(outputFile, oldText);
+    fprintf(outputFile, ",\"new\":");
+    writeJSONString(outputFile, newText);
+    fprintf(outputFile, "}");
+}
+
+/**
+ * Writes a report as a JSON object.
+ * @param report The report.
+ * @param outputFile The file where the object is written.
+ */
+static void writeJSONReport(const ChangeReport *report, FILE *outputFile) {
+    fprintf(outputFile, "{\n  \"added\":");
+    writeJSONSymbolList(outputFile, report->added, report->addedCount);
+    fprintf(outputFile, ",\n  \"removed\":");
+    writeJSONSymbolList(outputFile, report->removed, report->removedCount);
+    fprintf(outputFile, ",\n  \"changed\":[");
+    for (int i = 0; i < report->changedCount; i++) {
+        const SymbolChange *change = &report->changed[i];
+        fprintf(outputFile, "%s\n    {\"module\":", i > 0 ? "," : "");
+        writeJSONString(outputFile, change->newSymbol->module);
+        fprintf(outputFile, ",\"name\":");
+        writeJSONString(outputFile, change->newSymbol->identifier);
+        fprintf(outputFile, ",\"changes\":{");
+        bool first = true;
+        if (change->changes & CHANGED_PROTOTYPE) {
+            writeJSONFieldChange(outputFile, "prototype", change->oldSymbol->prototype, change->newSymbol->prototype, first);
+            first = false;
+        }
+        if (change->changes & CHANGED_PARAMS) {
+            writeJSONFieldChange(outputFile, "params", change->oldSymbol->params, change->newSymbol->params, first);
+            first = false;
+        }
+        if (change->changes & CHANGED_RETURN) {
+            writeJSONFieldChange(outputFile, "return", change->oldSymbol->returnText, change->newSymbol->returnText, first);
+        }
+        fprintf(outputFile, "}}");
+    }
+    fprintf(outputFile, "%s]\n}\n", report->changedCount > 0 ? "\n  " : "");
+}
+
+/**
+ * Compares two snapshots and writes a report of the changes.
+ * @param oldSnapshot The snapshot of the old version.
+ * @param newSnapshot The snapshot of the new version.
+ * @param format Format of the report.
+ * @param outputFile The file where the report is written.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool diffSnapshots(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, DiffFormat format, FILE *outputFile) {
+    ChangeReport report;
+    if (!buildChangeReport(oldSnapshot, newSnapshot, &report)) {
+        freeChangeReport(&report);
+        return false;
+    }
+
+    switch (format) {
+        case DIFF_LATEX:    writeLaTeXReport(&report, outputFile); break;
+        case DIFF_MARKDOWN: writeMarkdownReport(&report, outputFile); break;
+        case DIFF_JSON:     writeJSONReport(&report, outputFile); break;
+    }
+    freeChangeReport(&report);
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+ * Module api_diff.h
+ * This module contains function prototypes for comparing two snapshots of documented functions
+ * and reporting the functions that were added, removed or changed between them.
+ */
+
+#ifndef API_DIFF_H
+#define API_DIFF_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "snapshot.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @enum DiffFormat
+ * @brief Format of the change report.
+ */
+typedef enum {
+    DIFF_LATEX,        /* A complete LaTeX document. */
+    DIFF_MARKDOWN,     /* A Markdown document. */
+    DIFF_JSON          /* A JSON object with the arrays added, removed and changed. */
+} DiffFormat;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Parses the name of a report format.
+ * @param name The name of the format ("latex", "markdown" or "json").
+ * @param format Pointer to the variable receiving the format.
+ * @return true if the name is valid, false otherwise.
+ */
+bool parseDiffFormat(const char *name, DiffFormat *format);
+
+/**
+ * Compares two snapshots and writes a report of the changes.
+ * Functions are joined by the hash of their module and identifier, so the comparison takes
+ * time linear in the number of functions. A function is changed if its prototype, its
+ * documented parameters or its documented return value differ.
+ * @param oldSnapshot The snapshot of the old version.
+ * @param newSnapshot The snapshot of the new version.
+ * @param format Format of the report.
+ * @param outputFile The file where the report is written.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool diffSnapshots(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, DiffFormat format, FILE *outputFile);
+
+#endif
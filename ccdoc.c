@@ -0,0 +1,576 @@
+/**
+ * Module ccdoc.c
+ * This module implements the public libccdoc interface declared in ccdoc.h.
+ * It creates and destroys contexts and forwards the work to the processing and formatting modules.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ccdoc.h"
+#include "context.h"
+#include "file_processing.h"
+#include "latex_formatting.h"
+#include "dependencies.h"
+#include "symbol_index.h"
+#include "doc_server.h"
+#include "param_check.h"
+
+/**
+ * Creates a new context with no processed files and no documented functions.
+ * @return Pointer to the new context, or NULL if memory could not be allocated.
+ */
+ccdoc_context *ccdocCreate(void) {
+    ccdoc_context *ctx = calloc(1, sizeof(ccdoc_context));
+    if (ctx == NULL) {
+        fprintf(stderr, "Error: Unable to allocate documentation context\n");
+        return NULL;
+    }
+    ctx->order = ORDER_INCLUDE;
+    ctx->prefetch = false;
+    defaultResourceLimits(&ctx->limits);
+    return ctx;
+}
+
+/**
+ * Releases a context and everything it owns.
+ * @param ctx The context to destroy, may be NULL.
+ */
+void ccdocDestroy(ccdoc_context *ctx) {
+    free(ctx);
+}
+
+/**
+ * Creates an empty cache of parsed files that contexts can share.
+ * @return Pointer to the cache, or NULL if memory could not be allocated.
+ */
+ccdoc_cache *ccdocCacheCreate(void) {
+    return createParseCache();
+}
+
+/**
+ * Releases a cache; all contexts using it must have been destroyed.
+ * @param cache The cache to destroy, may be NULL.
+ */
+void ccdocCacheDestroy(ccdoc_cache *cache) {
+    destroyParseCache(cache);
+}
+
+/**
+ * Reads how many files were taken from the cache and how many had to be parsed.
+ * @param cache The cache.
+ * @param hits Pointer to the variable receiving the number of files taken from the cache.
+ * @param misses Pointer to the variable receiving the number of files that were parsed.
+ */
+void ccdocCacheStatistics(ccdoc_cache *cache, long *hits, long *misses) {
+    *hits = 0;
+    *misses = 0;
+    if (cache != NULL) {
+        parseCacheStatistics(cache, hits, misses);
+    }
+}
+
+/**
+ * Makes a context take parse results from a shared cache and store new ones in it.
+ * @param ctx The context to configure.
+ * @param cache The cache, or NULL to parse every file.
+ */
+void ccdocSetCache(ccdoc_context *ctx, ccdoc_cache *cache) {
+    if (ctx != NULL) {
+        ctx->cache = cache;
+    }
+}
+
+/**
+ * Reads a tar archive into memory.
+ * @param stream The stream holding the archive, opened in binary mode.
+ * @param maxMemberSize Byte limit of the parser, 0 for none.
+ * @return Pointer to the archive, or NULL if the stream is not a valid archive.
+ */
+ccdoc_archive *ccdocArchiveRead(FILE *stream, size_t maxMemberSize) {
+    if (stream == NULL) {
+        return NULL;
+    }
+    return readTarArchive(stream, maxMemberSize);
+}
+
+/**
+ * Releases an archive; all contexts using it must have been destroyed.
+ * @param archive The archive to destroy, may be NULL.
+ */
+void ccdocArchiveDestroy(ccdoc_archive *archive) {
+    destroyArchive(archive);
+}
+
+/**
+ * Makes a context read its files from an archive instead of the file system.
+ * @param ctx The context to configure.
+ * @param archive The archive, or NULL to read files from the file system.
+ */
+void ccdocSetArchive(ccdoc_context *ctx, const ccdoc_archive *archive) {
+    if (ctx != NULL) {
+        ctx->archive = archive;
+    }
+}
+
+/**
+ * Processes every source and header file of the attached archive.
+ * Members that were already processed as includes are skipped.
+ * @param ctx The context collecting the documentation.
+ * @return true if the files were processed, false if no archive is attached.
+ */
+bool ccdocAddArchive(ccdoc_context *ctx) {
+    if (ctx == NULL || ctx->archive == NULL) {
+        return false;
+    }
+    bool processed = true;
+    for (int i = 0; i < archiveMemberCount(ctx->archive); i++) {
+        const char *name = archiveMemberName(ctx->archive, i);
+        const char *extension = strrchr(name, '.');
+        if (extension != NULL && (strcmp(extension, ".c") == 0 || strcmp(extension, ".h") == 0) &&
+            !processFile(ctx, name)) {
+            processed = false;
+        }
+    }
+    return processed;
+}
+
+/**
+ * Attaches a timeline recorder to a context.
+ * @param ctx The context whose work is recorded.
+ * @param trace The recorder, or NULL to disable tracing.
+ * @param threadId Identifier of the thread using the context.
+ */
+void ccdocSetTrace(ccdoc_context *ctx, Trace *trace, int threadId) {
+    if (ctx != NULL) {
+        ctx->trace = trace;
+        ctx->traceThreadId = threadId;
+    }
+}
+
+/**
+ * Selects the order in which ccdocEmit writes the documented functions.
+ * @param ctx The context to configure.
+ * @param order The order of the emitted functions.
+ */
+void ccdocSetOrder(ccdoc_context *ctx, OutputOrder order) {
+    if (ctx != NULL) {
+        ctx->order = order;
+    }
+}
+
+/**
+ * Enables or disables reading ahead the files the parser is going to open next.
+ * @param ctx The context to configure.
+ * @param enabled true to read ahead included files, false to read every file on demand.
+ */
+void ccdocSetPrefetch(ccdoc_context *ctx, bool enabled) {
+    if (ctx != NULL) {
+        ctx->prefetch = enabled;
+    }
+}
+
+/**
+ * Sets the limits applied to every file processed by a context.
+ * @param ctx The context to configure.
+ * @param limits The limits; a value of 0 disables a limit.
+ */
+void ccdocSetLimits(ccdoc_context *ctx, const ResourceLimits *limits) {
+    if (ctx != NULL && limits != NULL) {
+        ctx->limits = *limits;
+    }
+}
+
+/**
+ * Reads the counters of the files processed by a context so far.
+ * @param ctx The context to query.
+ * @param statistics Pointer to the structure receiving the counters.
+ */
+void ccdocStatistics(const ccdoc_context *ctx, RunStatistics *statistics) {
+    if (ctx != NULL && statistics != NULL) {
+        *statistics = ctx->statistics;
+    }
+}
+
+/**
+ * Processes a source or header file, following its includes.
+ * @param ctx The context collecting the documentation.
+ * @param filename The name of the file to process.
+ * @return true if the file was processed, false if it could not be opened.
+ */
+bool ccdocAddFile(ccdoc_context *ctx, const char *filename) {
+    if (ctx == NULL || filename == NULL) {
+        return false;
+    }
+    return processFile(ctx, filename);
+}
+
+/**
+ * Processes source code held in memory, following its includes.
+ * @param ctx The context collecting the documentation.
+ * @param name The name under which the buffer is recorded as a module.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ * @return true if the buffer was processed, false otherwise.
+ */
+bool ccdocAddBuffer(ccdoc_context *ctx, const char *name, const char *data, size_t size) {
+    if (ctx == NULL || name == NULL || (data == NULL && size > 0)) {
+        return false;
+    }
+    return processBuffer(ctx, name, data, size);
+}
+
+/**
+ * Returns the number of documented functions collected so far.
+ * @param ctx The context to query.
+ * @return The number of symbols.
+ */
+int ccdocSymbolCount(const ccdoc_context *ctx) {
+    return ctx ? ctx->functionCount : 0;
+}
+
+/**
+ * Returns a documented function by its position in the collection.
+ * @param ctx The context to query.
+ * @param index Position of the symbol.
+ * @return Pointer to the documentation, or NULL if the index is out of range.
+ */
+const FunctionDoc *ccdocSymbolAt(const ccdoc_context *ctx, int index) {
+    if (ctx == NULL || index < 0 || index >= ctx->functionCount) {
+        return NULL;
+    }
+    return &ctx->functionDocs[index];
+}
+
+/**
+ * Rebuilds the symbol index of a context if the collection has changed since it was built.
+ * @param ctx The context whose index is updated.
+ */
+static void updateSymbolIndex(ccdoc_context *ctx) {
+    if (!ctx->symbolIndex.valid) {
+        buildSymbolIndex(&ctx->symbolIndex, ctx->functionDocs, ctx->functionCount);
+    }
+}
+
+/**
+ * Finds the documented functions with the given identifier.
+ * @param ctx The context to query.
+ * @param name The function identifier, without return type and parameters.
+ * @param indices Array receiving the positions of the matching symbols.
+ * @param maxIndices Size of the indices array.
+ * @return The number of positions stored in the array.
+ */
+int ccdocFindSymbols(ccdoc_context *ctx, const char *name, int *indices, int maxIndices) {
+    if (ctx == NULL || name == NULL || indices == NULL) {
+        return 0;
+    }
+    updateSymbolIndex(ctx);
+    return findSymbols(&ctx->symbolIndex, name, indices, maxIndices);
+}
+
+/**
+ * Finds the documented functions whose identifier starts with the given prefix.
+ * @param ctx The context to query.
+ * @param prefix The prefix of the function identifier.
+ * @param indices Array receiving the positions of the matching symbols, in identifier order.
+ * @param maxIndices Size of the indices array.
+ * @return The number of positions stored in the array.
+ */
+int ccdocFindSymbolsByPrefix(ccdoc_context *ctx, const char *prefix, int *indices, int maxIndices) {
+    if (ctx == NULL || prefix == NULL || indices == NULL) {
+        return 0;
+    }
+    updateSymbolIndex(ctx);
+    return findSymbolsByPrefix(&ctx->symbolIndex, prefix, indices, maxIndices);
+}
+
+/**
+ * Parses a changed file again and replaces the documentation of its module.
+ * @param ctx The context holding the documentation.
+ * @param filename The name of the changed file.
+ * @return true if the file was processed, false if it could not be opened.
+ */
+bool ccdocReparseFile(ccdoc_context *ctx, const char *filename) {
+    if (ctx == NULL || filename == NULL) {
+        return false;
+    }
+    return reprocessFile(ctx, filename);
+}
+
+/**
+ * Reports whether an invalid comment format was detected in any processed file.
+ * @param ctx The context to query.
+ * @return true if an invalid comment was found, false otherwise.
+ */
+bool ccdocHasInvalidComments(const ccdoc_context *ctx) {
+    return ctx && ctx->invalidCommentFormat;
+}
+
+/**
+ * Writes the files read from disk so far as a make rule for the given target.
+ * Buffers added with ccdocAddBuffer are not files and are left out.
+ * @param ctx The context that read the files.
+ * @param outputFile The file where the rule is written.
+ * @param target The document generated from the files.
+ * @param phonyTargets true to add an empty rule for every dependency except the first.
+ * @return true on success, false if an argument is invalid.
+ */
+bool ccdocWriteDependencies(const ccdoc_context *ctx, FILE *outputFile, const char *target, bool phonyTargets) {
+    if (ctx == NULL || outputFile == NULL || target == NULL) {
+        return false;
+    }
+    writeDependencyRule(outputFile, target, ctx->dependencies, ctx->dependencyCount, phonyTargets);
+    return true;
+}
+
+/**
+ * Serves symbol queries on a Unix domain socket until the process receives SIGINT or SIGTERM.
+ * @param ctx The context holding the documentation.
+ * @param socketPath The path of the socket to create.
+ * @return true after a clean shutdown, false if the socket could not be created.
+ */
+bool ccdocServe(ccdoc_context *ctx, const char *socketPath) {
+    if (ctx == NULL || socketPath == NULL) {
+        return false;
+    }
+    return runDocServer(ctx, socketPath);
+}
+
+/**
+ * Checks the documented parameters of every function against its prototype, in the order
+ * selected with ccdocSetOrder.
+ * @param ctx The context holding the documentation.
+ * @param reportFile The file where the problems are reported.
+ * @return The number of reported problems, or -1 if an argument is invalid or memory could not be allocated.
+ */
+int ccdocCheckParams(const ccdoc_context *ctx, FILE *reportFile) {
+    if (ctx == NULL || reportFile == NULL) {
+        return -1;
+    }
+    int *indices = malloc((ctx->functionCount ? ctx->functionCount : 1) * sizeof(int));
+    if (indices == NULL || !orderFunctions(ctx->functionDocs, ctx->functionCount, ctx->order, indices)) {
+        free(indices);
+        return -1;
+    }
+
+    long long checkStart = traceBegin(ctx->trace);
+    int problems = 0;
+    for (int i = 0; i < ctx->functionCount; i++) {
+        problems += checkFunctionParams(&ctx->functionDocs[indices[i]], reportFile);
+    }
+    traceEnd(ctx->trace, ctx->traceThreadId, "checkParams", "check", NULL, checkStart);
+    free(indices);
+    return problems;
+}
+
+/**
+ * Reads an output template from a stream and compiles it.
+ * @param inputFile The stream holding the template.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if it could not be read or is invalid.
+ */
+ccdoc_template *ccdocTemplateRead(FILE *inputFile, const char *name) {
+    if (inputFile == NULL || name == NULL) {
+        return NULL;
+    }
+    return readTemplate(inputFile, name);
+}
+
+/**
+ * Releases a template loaded by ccdocTemplateRead.
+ * @param outputTemplate The template to destroy, may be NULL.
+ */
+void ccdocTemplateDestroy(ccdoc_template *outputTemplate) {
+    destroyTemplate(outputTemplate);
+}
+
+/**
+ * Selects the template ccdocEmit formats the documentation with.
+ * @param ctx The context to configure.
+ * @param outputTemplate The template, or NULL for the built-in LaTeX layout.
+ */
+void ccdocSetTemplate(ccdoc_context *ctx, const ccdoc_template *outputTemplate) {
+    if (ctx != NULL) {
+        ctx->outputTemplate = outputTemplate;
+    }
+}
+
+/**
+ * Creates an empty set of macros for evaluating preprocessor conditionals.
+ * @return Pointer to the set, or NULL if memory could not be allocated.
+ */
+ccdoc_macros *ccdocMacrosCreate(void) {
+    return createMacros();
+}
+
+/**
+ * Defines a macro, as the -D option of a compiler does.
+ * @param macros The set of macros.
+ * @param definition "NAME" to define NAME as 1, or "NAME=value".
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocMacrosDefine(ccdoc_macros *macros, const char *definition) {
+    if (macros == NULL || definition == NULL) {
+        return false;
+    }
+    return applyMacroOption(macros, definition, true);
+}
+
+/**
+ * Undefines a macro, as the -U option of a compiler does.
+ * @param macros The set of macros.
+ * @param name Name of the macro.
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocMacrosUndefine(ccdoc_macros *macros, const char *name) {
+    if (macros == NULL || name == NULL) {
+        return false;
+    }
+    return applyMacroOption(macros, name, false);
+}
+
+/**
+ * Releases a set of macros created by ccdocMacrosCreate.
+ * @param macros The set to destroy, may be NULL.
+ */
+void ccdocMacrosDestroy(ccdoc_macros *macros) {
+    destroyMacros(macros);
+}
+
+/**
+ * Selects the macros the preprocessor conditionals of the parsed files are evaluated with.
+ * @param ctx The context to configure.
+ * @param macros The set of macros, or NULL to evaluate the conditionals with no macros defined.
+ */
+void ccdocSetMacros(ccdoc_context *ctx, const ccdoc_macros *macros) {
+    if (ctx != NULL) {
+        ctx->macros = macros;
+    }
+}
+
+/**
+ * Writes the collected documentation as a complete LaTeX document.
+ * The functions are written in the order selected with ccdocSetOrder, formatted with the
+ * template selected with ccdocSetTemplate or, without one, in the built-in layout.
+ * @param ctx The context holding the documentation.
+ * @param outputFile The file where the document is written.
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocEmit(const ccdoc_context *ctx, FILE *outputFile) {
+    if (ctx == NULL || outputFile == NULL) {
+        return false;
+    }
+
+    bool isNewModule = true;
+    char lastModuleName[256] = "";
+    char tracedModuleName[256] = "";
+    long long emitStart = traceBegin(ctx->trace);
+    long long moduleStart = 0;
+
+    /* Determine the emission order without moving the documented functions */
+    long long orderStart = traceBegin(ctx->trace);
+    int *indices = malloc((ctx->functionCount ? ctx->functionCount : 1) * sizeof(int));
+    if (indices == NULL || !orderFunctions(ctx->functionDocs, ctx->functionCount, ctx->order, indices)) {
+        free(indices);
+        traceEnd(ctx->trace, ctx->traceThreadId, "orderFunctions", "order", NULL, orderStart);
+        traceEnd(ctx->trace, ctx->traceThreadId, "emit", "emit", NULL, emitStart);
+        return false;
+    }
+    traceEnd(ctx->trace, ctx->traceThreadId, "orderFunctions", "order", NULL, orderStart);
+
+    /* Start the document */
+    if (ctx->outputTemplate) {
+        renderTemplateSection(ctx->outputTemplate, TEMPLATE_BEGIN, NULL, outputFile);
+    } else {
+        startLaTeXDocument(outputFile);
+    }
+
+    /* Loop through all documented functions and format them */
+    for (int i = 0; i < ctx->functionCount; i++) {
+        long long functionStart = traceBegin(ctx->trace);
+        if (ctx->outputTemplate) {
+            formatWithTemplate(ctx, ctx->outputTemplate, &ctx->functionDocs[indices[i]], outputFile, &isNewModule, lastModuleName);
+        } else {
+            formatToLaTeX(ctx, &ctx->functionDocs[indices[i]], outputFile, &isNewModule, lastModuleName);
+        }
+
+        /* Record one span per module, closed when the next module starts */
+        if (ctx->trace && strcmp(tracedModuleName, lastModuleName) != 0) {
+            if (tracedModuleName[0] != '\0') {
+                traceEnd(ctx->trace, ctx->traceThreadId, "emitModule", "emit", tracedModuleName, moduleStart);
+            }
+            strcpy(tracedModuleName, lastModuleName);
+            moduleStart = functionStart;
+        }
+    }
+    if (tracedModuleName[0] != '\0') {
+        traceEnd(ctx->trace, ctx->traceThreadId, "emitModule", "emit", tracedModuleName, moduleStart);
+    }
+
+    /* Finalize the document */
+    if (ctx->outputTemplate) {
+        renderTemplateSection(ctx->outputTemplate, TEMPLATE_END, NULL, outputFile);
+    } else {
+        endLaTeXDocument(outputFile);
+    }
+    traceEnd(ctx->trace, ctx->traceThreadId, "emit", "emit", NULL, emitStart);
+    free(indices);
+    return true;
+}
+
+/**
+ * Saves the documented functions as a binary snapshot, in emission order.
+ * @param ctx The context holding the documentation.
+ * @param outputFile The file where the snapshot is written, opened in binary mode.
+ * @return true on success, false if the snapshot could not be written.
+ */
+bool ccdocSaveSnapshot(const ccdoc_context *ctx, FILE *outputFile) {
+    if (ctx == NULL || outputFile == NULL) {
+        return false;
+    }
+    int *indices = malloc((ctx->functionCount ? ctx->functionCount : 1) * sizeof(int));
+    if (indices == NULL || !orderFunctions(ctx->functionDocs, ctx->functionCount, ctx->order, indices)) {
+        free(indices);
+        return false;
+    }
+    bool saved = writeSnapshot(outputFile, ctx->functionDocs, indices, ctx->functionCount);
+    free(indices);
+    return saved;
+}
+
+/**
+ * Loads a snapshot saved by ccdocSaveSnapshot.
+ * @param inputFile The file holding the snapshot, opened in binary mode.
+ * @param name Name of the file, used in error messages.
+ * @return Pointer to the snapshot, or NULL if the file is not a valid snapshot.
+ */
+ccdoc_snapshot *ccdocSnapshotRead(FILE *inputFile, const char *name) {
+    if (inputFile == NULL) {
+        return NULL;
+    }
+    return readSnapshot(inputFile, name ? name : "snapshot");
+}
+
+/**
+ * Releases a snapshot.
+ * @param snapshot The snapshot to destroy, may be NULL.
+ */
+void ccdocSnapshotDestroy(ccdoc_snapshot *snapshot) {
+    destroySnapshot(snapshot);
+}
+
+/**
+ * Writes a report of the functions added, removed or changed between two snapshots.
+ * @param oldSnapshot The snapshot of the old version.
+ * @param newSnapshot The snapshot of the new version.
+ * @param format Format of the report.
+ * @param outputFile The file where the report is written.
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocDiffSnapshots(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, DiffFormat format, FILE *outputFile) {
+    if (oldSnapshot == NULL || newSnapshot == NULL || outputFile == NULL) {
+        return false;
+    }
+    return diffSnapshots(oldSnapshot, newSnapshot, format, outputFile);
+}
@@ -0,0 +1,364 @@
+/**
+ * Module ccdoc.h
+ * @brief Public interface of the libccdoc library.
+ * All state of a documentation run is owned by a ccdoc_context object. A context is not
+ * thread-safe and must be used by one thread at a time, but distinct contexts share no
+ * state and may be used concurrently from different threads. The only objects that may be
+ * shared between contexts are a ccdoc_cache and a Trace, both of which are thread-safe, and
+ * a ccdoc_archive, a ccdoc_template and a ccdoc_macros, which are only read.
+ */
+
+#ifndef CCDOC_H
+#define CCDOC_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "data_structures.h"
+#include "trace.h"
+#include "ordering.h"
+#include "parse_cache.h"
+#include "tar_archive.h"
+#include "resource_limits.h"
+#include "snapshot.h"
+#include "api_diff.h"
+#include "output_template.h"
+#include "conditionals.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct ccdoc_context
+ * @brief Opaque handle owning the processed files and the collected documentation.
+ */
+typedef struct ccdoc_context ccdoc_context;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Creates a new, empty context.
+ * @return Pointer to the new context, or NULL if memory could not be allocated.
+ */
+ccdoc_context *ccdocCreate(void);
+
+/**
+ * Releases a context and everything it owns.
+ * @param ctx The context to destroy, may be NULL.
+ */
+void ccdocDestroy(ccdoc_context *ctx);
+
+/**
+ * Creates an empty cache of parsed files that contexts can share.
+ * @return Pointer to the cache, or NULL if memory could not be allocated.
+ */
+ccdoc_cache *ccdocCacheCreate(void);
+
+/**
+ * Releases a cache; all contexts using it must have been destroyed.
+ * @param cache The cache to destroy, may be NULL.
+ */
+void ccdocCacheDestroy(ccdoc_cache *cache);
+
+/**
+ * Reads how many files were taken from the cache and how many had to be parsed.
+ * @param cache The cache.
+ * @param hits Pointer to the variable receiving the number of files taken from the cache.
+ * @param misses Pointer to the variable receiving the number of files that were parsed.
+ */
+void ccdocCacheStatistics(ccdoc_cache *cache, long *hits, long *misses);
+
+/**
+ * Makes a context take parse results from a shared cache and store new ones in it.
+ * A file is parsed only once per canonical path and content, whichever context reads it first,
+ * so all contexts sharing a cache should use the same resource limits.
+ * The cache is not owned by the context and must outlive it.
+ * @param ctx The context to configure.
+ * @param cache The cache, or NULL to parse every file.
+ */
+void ccdocSetCache(ccdoc_context *ctx, ccdoc_cache *cache);
+
+/**
+ * Reads a tar archive, for instance from standard input, into memory.
+ * Members larger than maxMemberSize are cut like files on disk, so parsing them reports the limit.
+ * @param stream The stream holding the archive, opened in binary mode.
+ * @param maxMemberSize Byte limit of the parser, 0 for none.
+ * @return Pointer to the archive, or NULL if the stream is not a valid archive.
+ */
+ccdoc_archive *ccdocArchiveRead(FILE *stream, size_t maxMemberSize);
+
+/**
+ * Releases an archive; all contexts using it must have been destroyed.
+ * @param archive The archive to destroy, may be NULL.
+ */
+void ccdocArchiveDestroy(ccdoc_archive *archive);
+
+/**
+ * Makes a context read its files from an archive instead of the file system.
+ * File names given to ccdocAddFile and the files named by includes are then looked up
+ * among the members of the archive. The archive is not owned by the context and must outlive it.
+ * @param ctx The context to configure.
+ * @param archive The archive, or NULL to read files from the file system.
+ */
+void ccdocSetArchive(ccdoc_context *ctx, const ccdoc_archive *archive);
+
+/**
+ * Processes every source and header file of the attached archive, in the order of the archive.
+ * @param ctx The context collecting the documentation.
+ * @return true if the files were processed, false if no archive is attached.
+ */
+bool ccdocAddArchive(ccdoc_context *ctx);
+
+/**
+ * Attaches a timeline recorder to a context.
+ * The recorder is not owned by the context and must outlive it.
+ * @param ctx The context whose work is recorded.
+ * @param trace The recorder, or NULL to disable tracing.
+ * @param threadId Identifier of the thread using the context, written to every span.
+ */
+void ccdocSetTrace(ccdoc_context *ctx, Trace *trace, int threadId);
+
+/**
+ * Selects the order in which ccdocEmit writes the documented functions.
+ * The default is ORDER_INCLUDE, which keeps the functions in the order the files were read.
+ * @param ctx The context to configure.
+ * @param order The order of the emitted functions.
+ */
+void ccdocSetOrder(ccdoc_context *ctx, OutputOrder order);
+
+/**
+ * Enables or disables reading ahead the files the parser is going to open next.
+ * Prefetching is disabled by default.
+ * @param ctx The context to configure.
+ * @param enabled true to read ahead included files, false to read every file on demand.
+ */
+void ccdocSetPrefetch(ccdoc_context *ctx, bool enabled);
+
+/**
+ * Sets the limits applied to every file processed by a context.
+ * A file over the byte, line or time limit is parsed only up to the limit, an over-long comment
+ * block is skipped and files nested deeper than the include depth limit are not processed.
+ * Every hit prints a warning and is counted in the statistics. Defaults are set by ccdocCreate.
+ * @param ctx The context to configure.
+ * @param limits The limits; a value of 0 disables a limit.
+ */
+void ccdocSetLimits(ccdoc_context *ctx, const ResourceLimits *limits);
+
+/**
+ * Reads the counters of the files processed by a context so far.
+ * @param ctx The context to query.
+ * @param statistics Pointer to the structure receiving the counters.
+ */
+void ccdocStatistics(const ccdoc_context *ctx, RunStatistics *statistics);
+
+/**
+ * Processes a source or header file, following its includes.
+ * @param ctx The context collecting the documentation.
+ * @param filename The name of the file to process.
+ * @return true if the file was processed, false if it could not be opened.
+ */
+bool ccdocAddFile(ccdoc_context *ctx, const char *filename);
+
+/**
+ * Processes source code held in memory, following its includes.
+ * @param ctx The context collecting the documentation.
+ * @param name The name under which the buffer is recorded as a module.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ * @return true if the buffer was processed, false otherwise.
+ */
+bool ccdocAddBuffer(ccdoc_context *ctx, const char *name, const char *data, size_t size);
+
+/**
+ * Returns the number of documented functions collected so far.
+ * @param ctx The context to query.
+ * @return The number of symbols.
+ */
+int ccdocSymbolCount(const ccdoc_context *ctx);
+
+/**
+ * Returns a documented function by its position in the collection.
+ * Positions follow the order in which the functions were discovered, not the emission order.
+ * @param ctx The context to query.
+ * @param index Position of the symbol, from 0 to ccdocSymbolCount() - 1.
+ * @return Pointer to the documentation, or NULL if the index is out of range.
+ */
+const FunctionDoc *ccdocSymbolAt(const ccdoc_context *ctx, int index);
+
+/**
+ * Finds the documented functions with the given identifier.
+ * @param ctx The context to query.
+ * @param name The function identifier, without return type and parameters.
+ * @param indices Array receiving the positions of the matching symbols.
+ * @param maxIndices Size of the indices array.
+ * @return The number of positions stored in the array.
+ */
+int ccdocFindSymbols(ccdoc_context *ctx, const char *name, int *indices, int maxIndices);
+
+/**
+ * Finds the documented functions whose identifier starts with the given prefix.
+ * @param ctx The context to query.
+ * @param prefix The prefix of the function identifier.
+ * @param indices Array receiving the positions of the matching symbols, in identifier order.
+ * @param maxIndices Size of the indices array.
+ * @return The number of positions stored in the array.
+ */
+int ccdocFindSymbolsByPrefix(ccdoc_context *ctx, const char *prefix, int *indices, int maxIndices);
+
+/**
+ * Parses a changed file again and replaces the documentation of its module.
+ * Positions returned by earlier queries are invalid afterwards.
+ * @param ctx The context holding the documentation.
+ * @param filename The name of the changed file.
+ * @return true if the file was processed, false if it could not be opened.
+ */
+bool ccdocReparseFile(ccdoc_context *ctx, const char *filename);
+
+/**
+ * Reports whether an invalid comment format was detected in any processed file.
+ * @param ctx The context to query.
+ * @return true if an invalid comment was found, false otherwise.
+ */
+bool ccdocHasInvalidComments(const ccdoc_context *ctx);
+
+/**
+ * Writes the files read from disk so far as a make rule for the given target.
+ * @param ctx The context that read the files.
+ * @param outputFile The file where the rule is written.
+ * @param target The document generated from the files.
+ * @param phonyTargets true to add an empty rule for every dependency except the first, as with -MP.
+ * @return true on success, false if an argument is invalid.
+ */
+bool ccdocWriteDependencies(const ccdoc_context *ctx, FILE *outputFile, const char *target, bool phonyTargets);
+
+/**
+ * Serves symbol queries on a Unix domain socket until the process receives SIGINT or SIGTERM.
+ * The protocol is described in doc_server.h.
+ * @param ctx The context holding the documentation.
+ * @param socketPath The path of the socket to create.
+ * @return true after a clean shutdown, false if the socket could not be created.
+ */
+bool ccdocServe(ccdoc_context *ctx, const char *socketPath);
+
+/**
+ * Saves the documented functions as a binary snapshot, in the order ccdocEmit writes them.
+ * Two snapshots can later be compared with ccdocDiffSnapshots without parsing the sources again.
+ * @param ctx The context holding the documentation.
+ * @param outputFile The file where the snapshot is written, opened in binary mode.
+ * @return true on success, false if the snapshot could not be written.
+ */
+bool ccdocSaveSnapshot(const ccdoc_context *ctx, FILE *outputFile);
+
+/**
+ * Loads a snapshot saved by ccdocSaveSnapshot.
+ * @param inputFile The file holding the snapshot, opened in binary mode.
+ * @param name Name of the file, used in error messages.
+ * @return Pointer to the snapshot, or NULL if the file is not a valid snapshot.
+ */
+ccdoc_snapshot *ccdocSnapshotRead(FILE *inputFile, const char *name);
+
+/**
+ * Releases a snapshot.
+ * @param snapshot The snapshot to destroy, may be NULL.
+ */
+void ccdocSnapshotDestroy(ccdoc_snapshot *snapshot);
+
+/**
+ * Writes a report of the functions added, removed or changed between two snapshots.
+ * Functions are joined by module and identifier in time linear in their number.
+ * @param oldSnapshot The snapshot of the old version.
+ * @param newSnapshot The snapshot of the new version.
+ * @param format Format of the report.
+ * @param outputFile The file where the report is written.
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocDiffSnapshots(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, DiffFormat format, FILE *outputFile);
+
+/**
+ * Checks the documented parameters of every function against its prototype.
+ * Parameters without an @param entry, @param entries naming no parameter and entries in a
+ * different order than the prototype are reported, one line each. A function documented in
+ * both a header and its source file is checked once, with the entries of both.
+ * @param ctx The context holding the documentation.
+ * @param reportFile The file where the problems are reported.
+ * @return The number of reported problems, or -1 if an argument is invalid or memory could not be allocated.
+ */
+int ccdocCheckParams(const ccdoc_context *ctx, FILE *reportFile);
+
+/**
+ * Reads an output template from a stream and compiles it.
+ * The template syntax is described in output_template.h.
+ * @param inputFile The stream holding the template.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if it could not be read or is invalid.
+ */
+ccdoc_template *ccdocTemplateRead(FILE *inputFile, const char *name);
+
+/**
+ * Releases a template loaded by ccdocTemplateRead.
+ * @param outputTemplate The template to destroy, may be NULL.
+ */
+void ccdocTemplateDestroy(ccdoc_template *outputTemplate);
+
+/**
+ * Selects the template ccdocEmit formats the documentation with.
+ * The template is not owned by the context and must outlive it.
+ * @param ctx The context to configure.
+ * @param outputTemplate The template, or NULL for the built-in LaTeX layout.
+ */
+void ccdocSetTemplate(ccdoc_context *ctx, const ccdoc_template *outputTemplate);
+
+/**
+ * Creates an empty set of macros for evaluating preprocessor conditionals.
+ * @return Pointer to the set, or NULL if memory could not be allocated.
+ */
+ccdoc_macros *ccdocMacrosCreate(void);
+
+/**
+ * Defines a macro, as the -D option of a compiler does.
+ * @param macros The set of macros.
+ * @param definition "NAME" to define NAME as 1, or "NAME=value".
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocMacrosDefine(ccdoc_macros *macros, const char *definition);
+
+/**
+ * Undefines a macro, as the -U option of a compiler does.
+ * @param macros The set of macros.
+ * @param name Name of the macro.
+ * @return true on success, false if an argument is invalid or memory could not be allocated.
+ */
+bool ccdocMacrosUndefine(ccdoc_macros *macros, const char *name);
+
+/**
+ * Releases a set of macros created by ccdocMacrosCreate.
+ * @param macros The set to destroy, may be NULL.
+ */
+void ccdocMacrosDestroy(ccdoc_macros *macros);
+
+/**
+ * Selects the macros the preprocessor conditionals of the parsed files are evaluated with.
+ * Regions disabled by #if, #ifdef, #ifndef, #elif and #else are skipped without being parsed.
+ * The set is not owned by the context, must outlive it and must not change while it is used.
+ * @param ctx The context to configure.
+ * @param macros The set of macros, or NULL to evaluate the conditionals with no macros defined.
+ */
+void ccdocSetMacros(ccdoc_context *ctx, const ccdoc_macros *macros);
+
+/**
+ * Writes the collected documentation as a complete LaTeX document, or in the layout of the
+ * template selected with ccdocSetTemplate.
+ * @param ctx The context holding the documentation.
+ * @param outputFile The file where the document is written.
+ * @return true on success, false if an argument is invalid.
+ */
+bool ccdocEmit(const ccdoc_context *ctx, FILE *outputFile);
+
+#endif 
@@ -0,0 +1,970 @@
+/**
+ * Module conditionals.c
+ * This module implements the preprocessor conditionals declared in conditionals.h.
+ * Macros are kept in an open-addressing hash table. The macros of a file are a second table
+ * laid over the predefined ones, in which #undef leaves an entry marked as undefined, so the
+ * predefined table is never changed and every file starts from it again.
+ * Expressions are evaluated by recursive descent, expanding object-like macros as they are met.
+ * A name with no entry in either table may be defined by an included header, so the evaluation
+ * remembers it, and a condition whose value depends on such a name is not decided.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "conditionals.h"
+#include "parse_cache.h"
+
+/* Maximal nesting of macros expanded within each other in an expression. */
+#define MAX_EXPANSION_DEPTH 16
+
+/**
+ * @struct MacroDefinition
+ * @brief One macro of a set.
+ */
+typedef struct {
+    char *name;                       /* Name of the macro. */
+    char *value;                      /* Replacement text, NULL for a function-like macro. */
+    bool defined;                     /* false if the entry records an #undef. */
+} MacroDefinition;
+
+struct ccdoc_macros {
+    MacroDefinition *entries;         /* The macros in the order they were first defined. */
+    int count;                        /* Count of macros. */
+    int capacity;                     /* Allocated count of macros. */
+    int *slots;                       /* Indices into entries, -1 for an empty slot. */
+    int slotCount;                    /* Number of slots, a power of two. */
+    uint64_t fingerprint;             /* Hash of all definitions made so far. */
+};
+
+/**
+ * @struct Expression
+ * @brief State of the evaluation of one #if or #elif expression.
+ */
+typedef struct {
+    const char *p;                    /* Next character to read. */
+    const ConditionalState *state;    /* Macros the expression refers to. */
+    int depth;                        /* Nesting of macro expansions. */
+    bool error;                       /* The expression is malformed. */
+    const char *unknown;              /* First name the value depends on that the file never saw, NULL if none. */
+} Expression;
+
+/**
+ * Checks if a character can start an identifier.
+ * @param c The character.
+ * @return true for letters and underscores.
+ */
+static bool isIdentifierStart(char c) {
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+/**
+ * Checks if a character can be part of an identifier.
+ * @param c The character.
+ * @return true for letters, digits and underscores.
+ */
+static bool isIdentifierChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * Copies a text into newly allocated memory.
+ * @param text The text, not necessarily null-terminated.
+ * @param length Length of the text.
+ * @return The null-terminated copy, or NULL if memory could not be allocated.
+ */
+static char *copyText(const char *text, size_t length) {
+    char *copy = malloc(length + 1);
+    if (copy != NULL) {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+/**
+ * Creates an empty set of macros.
+ * @return Pointer to the set, or NULL if memory could not be allocated.
+ */
+ccdoc_macros *createMacros(void) {
+    ccdoc_macros *macros = calloc(1, sizeof(ccdoc_macros));
+    if (macros == NULL) {
+        return NULL;
+    }
+    macros->slotCount = 64;
+    macros->slots = malloc((size_t)macros->slotCount * sizeof(int));
+    if (macros->slots == NULL) {
+        free(macros);
+        return NULL;
+    }
+    memset(macros->slots, -1, (size_t)macros->slotCount * sizeof(int));
+    return macros;
+}
+
+/**
+ * Releases a set of macros.
+ * @param macros The set to destroy, may be NULL.
+ */
+void destroyMacros(ccdoc_macros *macros) {
+    if (macros == NULL) {
+        return;
+    }
+    for (int i = 0; i < macros->count; i++) {
+        free(macros->entries[i].name);
+        free(macros->entries[i].value);
+    }
+    free(macros->entries);
+    free(macros->slots);
+    free(macros);
+}
+
+/**
+ * Finds a macro in a set.
+ * @param macros The set of macros, may be NULL.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @return Pointer to the entry, which may record an #undef, or NULL if the set has none.
+ */
+static MacroDefinition *findMacro(const ccdoc_macros *macros, const char *name, size_t length) {
+    if (macros == NULL || macros->count == 0) {
+        return NULL;
+    }
+    size_t mask = (size_t)macros->slotCount - 1;
+    size_t slot = (size_t)hashContent(name, length) & mask;
+    while (macros->slots[slot] >= 0) {
+        MacroDefinition *entry = &macros->entries[macros->slots[slot]];
+        if (strncmp(entry->name, name, length) == 0 && entry->name[length] == '\0') {
+            return entry;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Doubles the slots of a set and inserts all macros again.
+ * @param macros The set of macros.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool growSlots(ccdoc_macros *macros) {
+    int slotCount = macros->slotCount * 2;
+    int *slots = malloc((size_t)slotCount * sizeof(int));
+    if (slots == NULL) {
+        return false;
+    }
+    memset(slots, -1, (size_t)slotCount * sizeof(int));
+    for (int i = 0; i < macros->count; i++) {
+        const char *name = macros->entries[i].name;
+        size_t slot = (size_t)hashContent(name, strlen(name)) & (size_t)(slotCount - 1);
+        while (slots[slot] >= 0) {
+            slot = (slot + 1) & (size_t)(slotCount - 1);
+        }
+        slots[slot] = i;
+    }
+    free(macros->slots);
+    macros->slots = slots;
+    macros->slotCount = slotCount;
+    return true;
+}
+
+/**
+ * Defines, redefines or undefines a macro in a set.
+ * @param macros The set of macros.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @param value The replacement text, NULL for a function-like macro; ignored when undefining.
+ * @param defined true to define the macro, false to record an #undef.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool setMacro(ccdoc_macros *macros, const char *name, size_t length, const char *value, bool defined) {
+    char *copiedValue = NULL;
+    if (defined && value != NULL && (copiedValue = copyText(value, strlen(value))) == NULL) {
+        return false;
+    }
+
+    MacroDefinition *entry = findMacro(macros, name, length);
+    if (entry == NULL) {
+        if (2 * (macros->count + 1) > macros->slotCount && !growSlots(macros)) {
+            free(copiedValue);
+            return false;
+        }
+        if (macros->count == macros->capacity) {
+            int capacity = macros->capacity ? macros->capacity * 2 : 16;
+            MacroDefinition *grown = realloc(macros->entries, (size_t)capacity * sizeof(MacroDefinition));
+            if (grown == NULL) {
+                free(copiedValue);
+                return false;
+            }
+            macros->entries = grown;
+            macros->capacity = capacity;
+        }
+        entry = &macros->entries[macros->count];
+        if ((entry->name = copyText(name, length)) == NULL) {
+            free(copiedValue);
+            return false;
+        }
+        entry->value = NULL;
+        size_t slot = (size_t)hashContent(name, length) & (size_t)(macros->slotCount - 1);
+        while (macros->slots[slot] >= 0) {
+            slot = (slot + 1) & (size_t)(macros->slotCount - 1);
+        }
+        macros->slots[slot] = macros->count++;
+    }
+    free(entry->value);
+    entry->value = copiedValue;
+    entry->defined = defined;
+
+    /* The fingerprint covers the order of the definitions, which is enough to tell sets apart */
+    uint64_t change = hashContent(name, length) ^ (defined ? 0x9E3779B97F4A7C15ULL : 0);
+    if (copiedValue != NULL) {
+        change ^= hashContent(copiedValue, strlen(copiedValue)) * 31;
+    }
+    macros->fingerprint = (macros->fingerprint ^ change) * 1099511628211ULL;
+    return true;
+}
+
+/**
+ * Applies a command-line definition to a set of macros.
+ * @param macros The set of macros.
+ * @param option The argument of -D ("NAME" defines NAME as 1, "NAME=value" as value) or of -U ("NAME").
+ * @param define true for -D, false for -U.
+ * @return true on success, false if the name is not an identifier or memory could not be allocated.
+ */
+bool applyMacroOption(ccdoc_macros *macros, const char *option, bool define) {
+    size_t length = 0;
+    if (!isIdentifierStart(option[0])) {
+        return false;
+    }
+    while (isIdentifierChar(option[length])) {
+        length++;
+    }
+    if (!define) {
+        return option[length] == '\0' && setMacro(macros, option, length, NULL, false);
+    }
+    if (option[length] != '\0' && option[length] != '=') {
+        return false;
+    }
+    return setMacro(macros, option, length, option[length] == '=' ? option + length + 1 : "1", true);
+}
+
+/**
+ * Returns a hash of all definitions of a set.
+ * @param macros The set of macros, may be NULL.
+ * @return The hash, 0 for an empty set or NULL.
+ */
+uint64_t macrosFingerprint(const ccdoc_macros *macros) {
+    return macros != NULL ? macros->fingerprint : 0;
+}
+
+/**
+ * Finds the definition of a macro visible in a file.
+ * @param state The conditional state of the file.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @return Pointer to the definition, or NULL if the macro is not defined.
+ */
+static const MacroDefinition *lookupMacro(const ConditionalState *state, const char *name, size_t length) {
+    const MacroDefinition *entry = findMacro(state->local, name, length);
+    if (entry == NULL) {
+        entry = findMacro(state->predefined, name, length);
+    }
+    return entry != NULL && entry->defined ? entry : NULL;
+}
+
+/**
+ * Checks if a file saw a macro, either defined or undefined, with -D, -U, #define or #undef.
+ * @param state The conditional state of the file.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @return true if the macro has an entry, false if its value is not known to the file.
+ */
+static bool macroKnown(const ConditionalState *state, const char *name, size_t length) {
+    return findMacro(state->local, name, length) != NULL || findMacro(state->predefined, name, length) != NULL;
+}
+
+/**
+ * Records a name whose value is not known, unless an earlier one was recorded.
+ * @param e The expression.
+ * @param name The name.
+ */
+static void noteUnknown(Expression *e, const char *name) {
+    if (e->unknown == NULL) {
+        e->unknown = name;
+    }
+}
+
+/**
+ * Skips spaces and comments in an expression.
+ * @param e The expression.
+ */
+static void skipSpace(Expression *e) {
+    for (;;) {
+        while (*e->p == ' ' || *e->p == '\t' || *e->p == '\\' || *e->p == '\r' || *e->p == '\n') {
+            e->p++;
+        }
+        if (e->p[0] == '/' && e->p[1] == '*') {
+            const char *end = strstr(e->p + 2, "*/");
+            e->p = end ? end + 2 : e->p + strlen(e->p);
+        } else if (e->p[0] == '/' && e->p[1] == '/') {
+            e->p += strlen(e->p);
+        } else {
+            return;
+        }
+    }
+}
+
+static long long evaluateConditional(Expression *e);
+
+/**
+ * Evaluates the replacement text of a macro used in an expression.
+ * @param e The expression the macro appears in.
+ * @param value The replacement text.
+ * @return The value of the text, 0 if it is empty.
+ */
+static long long evaluateMacro(Expression *e, const char *value) {
+    if (e->depth >= MAX_EXPANSION_DEPTH) {
+        e->error = true;
+        return 0;
+    }
+    Expression inner = { value, e->state, e->depth + 1, false, NULL };
+    skipSpace(&inner);
+    if (*inner.p == '\0') {
+        return 0;
+    }
+    long long result = evaluateConditional(&inner);
+    skipSpace(&inner);
+    if (inner.error || *inner.p != '\0') {
+        e->error = true;
+    }
+    if (inner.unknown != NULL) {
+        noteUnknown(e, inner.unknown);
+    }
+    return result;
+}
+
+/**
+ * Evaluates a primary expression or a unary operator.
+ * @param e The expression.
+ * @return The value.
+ */
+static long long evaluateUnary(Expression *e) {
+    skipSpace(e);
+    char c = *e->p;
+
+    if (c == '(') {
+        e->p++;
+        long long value = evaluateConditional(e);
+        skipSpace(e);
+        if (*e->p == ')') {
+            e->p++;
+        } else {
+            e->error = true;
+        }
+        return value;
+    }
+    if (c == '!' || c == '~' || c == '-' || c == '+') {
+        e->p++;
+        long long value = evaluateUnary(e);
+        return c == '!' ? !value : c == '~' ? ~value : c == '-' ? -value : value;
+    }
+    if (isdigit((unsigned char)c)) {
+        char *end;
+        long long value = (long long)strtoull(e->p, &end, 0);
+        e->p = end;
+        while (*e->p == 'u' || *e->p == 'U' || *e->p == 'l' || *e->p == 'L') {
+            e->p++;
+        }
+        return value;
+    }
+    if (c == '\'') {
+        /* A character constant, with the common escapes; a constant cut short ends the text */
+        long long value = (unsigned char)*++e->p;
+        if (value == '\0') {
+            e->error = true;
+            return 0;
+        }
+        e->p++;
+        if (value == '\\') {
+            char escaped = *e->p;
+            if (escaped == '\0') {
+                e->error = true;
+                return 0;
+            }
+            e->p++;
+            value = escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped == '0' ? 0 : escaped;
+        }
+        if (*e->p == '\'') {
+            e->p++;
+        } else {
+            e->error = true;
+        }
+        return value;
+    }
+    if (isIdentifierStart(c)) {
+        const char *name = e->p;
+        while (isIdentifierChar(*e->p)) {
+            e->p++;
+        }
+        size_t length = (size_t)(e->p - name);
+
+        if (length == 7 && strncmp(name, "defined", 7) == 0) {
+            skipSpace(e);
+            bool parenthesized = *e->p == '(';
+            if (parenthesized) {
+                e->p++;
+                skipSpace(e);
+            }
+            const char *macro = e->p;
+            while (isIdentifierChar(*e->p)) {
+                e->p++;
+            }
+            if (e->p == macro) {
+                e->error = true;
+                return 0;
+            }
+            bool defined = lookupMacro(e->state, macro, (size_t)(e->p - macro)) != NULL;
+            if (!macroKnown(e->state, macro, (size_t)(e->p - macro))) {
+                noteUnknown(e, macro);
+            }
+            if (parenthesized) {
+                skipSpace(e);
+                if (*e->p == ')') {
+                    e->p++;
+                } else {
+                    e->error = true;
+                }
+            }
+            return defined;
+        }
+
+        /* A name the file never saw and a call of a function-like macro count as 0, but their value is not known */
+        const MacroDefinition *macro = lookupMacro(e->state, name, length);
+        if ((macro == NULL && !macroKnown(e->state, name, length)) || (macro != NULL && macro->value == NULL)) {
+            noteUnknown(e, name);
+        }
+        skipSpace(e);
+        if (*e->p == '(' && (macro == NULL || macro->value == NULL)) {
+            int depth = 0;
+            do {
+                depth += *e->p == '(';
+                depth -= *e->p == ')';
+                e->p++;
+            } while (*e->p && depth > 0);
+            return 0;
+        }
+        return macro != NULL && macro->value != NULL ? evaluateMacro(e, macro->value) : 0;
+    }
+    e->error = true;
+    return 0;
+}
+
+/**
+ * Reads a binary operator without consuming it.
+ * @param p The text at the operator.
+ * @param length Pointer receiving the length of the operator.
+ * @return Precedence of the operator, higher binding tighter, or 0 if there is none.
+ */
+static int binaryOperator(const char *p, int *length) {
+    *length = 2;
+    if (p[0] == '|' && p[1] == '|') return 1;
+    if (p[0] == '&' && p[1] == '&') return 2;
+    if ((p[0] == '=' || p[0] == '!') && p[1] == '=') return 6;
+    if ((p[0] == '<' || p[0] == '>') && p[1] == '=') return 7;
+    if ((p[0] == '<' && p[1] == '<') || (p[0] == '>' && p[1] == '>')) return 8;
+    *length = 1;
+    switch (p[0]) {
+        case '|': return 3;
+        case '^': return 4;
+        case '&': return 5;
+        case '<': case '>': return 7;
+        case '+': case '-': return 9;
+        case '*': case '/': case '%': return 10;
+        default: return 0;
+    }
+}
+
+/**
+ * Applies a binary operator.
+ * @param e The expression, marked as malformed on a division by zero.
+ * @param op The operator.
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The result.
+ */
+static long long applyOperator(Expression *e, const char *op, long long left, long long right) {
+    switch (op[0]) {
+        case '|': return op[1] == '|' ? (left || right) : (left | right);
+        case '&': return op[1] == '&' ? (left && right) : (left & right);
+        case '^': return left ^ right;
+        case '=': return left == right;
+        case '!': return left != right;
+        case '<': return op[1] == '=' ? left <= right : op[1] == '<' ? (long long)((unsigned long long)left << (right & 63)) : left < right;
+        case '>': return op[1] == '=' ? left >= right : op[1] == '>' ? left >> (right & 63) : left > right;
+        case '+': return (long long)((unsigned long long)left + (unsigned long long)right);
+        case '-': return (long long)((unsigned long long)left - (unsigned long long)right);
+        case '*': return (long long)((unsigned long long)left * (unsigned long long)right);
+        default:
+            if (right == 0 || (left == LLONG_MIN && right == -1)) {
+                e->error = true;
+                return 0;
+            }
+            return op[0] == '/' ? left / right : left % right;
+    }
+}
+
+/**
+ * Finds the unknown name the result of a binary operator depends on.
+ * An operand whose value is known and decides && or || on its own makes the result known.
+ * @param op The operator.
+ * @param left The left operand.
+ * @param leftUnknown Unknown name of the left operand, NULL if its value is known.
+ * @param right The right operand.
+ * @param rightUnknown Unknown name of the right operand, NULL if its value is known.
+ * @return The unknown name of the result, NULL if its value is known.
+ */
+static const char *unknownOfOperation(const char *op, long long left, const char *leftUnknown, long long right, const char *rightUnknown) {
+    bool isAnd = op[0] == '&' && op[1] == '&';
+    bool isOr = op[0] == '|' && op[1] == '|';
+    if ((isAnd && ((leftUnknown == NULL && left == 0) || (rightUnknown == NULL && right == 0))) ||
+        (isOr && ((leftUnknown == NULL && left != 0) || (rightUnknown == NULL && right != 0)))) {
+        return NULL;
+    }
+    return leftUnknown != NULL ? leftUnknown : rightUnknown;
+}
+
+/**
+ * Evaluates binary operators of at least a given precedence.
+ * @param e The expression.
+ * @param minPrecedence The lowest precedence to consume.
+ * @return The value.
+ */
+static long long evaluateBinary(Expression *e, int minPrecedence) {
+    const char *outer = e->unknown;
+    e->unknown = NULL;
+    long long left = evaluateUnary(e);
+    for (;;) {
+        skipSpace(e);
+        int length;
+        int precedence = binaryOperator(e->p, &length);
+        if (precedence == 0 || precedence < minPrecedence) {
+            break;
+        }
+        const char *op = e->p;
+        const char *leftUnknown = e->unknown;
+        e->p += length;
+        e->unknown = NULL;
+        long long right = evaluateBinary(e, precedence + 1);
+        e->unknown = unknownOfOperation(op, left, leftUnknown, right, e->unknown);
+        left = applyOperator(e, op, left, right);
+    }
+    if (outer != NULL) {
+        e->unknown = outer;
+    }
+    return left;
+}
+
+/**
+ * Evaluates an expression, including the conditional operator.
+ * @param e The expression.
+ * @return The value.
+ */
+static long long evaluateConditional(Expression *e) {
+    const char *outer = e->unknown;
+    e->unknown = NULL;
+    long long condition = evaluateBinary(e, 1);
+    skipSpace(e);
+    if (*e->p != '?') {
+        if (outer != NULL) {
+            e->unknown = outer;
+        }
+        return condition;
+    }
+
+    /* Only the chosen operand matters once the condition is known */
+    const char *conditionUnknown = e->unknown;
+    e->p++;
+    e->unknown = NULL;
+    long long whenTrue = evaluateConditional(e);
+    const char *trueUnknown = e->unknown;
+    skipSpace(e);
+    if (*e->p != ':') {
+        e->error = true;
+        return 0;
+    }
+    e->p++;
+    e->unknown = NULL;
+    long long whenFalse = evaluateConditional(e);
+    e->unknown = outer != NULL ? outer : conditionUnknown != NULL ? conditionUnknown : condition ? trueUnknown : e->unknown;
+    return condition ? whenTrue : whenFalse;
+}
+
+/**
+ * Evaluates the condition of an #if or #elif directive.
+ * A malformed condition is reported and taken as true, so the region is parsed as it would be
+ * without conditional support.
+ * @param state The conditional state of the file.
+ * @param text The condition.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line, used in warnings.
+ * @param unknown Pointer receiving the first name the value depends on that the file never saw, NULL if none.
+ * @return true if the condition holds with such names undefined, false otherwise.
+ */
+static bool evaluateCondition(const ConditionalState *state, const char *text, const char *filename, long lineNumber, const char **unknown) {
+    Expression e = { text, state, 0, false, NULL };
+    long long value = evaluateConditional(&e);
+    skipSpace(&e);
+    *unknown = NULL;
+    if (e.error || *e.p != '\0') {
+        fprintf(stderr, "Warning: Cannot evaluate condition in %s at line %ld, the region is parsed\n", filename, lineNumber);
+        return true;
+    }
+    *unknown = e.unknown;
+    return value != 0;
+}
+
+/**
+ * Checks if the macro named after #ifdef or #ifndef is defined.
+ * @param state The conditional state of the file.
+ * @param text The text after the directive.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line, used in warnings.
+ * @param defined Pointer receiving whether the macro is defined.
+ * @param unknown Pointer receiving the name if the file never saw it, NULL otherwise.
+ * @return true if a name was given, false otherwise.
+ */
+static bool macroNamed(const ConditionalState *state, const char *text, const char *filename, long lineNumber, bool *defined, const char **unknown) {
+    while (*text == ' ' || *text == '\t') {
+        text++;
+    }
+    size_t length = 0;
+    while (isIdentifierChar(text[length])) {
+        length++;
+    }
+    if (length == 0 || !isIdentifierStart(text[0])) {
+        fprintf(stderr, "Warning: Directive without a macro name in %s at line %ld, the region is parsed\n", filename, lineNumber);
+        return false;
+    }
+    *defined = lookupMacro(state, text, length) != NULL;
+    *unknown = macroKnown(state, text, length) ? NULL : text;
+    return true;
+}
+
+/**
+ * Handles #define and #undef in a live region.
+ * @param state The conditional state of the file.
+ * @param text The text after the directive.
+ * @param define true for #define, false for #undef.
+ */
+static void changeMacro(ConditionalState *state, const char *text, bool define) {
+    while (*text == ' ' || *text == '\t') {
+        text++;
+    }
+    size_t length = 0;
+    while (isIdentifierChar(text[length])) {
+        length++;
+    }
+    if (length == 0 || !isIdentifierStart(text[0])) {
+        return;
+    }
+    if (state->local == NULL && (state->local = createMacros()) == NULL) {
+        return;
+    }
+    if (!define) {
+        setMacro(state->local, text, length, NULL, false);
+        return;
+    }
+
+    /* A parenthesis right after the name makes a function-like macro, which is not expanded */
+    if (text[length] == '(') {
+        setMacro(state->local, text, length, NULL, true);
+        return;
+    }
+    char value[1024];
+    const char *start = text + length;
+    while (*start == ' ' || *start == '\t') {
+        start++;
+    }
+    size_t valueLength = strcspn(start, "\r\n");
+    while (valueLength > 0 && (start[valueLength - 1] == ' ' || start[valueLength - 1] == '\t' || start[valueLength - 1] == '\\')) {
+        valueLength--;
+    }
+    snprintf(value, sizeof(value), "%.*s", (int)valueLength, start);
+    setMacro(state->local, text, length, value, true);
+}
+
+/**
+ * Finds the keyword of a directive line.
+ * @param line The line.
+ * @param length Pointer receiving the length of the keyword.
+ * @return Pointer to the keyword, or NULL if the line does not start with '#'.
+ */
+static const char *directiveKeyword(const char *line, size_t *length) {
+    const char *p = line;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p != '#') {
+        return NULL;
+    }
+    p++;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    *length = 0;
+    while (isIdentifierChar(p[*length])) {
+        (*length)++;
+    }
+    return p;
+}
+
+/**
+ * Appends a line of a continued directive to the directive text collected so far.
+ * A line that does not fit into memory is dropped, which leaves the directive malformed.
+ * @param state The conditional state of the file.
+ * @param text The line without its backslash and line break.
+ * @param length Length of the line.
+ */
+static void appendPending(ConditionalState *state, const char *text, size_t length) {
+    if (state->pendingLength + length + 1 > state->pendingCapacity) {
+        size_t capacity = state->pendingCapacity ? state->pendingCapacity : 256;
+        while (state->pendingLength + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *grown = realloc(state->pending, capacity);
+        if (grown == NULL) {
+            return;
+        }
+        state->pending = grown;
+        state->pendingCapacity = capacity;
+    }
+    memcpy(state->pending + state->pendingLength, text, length);
+    state->pendingLength += length;
+    state->pending[state->pendingLength] = '\0';
+}
+
+/**
+ * Prepares the conditional state for a new file.
+ * @param state The state to initialize.
+ * @param predefined Macros given with -D and -U, may be NULL.
+ */
+void initConditionals(ConditionalState *state, const ccdoc_macros *predefined) {
+    state->predefined = predefined;
+    state->local = NULL;
+    state->depth = 0;
+    state->overflow = 0;
+    state->live = true;
+    state->continued = false;
+    state->commented = false;
+    state->pending = NULL;
+    state->pendingLength = 0;
+    state->pendingCapacity = 0;
+    state->pendingLine = 0;
+}
+
+/**
+ * Decides whether a branch of a conditional is parsed.
+ * A branch whose condition depends on a name the file never saw is parsed, since the name may
+ * come from an included header, and so is every later branch until one is certainly taken.
+ * A warning is given where such a branch would be skipped if those names were undefined.
+ * @param state The conditional state of the file.
+ * @param frame The conditional the branch belongs to.
+ * @param condition true if the condition holds with unknown names undefined.
+ * @param unknown First unknown name the condition depends on, NULL if its value is known.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line, used in warnings.
+ */
+static void enterBranch(ConditionalState *state, ConditionalFrame *frame, bool condition, const char *unknown, const char *filename, long lineNumber) {
+    if (!frame->parentLive || frame->taken) {
+        state->live = false;
+        return;
+    }
+    if (unknown != NULL) {
+        if (!condition || frame->assumed) {
+            int length = 0;
+            while (isIdentifierChar(unknown[length])) {
+                length++;
+            }
+            fprintf(stderr, "Warning: Condition in %s at line %ld depends on %.*s, whose value is not known, the region is parsed\n", filename, lineNumber, length, unknown);
+        }
+        frame->undecided = true;
+        state->live = true;
+    } else if (condition) {
+        if (frame->undecided && frame->assumed) {
+            fprintf(stderr, "Warning: Branch in %s at line %ld follows a condition whose value is not known, the region is parsed\n", filename, lineNumber);
+        }
+        frame->taken = true;
+        state->live = true;
+    } else {
+        state->live = false;
+    }
+    frame->assumed = frame->assumed || condition;
+}
+
+/**
+ * Runs a complete conditional directive, #define or #undef.
+ * @param state The conditional state of the file.
+ * @param keyword The keyword of the directive.
+ * @param length Length of the keyword.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line starting the directive, used in warnings.
+ */
+static void runDirective(ConditionalState *state, const char *keyword, size_t length, const char *filename, long lineNumber) {
+    const char *p = keyword + length;
+#define IS_DIRECTIVE(name) (length == sizeof(name) - 1 && strncmp(keyword, name, length) == 0)
+
+    bool opening = IS_DIRECTIVE("if") || IS_DIRECTIVE("ifdef") || IS_DIRECTIVE("ifndef");
+    if (IS_DIRECTIVE("define") || IS_DIRECTIVE("undef")) {
+        if (state->live) {
+            changeMacro(state, p, IS_DIRECTIVE("define"));
+        }
+    }
+    else if (opening) {
+        if (state->depth == MAX_CONDITIONAL_DEPTH) {
+            if (state->overflow++ == 0) {
+                fprintf(stderr, "Warning: Conditionals in %s at line %ld are nested too deeply, the inner ones are ignored\n", filename, lineNumber);
+            }
+        } else {
+            ConditionalFrame *frame = &state->frames[state->depth++];
+            frame->parentLive = state->live;
+            frame->taken = false;
+            frame->assumed = false;
+            frame->undecided = false;
+            frame->sawElse = false;
+            frame->line = lineNumber;
+            bool condition = true;
+            const char *unknown = NULL;
+            if (state->live) {
+                bool defined;
+                if (IS_DIRECTIVE("if")) {
+                    condition = evaluateCondition(state, p, filename, lineNumber, &unknown);
+                } else if (macroNamed(state, p, filename, lineNumber, &defined, &unknown)) {
+                    condition = IS_DIRECTIVE("ifdef") ? defined : !defined;
+                }
+            }
+            enterBranch(state, frame, condition, unknown, filename, lineNumber);
+        }
+    }
+    else if (state->overflow > 0) {
+        state->overflow -= IS_DIRECTIVE("endif");
+    } else if (state->depth == 0) {
+        fprintf(stderr, "Warning: #%.*s without #if in %s at line %ld is ignored\n", (int)length, keyword, filename, lineNumber);
+    } else if (IS_DIRECTIVE("endif")) {
+        state->live = state->frames[--state->depth].parentLive;
+    } else {
+        ConditionalFrame *frame = &state->frames[state->depth - 1];
+        if (frame->sawElse) {
+            fprintf(stderr, "Warning: #%.*s after #else in %s at line %ld\n", (int)length, keyword, filename, lineNumber);
+            state->live = false;
+        } else if (IS_DIRECTIVE("else") || !frame->parentLive || frame->taken) {
+            enterBranch(state, frame, true, NULL, filename, lineNumber);
+        } else {
+            const char *unknown;
+            bool condition = evaluateCondition(state, p, filename, lineNumber, &unknown);
+            enterBranch(state, frame, condition, unknown, filename, lineNumber);
+        }
+        frame->sawElse = frame->sawElse || IS_DIRECTIVE("else");
+    }
+#undef IS_DIRECTIVE
+}
+
+/**
+ * Processes a conditional directive, #define or #undef, and the continuation lines of such
+ * a directive. The lines of a continued directive are joined and the directive is run once
+ * its last line is reached.
+ * @param state The conditional state of the file.
+ * @param line The line, which must start a line of the file.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line, used in warnings.
+ * @return true if the line was handled and must not be parsed further, false otherwise.
+ */
+bool processDirective(ConditionalState *state, const char *line, const char *filename, long lineNumber) {
+    size_t lineLength = strcspn(line, "\r\n");
+    bool continues = lineLength > 0 && line[lineLength - 1] == '\\';
+    size_t length;
+    const char *keyword;
+
+    if (state->continued) {
+        appendPending(state, line, continues ? lineLength - 1 : lineLength);
+        state->continued = continues;
+        if (!continues && state->pending != NULL && (keyword = directiveKeyword(state->pending, &length)) != NULL) {
+            runDirective(state, keyword, length, filename, state->pendingLine);
+        }
+        return true;
+    }
+
+    /* Only a '#' opening a line outside of a block comment starts a directive */
+    keyword = state->commented ? NULL : directiveKeyword(line, &length);
+    if (keyword == NULL) {
+        return false;
+    }
+    static const char *const DIRECTIVES[] = { "define", "undef", "if", "ifdef", "ifndef", "elif", "else", "endif" };
+    bool known = false;
+    for (size_t i = 0; i < sizeof(DIRECTIVES) / sizeof(DIRECTIVES[0]) && !known; i++) {
+        known = strlen(DIRECTIVES[i]) == length && strncmp(keyword, DIRECTIVES[i], length) == 0;
+    }
+    if (!known) {
+        return false;
+    }
+
+    if (continues) {
+        state->pendingLength = 0;
+        state->pendingLine = lineNumber;
+        state->continued = true;
+        appendPending(state, line, lineLength - 1);
+        return true;
+    }
+    runDirective(state, keyword, length, filename, lineNumber);
+    return true;
+}
+
+/**
+ * Follows the block comments of a line, so that a '#' inside a comment does not start a
+ * directive. Comment markers within string and character literals are ignored.
+ * @param state The conditional state of the file.
+ * @param text The line or a piece of it.
+ * @param length Length of the text.
+ */
+void trackComments(ConditionalState *state, const char *text, size_t length) {
+    const char *end = text + length;
+    char quote = 0;
+    for (const char *p = text; p < end; p++) {
+        if (state->commented) {
+            if (p[0] == '*' && p + 1 < end && p[1] == '/') {
+                state->commented = false;
+                p++;
+            }
+        } else if (quote != 0) {
+            if (*p == '\\' && p + 1 < end) {
+                p++;
+            } else if (*p == quote) {
+                quote = 0;
+            }
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (p[0] == '/' && p + 1 < end && p[1] == '*') {
+            state->commented = true;
+            p++;
+        } else if (p[0] == '/' && p + 1 < end && p[1] == '/') {
+            return;
+        }
+    }
+}
+
+/**
+ * Warns about conditionals still open at the end of a file and releases the macros the file defined.
+ * @param state The conditional state of the file.
+ * @param filename Name of the file, used in warnings.
+ * @param complete true if the whole file was read; open conditionals are only reported then.
+ */
+void finishConditionals(ConditionalState *state, const char *filename, bool complete) {
+    if (complete && state->depth > 0) {
+        fprintf(stderr, "Warning: Conditional in %s starting at line %ld is not terminated\n", filename, state->frames[state->depth - 1].line);
+    }
+    destroyMacros(state->local);
+    state->local = NULL;
+    free(state->pending);
+    state->pending = NULL;
+    state->pendingCapacity = 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * Module conditionals.h
+ * This module contains function prototypes for evaluating preprocessor conditionals, so the
+ * parser can skip regions disabled by #if, #ifdef, #ifndef, #elif and #else.
+ * Macros are predefined with -D and -U and changed by the #define and #undef lines of the
+ * file being parsed. Every file starts again from the predefined macros, so a name defined
+ * only by an included header is unknown; a branch depending on it is parsed with a warning.
+ */
+
+#ifndef CONDITIONALS_H
+#define CONDITIONALS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maximal nesting of conditionals within one file. */
+#define MAX_CONDITIONAL_DEPTH 64
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct ccdoc_macros
+ * @brief Opaque set of macro definitions. Once filled, it is only read, so it can be shared by
+ * contexts on several threads.
+ */
+typedef struct ccdoc_macros ccdoc_macros;
+
+/**
+ * @struct ConditionalFrame
+ * @brief One open conditional.
+ */
+typedef struct {
+    bool parentLive;                  /* The region around the conditional is parsed. */
+    bool taken;                       /* A branch whose condition certainly holds was reached. */
+    bool assumed;                     /* A branch was reached that holds with unknown names undefined. */
+    bool undecided;                   /* A condition of the chain depends on an unknown name. */
+    bool sawElse;                     /* The #else branch was reached. */
+    long line;                        /* Line of the opening directive. */
+} ConditionalFrame;
+
+/**
+ * @struct ConditionalState
+ * @brief Conditionals and macros of the file being parsed.
+ */
+typedef struct {
+    const ccdoc_macros *predefined;   /* Macros given with -D and -U, NULL for none. */
+    ccdoc_macros *local;              /* Changes made by the file, NULL until its first #define or #undef. */
+    ConditionalFrame frames[MAX_CONDITIONAL_DEPTH]; /* The open conditionals. */
+    int depth;                        /* Count of open conditionals. */
+    int overflow;                     /* Open conditionals nested deeper than MAX_CONDITIONAL_DEPTH. */
+    bool live;                        /* Indicates if the current line is parsed. */
+    bool continued;                   /* The last directive line ended with a backslash. */
+    bool commented;                   /* The next line starts inside a block comment. */
+    char *pending;                    /* Lines of the continued directive joined so far, NULL if none was seen. */
+    size_t pendingLength;             /* Length of the joined lines. */
+    size_t pendingCapacity;           /* Allocated size of pending. */
+    long pendingLine;                 /* Line where the continued directive starts. */
+} ConditionalState;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Creates an empty set of macros.
+ * @return Pointer to the set, or NULL if memory could not be allocated.
+ */
+ccdoc_macros *createMacros(void);
+
+/**
+ * Releases a set of macros.
+ * @param macros The set to destroy, may be NULL.
+ */
+void destroyMacros(ccdoc_macros *macros);
+
+/**
+ * Applies a command-line definition to a set of macros.
+ * @param macros The set of macros.
+ * @param option The argument of -D ("NAME" defines NAME as 1, "NAME=value" as value) or of -U ("NAME").
+ * @param define true for -D, false for -U.
+ * @return true on success, false if the name is not an identifier or memory could not be allocated.
+ */
+bool applyMacroOption(ccdoc_macros *macros, const char *option, bool define);
+
+/**
+ * Returns a hash of all definitions of a set, which changes whenever the set does.
+ * @param macros The set of macros, may be NULL.
+ * @return The hash, 0 for an empty set or NULL.
+ */
+uint64_t macrosFingerprint(const ccdoc_macros *macros);
+
+/**
+ * Prepares the conditional state for a new file.
+ * @param state The state to initialize.
+ * @param predefined Macros given with -D and -U, may be NULL.
+ */
+void initConditionals(ConditionalState *state, const ccdoc_macros *predefined);
+
+/**
+ * Processes a conditional directive, #define or #undef, and the continuation lines of such
+ * a directive, which are joined before the directive is run.
+ * @param state The conditional state of the file.
+ * @param line The line, which must start a line of the file.
+ * @param filename Name of the file, used in warnings.
+ * @param lineNumber Number of the line, used in warnings.
+ * @return true if the line was handled and must not be parsed further, false otherwise.
+ */
+bool processDirective(ConditionalState *state, const char *line, const char *filename, long lineNumber);
+
+/**
+ * Follows the block comments of a line, so that a '#' inside a comment does not start a
+ * directive. Must be called for every line of the file after processDirective.
+ * @param state The conditional state of the file.
+ * @param text The line or a piece of it.
+ * @param length Length of the text.
+ */
+void trackComments(ConditionalState *state, const char *text, size_t length);
+
+/**
+ * Warns about conditionals still open at the end of a file and releases the macros the file defined.
+ * @param state The conditional state of the file.
+ * @param filename Name of the file, used in warnings.
+ * @param complete true if the whole file was read; open conditionals are only reported then.
+ */
+void finishConditionals(ConditionalState *state, const char *filename, bool complete);
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Module context.h
+ * @brief Definition of the parser context that owns all state of a documentation run.
+ * This header is internal to the library; clients use the opaque type declared in ccdoc.h.
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdbool.h>
+#include "constants.h"
+#include "data_structures.h"
+#include "trace.h"
+#include "ordering.h"
+#include "symbol_index.h"
+#include "parse_cache.h"
+#include "tar_archive.h"
+#include "resource_limits.h"
+#include "output_template.h"
+#include "conditionals.h"
+#include "prefetch.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct ccdoc_context
+ * @brief Holds everything collected while processing one documentation target.
+ */
+struct ccdoc_context {
+    char processedFiles[MAX_FILES][256];      /* Array of processed file names. */
+    int processedCount;                       /* Count of processed files. */
+    char dependencies[MAX_FILES][256];        /* Files read from disk, in the order they were read. */
+    int dependencyCount;                      /* Count of files read from disk. */
+    FunctionDoc functionDocs[MAX_FUNCTIONS];  /* Array of function documentation structures. */
+    int functionCount;                        /* Count of documented functions. */
+    int invalidCommentFormat;                 /* Flag for invalid comment format detection. */
+    SymbolIndex symbolIndex;                  /* Lookup structure, rebuilt when the collection changes. */
+    ccdoc_cache *cache;                       /* Shared parse results, NULL if every file is parsed. */
+    const ccdoc_archive *archive;             /* Archive the files are read from, NULL for the file system. */
+    bool prefetch;                            /* Indicates if upcoming input files are read ahead. */
+    Prefetcher *prefetcher;                   /* Reads ahead while a file is added, NULL otherwise. */
+    ResourceLimits limits;                    /* Limits applied to every processed file. */
+    RunStatistics statistics;                 /* Counters of the files processed by this context. */
+    int includeDepth;                         /* Nesting depth of the file being processed. */
+    OutputOrder order;                        /* Order in which the functions are emitted. */
+    const ccdoc_template *outputTemplate;     /* Template of the output, NULL for the built-in LaTeX layout. */
+    const ccdoc_macros *macros;               /* Macros given with -D and -U, NULL for none. */
+    Trace *trace;                             /* Timeline recorder, NULL when tracing is disabled. */
+    int traceThreadId;                        /* Thread identifier written to recorded spans. */
+};
+
+#endif 
@@ -52,6 +52,17 @@ void mergeDocComments(DocComment *dest, const DocComment *src) {
         }
     }
 
+    /* Merge the raw @param entries used by the parameter check */
+    for (int i = 0; i < src->paramTagCount && dest->paramTagCount < MAX_PARAMS; i++) {
+        bool found = false;
+        for (int j = 0; j < dest->paramTagCount && !found; j++) {
+            found = strcmp(dest->paramTags[j], src->paramTags[i]) == 0;
+        }
+        if (!found) {
+            strcpy(dest->paramTags[dest->paramTagCount++], src->paramTags[i]);
+        }
+    }
+
     /* Merge 'returnVal' */
     if (strlen(src->returnVal) > 0 && strlen(dest->returnVal) == 0) {
         strcpy(dest->returnVal, src->returnVal);
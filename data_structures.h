@@ -26,6 +26,8 @@ typedef struct {
     char paramName[MAX_PARAMS][256];   /* Array of parameter names. */
     char paramDesc[MAX_PARAMS][1024];  /* Array of parameter descriptions. */
     int paramCount;                    /* Count of parameters. */
+    char paramTags[MAX_PARAMS][128];   /* First two words of every @param entry, whatever its description. */
+    int paramTagCount;                 /* Count of @param entries. */
     char returnVal[256];               /* Return value description. */
     char author[256];                  /* Author of the function. */
     char version[256];                 /* Version information. */
@@ -40,6 +42,7 @@ typedef struct {
     char functionName[256];           /* Name of the function. */
     char moduleName[256];             /* Module in which the function resides. */
     char prototype[1024];             /* Prototype of the function. */
+    char paramNames[256];             /* Parameter names of the prototype, separated by spaces. */
     char fileTypes[2];                /* Types of files (header/source). */
     DocComment comment;               /* Associated documentation comment. */
 } FunctionDoc;
@@ -0,0 +1,74 @@
+/**
+ * Module dependencies.c
+ * This module implements writing of make-compatible dependency files, in the same format
+ * that compilers produce with -MD, so a build only reruns ccdoc when one of its inputs changes.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dependencies.h"
+
+/**
+ * Writes a file name escaped for use in a make rule.
+ * Spaces, hash signs, colons and backslashes are escaped with a backslash and dollar signs
+ * are doubled.
+ * @param outputFile The file where the name is written.
+ * @param name The file name.
+ */
+static void writeMakeName(FILE *outputFile, const char *name) {
+    for (const char *p = name; *p; p++) {
+        if (*p == ' ' || *p == '#' || *p == ':' || *p == '\\') {
+            fputc('\\', outputFile);
+        }
+        else if (*p == '$') {
+            fputc('$', outputFile);
+        }
+        fputc(*p, outputFile);
+    }
+}
+
+/**
+ * Writes a make rule stating that the target depends on the given files.
+ * Every dependency is written on its own continuation line.
+ * @param outputFile The file where the rule is written.
+ * @param target The file generated from the dependencies.
+ * @param dependencies Array of dependency file names.
+ * @param dependencyCount Count of dependencies.
+ * @param phonyTargets true to add an empty rule for every dependency except the first, as with -MP.
+ */
+void writeDependencyRule(FILE *outputFile, const char *target, const char (*dependencies)[256], int dependencyCount, bool phonyTargets) {
+    writeMakeName(outputFile, target);
+    fputc(':', outputFile);
+    for (int i = 0; i < dependencyCount; i++) {
+        fputs(" \\\n ", outputFile);
+        writeMakeName(outputFile, dependencies[i]);
+    }
+    fputc('\n', outputFile);
+
+    /* Empty rules keep make working after a dependency is deleted */
+    if (phonyTargets) {
+        for (int i = 1; i < dependencyCount; i++) {
+            fputc('\n', outputFile);
+            writeMakeName(outputFile, dependencies[i]);
+            fputs(":\n", outputFile);
+        }
+    }
+}
+
+/**
+ * Builds the default dependency file name by replacing the extension of the output file with .d.
+ * If the output file has no extension, .d is appended.
+ * @param outputFileName Name of the generated document.
+ * @param dependencyFileName Buffer receiving the name of the dependency file.
+ * @param size Size of the buffer.
+ */
+void defaultDependencyFileName(const char *outputFileName, char *dependencyFileName, size_t size) {
+    const char *dot = strrchr(outputFileName, '.');
+    const char *slash = strrchr(outputFileName, '/');
+    size_t length = strlen(outputFileName);
+
+    if (dot != NULL && (slash == NULL || dot > slash)) {
+        length = dot - outputFileName;
+    }
+    snprintf(dependencyFileName, size, "%.*s.d", (int)length, outputFileName);
+}
@@ -0,0 +1,37 @@
+/**
+ * Module dependencies.h
+ * This module contains function prototypes for writing the input files of a run as a
+ * make-compatible dependency file.
+ */
+
+#ifndef DEPENDENCIES_H
+#define DEPENDENCIES_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Writes a make rule stating that the target depends on the given files.
+ * @param outputFile The file where the rule is written.
+ * @param target The file generated from the dependencies.
+ * @param dependencies Array of dependency file names.
+ * @param dependencyCount Count of dependencies.
+ * @param phonyTargets true to add an empty rule for every dependency except the first, as with -MP.
+ */
+void writeDependencyRule(FILE *outputFile, const char *target, const char (*dependencies)[256], int dependencyCount, bool phonyTargets);
+
+/**
+ * Builds the default dependency file name by replacing the extension of the output file with .d.
+ * @param outputFileName Name of the generated document.
+ * @param dependencyFileName Buffer receiving the name of the dependency file.
+ * @param size Size of the buffer.
+ */
+void defaultDependencyFileName(const char *outputFileName, char *dependencyFileName, size_t size);
+
+#endif 
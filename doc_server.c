@@ -0,0 +1,584 @@
+/**
+ * Module doc_server.c
+ * This module implements the documentation server declared in doc_server.h.
+ * A single thread multiplexes the listening socket and all clients with poll(), so requests
+ * never wait for a parse of the tree; lookups use the symbol index of the context.
+ * Client sockets are non-blocking and answers are queued per client, so a client that stops
+ * reading only delays itself.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "doc_server.h"
+#include "utility.h"
+
+#ifdef _WIN32
+
+/**
+ * Reports that the server is not available, because Unix domain sockets are not supported.
+ * @param ctx The context holding the documentation.
+ * @param socketPath The path of the socket to create.
+ * @return Always false.
+ */
+bool runDocServer(ccdoc_context *ctx, const char *socketPath) {
+    (void)ctx;
+    (void)socketPath;
+    fprintf(stderr, "Error: The documentation server is not supported on this platform\n");
+    return false;
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* Platforms without MSG_NOSIGNAL suppress SIGPIPE with the SO_NOSIGPIPE socket option instead. */
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* Maximum number of simultaneously connected clients. */
+#define MAX_CLIENTS 64
+
+/* Maximum length of one request line. */
+#define MAX_REQUEST_LENGTH 4096
+
+/* Maximum number of symbols in one answer. */
+#define MAX_ANSWER_SYMBOLS MAX_FUNCTIONS
+
+/* Queued answer bytes above which no further requests of a client are read. */
+#define MAX_PENDING_OUTPUT (1024 * 1024)
+
+/**
+ * @struct Client
+ * @brief Connection of one client with its partially received request.
+ */
+typedef struct {
+    int fd;                                /* Socket of the client, -1 if the slot is free. */
+    char request[MAX_REQUEST_LENGTH];      /* Bytes received but not yet processed. */
+    size_t length;                         /* Number of bytes in the request buffer. */
+    char *output;                          /* Answers not yet sent, NULL if none were queued. */
+    size_t outputLength;                   /* Number of bytes in the output buffer. */
+    size_t outputSent;                     /* Number of bytes of the output already sent. */
+    bool closing;                          /* The connection is closed once the output is sent. */
+} Client;
+
+/* Set by the signal handler to stop the server; signals are process-wide. */
+static volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * Records that the server should stop.
+ * @param signalNumber The received signal.
+ */
+static void handleStopSignal(int signalNumber) {
+    (void)signalNumber;
+    stopRequested = 1;
+}
+
+/**
+ * Reads a JSON string literal, decoding its escape sequences.
+ * @param cursor Pointer to the position of the opening quote, advanced past the closing quote.
+ * @param value Buffer receiving the decoded string, may be NULL to skip the string.
+ * @param size Size of the buffer.
+ * @return true if a valid string was read, false otherwise.
+ */
+static bool readJSONString(const char **cursor, char *value, size_t size) {
+    const char *p = *cursor;
+    size_t length = 0;
+
+    if (*p++ != '"') {
+        return false;
+    }
+    while (*p != '"') {
+        char c = *p++;
+        if (c == '\0') {
+            return false;
+        }
+        if (c == '\\') {
+            c = *p++;
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {
+                    unsigned code;
+                    if (sscanf(p, "%4x", &code) != 1) {
+                        return false;
+                    }
+                    p += 4;
+                    c = code < 0x80 ? (char)code : '?';
+                    break;
+                }
+                case '"': case '\\': case '/': break;
+                default: return false;
+            }
+        }
+        if (value != NULL && length + 1 < size) {
+            value[length++] = c;
+        }
+    }
+    if (value != NULL) {
+        value[length] = '\0';
+    }
+    *cursor = p + 1;
+    return true;
+}
+
+/**
+ * Finds a string member of a flat JSON object.
+ * Members with number, boolean or null values are skipped; nested values are not supported.
+ * @param json The JSON object.
+ * @param key The name of the member.
+ * @param value Buffer receiving the value of the member.
+ * @param size Size of the buffer.
+ * @return true if the member exists and is a string, false otherwise.
+ */
+static bool getJSONMember(const char *json, const char *key, char *value, size_t size) {
+    const char *p = json;
+    char name[64];
+
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p++ != '{') {
+        return false;
+    }
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p != '"' || !readJSONString(&p, name, sizeof(name))) {
+            return false;
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p++ != ':') {
+            return false;
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '"') {
+            bool wanted = strcmp(name, key) == 0;
+            if (!readJSONString(&p, wanted ? value : NULL, size)) {
+                return false;
+            }
+            if (wanted) {
+                return true;
+            }
+        }
+        else {
+            /* Skip a number, boolean or null value */
+            while (*p && *p != ',' && *p != '}') {
+                if (*p == '{' || *p == '[') {
+                    return false;
+                }
+                p++;
+            }
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p != ',') {
+            return false;
+        }
+    }
+}
+
+/**
+ * Writes the documentation of one function as a JSON object.
+ * @param out The stream receiving the object.
+ * @param doc The documentation of the function.
+ */
+static void writeSymbolJSON(FILE *out, const FunctionDoc *doc) {
+    const DocComment *comment = &doc->comment;
+    char identifier[256];
+    char moduleName[256];
+
+    functionIdentifier(doc->functionName, identifier, sizeof(identifier));
+    moduleNameOfFile(doc->moduleName, moduleName, sizeof(moduleName));
+
+    fputs("{\"name\":", out);
+    writeJSONString(out, identifier);
+    fputs(",\"returnType\":", out);
+    writeJSONString(out, doc->returnType);
+    fputs(",\"signature\":", out);
+    writeJSONString(out, doc->functionName);
+    fputs(",\"module\":", out);
+    writeJSONString(out, moduleName);
+    fputs(",\"file\":", out);
+    writeJSONString(out, doc->moduleName);
+    fputs(",\"fileTypes\":", out);
+    writeJSONString(out, doc->fileTypes);
+    fputs(",\"brief\":", out);
+    writeJSONString(out, comment->brief);
+    fputs(",\"details\":", out);
+    writeJSONString(out, comment->details);
+    fputs(",\"description\":", out);
+    writeJSONString(out, comment->freeText);
+    fputs(",\"params\":[", out);
+    for (int i = 0; i < comment->paramCount; i++) {
+        fputs(i > 0 ? ",{\"name\":" : "{\"name\":", out);
+        writeJSONString(out, comment->paramName[i]);
+        fputs(",\"description\":", out);
+        writeJSONString(out, comment->paramDesc[i]);
+        fputc('}', out);
+    }
+    fputs("],\"return\":", out);
+    writeJSONString(out, comment->returnVal);
+    fputs(",\"author\":", out);
+    writeJSONString(out, comment->author);
+    fputs(",\"version\":", out);
+    writeJSONString(out, comment->version);
+    fputc('}', out);
+}
+
+/**
+ * Writes a successful answer listing the given symbols.
+ * @param ctx The context holding the documentation.
+ * @param out The stream receiving the answer.
+ * @param indices Positions of the symbols.
+ * @param count Count of symbols.
+ */
+static void writeSymbolsAnswer(const ccdoc_context *ctx, FILE *out, const int *indices, int count) {
+    fputs("{\"ok\":true,\"symbols\":[", out);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            fputc(',', out);
+        }
+        writeSymbolJSON(out, ccdocSymbolAt(ctx, indices[i]));
+    }
+    fputs("]}\n", out);
+}
+
+/**
+ * Writes a failed answer with an error message.
+ * @param out The stream receiving the answer.
+ * @param message The error message.
+ */
+static void writeErrorAnswer(FILE *out, const char *message) {
+    fputs("{\"ok\":false,\"error\":", out);
+    writeJSONString(out, message);
+    fputs("}\n", out);
+}
+
+/**
+ * Answers one request line.
+ * @param ctx The context holding the documentation.
+ * @param request The request without its newline.
+ * @param out The stream receiving the answer.
+ */
+static void answerRequest(ccdoc_context *ctx, const char *request, FILE *out) {
+    char op[32];
+    char argument[256];
+    int indices[MAX_ANSWER_SYMBOLS];
+    int count = 0;
+
+    if (!getJSONMember(request, "op", op, sizeof(op))) {
+        writeErrorAnswer(out, "request must be a JSON object with an \"op\" member");
+    }
+    else if (strcmp(op, "lookup") == 0 && getJSONMember(request, "name", argument, sizeof(argument))) {
+        count = ccdocFindSymbols(ctx, argument, indices, MAX_ANSWER_SYMBOLS);
+        writeSymbolsAnswer(ctx, out, indices, count);
+    }
+    else if (strcmp(op, "prefix") == 0 && getJSONMember(request, "prefix", argument, sizeof(argument))) {
+        count = ccdocFindSymbolsByPrefix(ctx, argument, indices, MAX_ANSWER_SYMBOLS);
+        writeSymbolsAnswer(ctx, out, indices, count);
+    }
+    else if (strcmp(op, "module") == 0 && getJSONMember(request, "module", argument, sizeof(argument))) {
+        char moduleName[256];
+        moduleNameOfFile(argument, moduleName, sizeof(moduleName));
+        for (int i = 0; i < ccdocSymbolCount(ctx) && count < MAX_ANSWER_SYMBOLS; i++) {
+            char functionModule[256];
+            moduleNameOfFile(ccdocSymbolAt(ctx, i)->moduleName, functionModule, sizeof(functionModule));
+            if (strcmp(functionModule, moduleName) == 0) {
+                indices[count++] = i;
+            }
+        }
+        writeSymbolsAnswer(ctx, out, indices, count);
+    }
+    else if (strcmp(op, "reparse") == 0 && getJSONMember(request, "file", argument, sizeof(argument))) {
+        if (ccdocReparseFile(ctx, argument)) {
+            fprintf(out, "{\"ok\":true,\"symbolCount\":%d}\n", ccdocSymbolCount(ctx));
+        } else {
+            writeErrorAnswer(out, "file cannot be opened");
+        }
+    }
+    else {
+        writeErrorAnswer(out, "unknown op or missing argument");
+    }
+}
+
+/**
+ * Appends answers to the output queue of a client.
+ * @param client The client.
+ * @param data The bytes to queue.
+ * @param size The number of bytes.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool queueOutput(Client *client, const char *data, size_t size) {
+    /* Drop the part already sent before the queue grows */
+    if (client->outputSent > 0) {
+        memmove(client->output, client->output + client->outputSent, client->outputLength - client->outputSent);
+        client->outputLength -= client->outputSent;
+        client->outputSent = 0;
+    }
+    char *grown = realloc(client->output, client->outputLength + size);
+    if (grown == NULL) {
+        return false;
+    }
+    memcpy(grown + client->outputLength, data, size);
+    client->output = grown;
+    client->outputLength += size;
+    return true;
+}
+
+/**
+ * Sends as much of the queued output of a client as the socket accepts without blocking.
+ * @param client The client.
+ * @return true on success, false if the client has gone away.
+ */
+static bool flushOutput(Client *client) {
+    while (client->outputSent < client->outputLength) {
+        ssize_t sent = send(client->fd, client->output + client->outputSent,
+                            client->outputLength - client->outputSent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client->outputSent += (size_t)sent;
+    }
+    free(client->output);
+    client->output = NULL;
+    client->outputLength = 0;
+    client->outputSent = 0;
+    return true;
+}
+
+/**
+ * Closes the connection of a client and frees its slot.
+ * @param client The client.
+ */
+static void closeClient(Client *client) {
+    close(client->fd);
+    free(client->output);
+    client->fd = -1;
+    client->output = NULL;
+    client->outputLength = 0;
+    client->outputSent = 0;
+}
+
+/**
+ * Reads from a client and queues the answers of every complete request line.
+ * @param ctx The context holding the documentation.
+ * @param client The client with data available.
+ * @return false if the connection should be closed at once, true otherwise.
+ */
+static bool serveClient(ccdoc_context *ctx, Client *client) {
+    ssize_t received = read(client->fd, client->request + client->length, sizeof(client->request) - client->length);
+    if (received <= 0) {
+        return received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    client->length += received;
+
+    char *answer = NULL;
+    size_t answerSize = 0;
+    FILE *out = open_memstream(&answer, &answerSize);
+    if (out == NULL) {
+        return false;
+    }
+
+    /* Answer every complete line and keep the rest for the next read */
+    size_t start = 0;
+    char *newline;
+    while ((newline = memchr(client->request + start, '\n', client->length - start)) != NULL) {
+        *newline = '\0';
+        if (newline > client->request + start && newline[-1] == '\r') {
+            newline[-1] = '\0';
+        }
+        if (client->request[start] != '\0') {
+            answerRequest(ctx, client->request + start, out);
+        }
+        start = newline - client->request + 1;
+    }
+    if (start == 0 && client->length == sizeof(client->request)) {
+        writeErrorAnswer(out, "request too long");
+        client->closing = true;
+    }
+    memmove(client->request, client->request + start, client->length - start);
+    client->length -= start;
+
+    fclose(out);
+    bool queued = answerSize == 0 || queueOutput(client, answer, answerSize);
+    free(answer);
+    return queued && flushOutput(client);
+}
+
+/**
+ * Creates the listening Unix domain socket, replacing a stale socket file.
+ * Any other kind of file at the path is left alone and reported.
+ * @param socketPath The path of the socket.
+ * @return The socket, or -1 on failure.
+ */
+static int openListener(const char *socketPath) {
+    struct sockaddr_un address;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path %s is too long\n", socketPath);
+        return -1;
+    }
+
+    struct stat status;
+    if (lstat(socketPath, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            fprintf(stderr, "Error: %s exists and is not a socket\n", socketPath);
+            return -1;
+        }
+        unlink(socketPath);
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fprintf(stderr, "Error: Unable to create socket\n");
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listener, 16) < 0) {
+        fprintf(stderr, "Error: Unable to listen on socket %s\n", socketPath);
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+/**
+ * Makes an accepted client socket non-blocking and keeps writes to it from raising SIGPIPE.
+ * @param fd The socket.
+ * @return true on success, false otherwise.
+ */
+static bool configureClientSocket(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return false;
+    }
+#ifdef SO_NOSIGPIPE
+    int enabled = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+    return true;
+}
+
+/**
+ * Serves symbol queries on a Unix domain socket until the process receives SIGINT or SIGTERM.
+ * The handlers of both signals are installed for the time the server runs and the previous
+ * handlers are restored afterwards. The socket file is removed on shutdown.
+ * @param ctx The context holding the documentation.
+ * @param socketPath The path of the socket to create.
+ * @return true after a clean shutdown, false if the socket could not be created.
+ */
+bool runDocServer(ccdoc_context *ctx, const char *socketPath) {
+    struct pollfd fds[MAX_CLIENTS + 1];
+    Client *clients = malloc(MAX_CLIENTS * sizeof(Client));
+    if (clients == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for clients\n");
+        return false;
+    }
+
+    int listener = openListener(socketPath);
+    if (listener < 0) {
+        free(clients);
+        return false;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].output = NULL;
+        clients[i].outputLength = 0;
+        clients[i].outputSent = 0;
+    }
+
+    /* Stop on SIGINT and SIGTERM without restarting poll; the caller's handlers are restored below */
+    struct sigaction action;
+    struct sigaction previousInterrupt;
+    struct sigaction previousTerminate;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previousInterrupt);
+    sigaction(SIGTERM, &action, &previousTerminate);
+    stopRequested = 0;
+
+    while (!stopRequested) {
+        int fdCount = 0;
+        fds[fdCount].fd = listener;
+        fds[fdCount++].events = POLLIN;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            /* A client with too much unsent output is not read until it catches up */
+            size_t pending = clients[i].outputLength - clients[i].outputSent;
+            fds[fdCount].fd = clients[i].fd;
+            fds[fdCount].events = (pending < MAX_PENDING_OUTPUT && !clients[i].closing) ? POLLIN : 0;
+            fds[fdCount++].events |= pending > 0 ? POLLOUT : 0;
+        }
+
+        if (poll(fds, fdCount, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Waiting for requests failed\n");
+            break;
+        }
+
+        /* Accept a new client into a free slot */
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listener, NULL, NULL);
+            int slot = 0;
+            while (slot < MAX_CLIENTS && clients[slot].fd >= 0) {
+                slot++;
+            }
+            if (fd >= 0 && slot < MAX_CLIENTS && configureClientSocket(fd)) {
+                clients[slot].fd = fd;
+                clients[slot].length = 0;
+                clients[slot].closing = false;
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        /* Send queued answers and answer the clients with pending requests */
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            short revents = fds[i + 1].revents;
+            if (clients[i].fd < 0 || fds[i + 1].fd != clients[i].fd || revents == 0) {
+                continue;
+            }
+            bool keepOpen = true;
+            if (revents & POLLOUT) {
+                keepOpen = flushOutput(&clients[i]);
+            }
+            if (keepOpen && (revents & (POLLIN | POLLHUP | POLLERR)) && !clients[i].closing) {
+                keepOpen = serveClient(ctx, &clients[i]);
+            } else if (revents & (POLLHUP | POLLERR)) {
+                keepOpen = false;
+            }
+            if (!keepOpen || (clients[i].closing && clients[i].output == NULL)) {
+                closeClient(&clients[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            closeClient(&clients[i]);
+        }
+    }
+    free(clients);
+    close(listener);
+    unlink(socketPath);
+    sigaction(SIGINT, &previousInterrupt, NULL);
+    sigaction(SIGTERM, &previousTerminate, NULL);
+    return true;
+}
+
+#endif
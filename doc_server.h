@@ -0,0 +1,34 @@
+/**
+ * Module doc_server.h
+ * This module contains the function prototype of the documentation server, which keeps the
+ * parsed documentation in memory and answers symbol queries over a Unix domain socket.
+ *
+ * Every request is one JSON object on one line and is answered by one JSON object on one line:
+ *   {"op":"lookup","name":"processFile"}      functions with the given identifier
+ *   {"op":"prefix","prefix":"process"}        functions whose identifier starts with the prefix
+ *   {"op":"module","module":"utility.c"}      functions of a module (a header names its source file)
+ *   {"op":"reparse","file":"utility.c"}       parses the file again, replacing its module
+ * Successful answers have the form {"ok":true,"symbols":[...]}, failures {"ok":false,"error":"..."}.
+ */
+
+#ifndef DOC_SERVER_H
+#define DOC_SERVER_H
+
+#include "ccdoc.h"
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Serves symbol queries on a Unix domain socket until the process receives SIGINT or SIGTERM.
+ * @param ctx The context holding the documentation.
+ * @param socketPath The path of the socket to create.
+ * @return true after a clean shutdown, false if the socket could not be created.
+ */
+bool runDocServer(ccdoc_context *ctx, const char *socketPath);
+
+#endif 
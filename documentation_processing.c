@@ -5,7 +5,7 @@
 
 #include "documentation_processing.h"
 #include <stdbool.h>
-#include "global.h"
+#include "context.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -18,12 +18,13 @@
  * and validation of the line.
  * @param line The line of text to be processed.
  * @param comment Pointer to the DocComment structure where the processed information is stored.
+ * @return false if the line has an invalid format, true otherwise.
  */
-void processComment(const char *line, DocComment *comment) {
+bool processComment(const char *line, DocComment *comment) {
     /* Check for null pointers to prevent crashes */ 
     if (line == NULL || comment == NULL) {
         fprintf(stderr, "Error: Null pointer in processComment function\n");
-        return;
+        return true;
     }
 
     /* Skip leading spaces and asterisks (common in comment blocks) */
@@ -51,6 +52,25 @@ void processComment(const char *line, DocComment *comment) {
             }
     } 
     else if (strncmp(trimmedLine, "@param", 6) == 0) {
+            /* The entry is recorded for the parameter check even if its description is too short to be listed;
+               like the listed name, it ends after the word following the last '*', '[' or ']' */
+            const char *entry = trimmedLine + 6;
+            while (*entry == ' ') {
+                entry++;
+            }
+            if (comment->paramTagCount < MAX_PARAMS && *entry != '\0') {
+                const char *name = entry + strcspn(entry, " ");
+                const char *specialChar;
+                while ((specialChar = strpbrk(name, "*[]")) != NULL) {
+                    name = specialChar + 1;
+                }
+                while (*name == ' ') {
+                    name++;
+                }
+                const char *entryEnd = name + strcspn(name, " ");
+                snprintf(comment->paramTags[comment->paramTagCount], sizeof(comment->paramTags[0]), "%.*s", (int)(entryEnd - entry), entry);
+                comment->paramTagCount++;
+            }
             if (comment->paramCount < MAX_PARAMS) { /* Check that the limit is not exceeded */
             char *restOfLine = trimmedLine + 7;
             char *spaceAfterType = strchr(restOfLine, ' ');
@@ -83,8 +103,8 @@ void processComment(const char *line, DocComment *comment) {
             comment->returnVal[sizeof(comment->returnVal) - 1] = '\0'; /* Ensure null-termination */
         } 
         else {
-            invalidCommentFormat = 1;
             comment->returnVal[0] = '\0';
+            return false;
         }
     } 
     else if (strncmp(trimmedLine, "@author", 7) == 0) {
@@ -117,38 +137,74 @@ void processComment(const char *line, DocComment *comment) {
             comment->lastLineHadText = 0;
         }
     }
+    return true;
 }
 
 /**
- * Adds a function's documentation to the global collection.
+ * Adds a function's documentation to the collection of the context.
  * Compares and updates documentation if already exists.
+ * @param ctx The context holding the collection.
  * @param funcDoc The documentation details to add.
  * @return true if successfully added or updated, false otherwise.
  */
-bool addFunctionDoc(FunctionDoc *funcDoc) {
-    for (int i = 0; i < functionCount; i++) {
+bool addFunctionDoc(ccdoc_context *ctx, FunctionDoc *funcDoc) {
+    long long mergeStart = traceBegin(ctx->trace);
+
+    for (int i = 0; i < ctx->functionCount; i++) {
         /* Compare return type and function name */
-        if (strcmp(functionDocs[i].returnType, funcDoc->returnType) == 0 &&
-            strcmp(functionDocs[i].functionName, funcDoc->functionName) == 0) {
+        if (strcmp(ctx->functionDocs[i].returnType, funcDoc->returnType) == 0 &&
+            strcmp(ctx->functionDocs[i].functionName, funcDoc->functionName) == 0) {
             /* Update file types if new */
-            if (strchr(functionDocs[i].fileTypes, funcDoc->fileTypes[0]) == NULL) {
-                int len = strlen(functionDocs[i].fileTypes);
-                functionDocs[i].fileTypes[len] = funcDoc->fileTypes[0];
-                functionDocs[i].fileTypes[len + 1] = '\0';
+            if (strchr(ctx->functionDocs[i].fileTypes, funcDoc->fileTypes[0]) == NULL) {
+                int len = strlen(ctx->functionDocs[i].fileTypes);
+                ctx->functionDocs[i].fileTypes[len] = funcDoc->fileTypes[0];
+                ctx->functionDocs[i].fileTypes[len + 1] = '\0';
             }
 
             /* Merge comments */
-            mergeDocComments(&functionDocs[i].comment, &funcDoc->comment);
+            mergeDocComments(&ctx->functionDocs[i].comment, &funcDoc->comment);
+            traceEnd(ctx->trace, ctx->traceThreadId, "addFunctionDoc", "merge", funcDoc->functionName, mergeStart);
             return true;
         }
     }
 
     /* Add new function documentation */
-    if (functionCount < MAX_FUNCTIONS) {
-        functionDocs[functionCount] = *funcDoc;
-        functionCount++;
+    if (ctx->functionCount < MAX_FUNCTIONS) {
+        ctx->functionDocs[ctx->functionCount] = *funcDoc;
+        ctx->functionCount++;
+        ctx->symbolIndex.valid = false;
+        traceEnd(ctx->trace, ctx->traceThreadId, "addFunctionDoc", "merge", funcDoc->functionName, mergeStart);
         return true;
     }
 
+    traceEnd(ctx->trace, ctx->traceThreadId, "addFunctionDoc", "merge", funcDoc->functionName, mergeStart);
     return false;
+}
+
+/**
+ * Removes the documentation of all functions belonging to a module.
+ * The remaining functions keep their relative order.
+ * @param ctx The context holding the collection.
+ * @param moduleName The module name as built by moduleNameOfFile.
+ * @return The number of removed functions.
+ */
+int removeModuleDocs(ccdoc_context *ctx, const char *moduleName) {
+    int kept = 0;
+    for (int i = 0; i < ctx->functionCount; i++) {
+        char functionModule[256];
+        moduleNameOfFile(ctx->functionDocs[i].moduleName, functionModule, sizeof(functionModule));
+        if (strcmp(functionModule, moduleName) != 0) {
+            if (kept != i) {
+                ctx->functionDocs[kept] = ctx->functionDocs[i];
+            }
+            kept++;
+        }
+    }
+
+    int removed = ctx->functionCount - kept;
+    ctx->functionCount = kept;
+    if (removed > 0) {
+        ctx->symbolIndex.valid = false;
+    }
+    return removed;
 }
\ No newline at end of file
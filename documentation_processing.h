@@ -6,6 +6,7 @@
 #ifndef DOCUMENTATION_PROCESSING_H
 #define DOCUMENTATION_PROCESSING_H
 
+#include "ccdoc.h"
 #include "data_structures.h"
 #include <stdbool.h>
 
@@ -19,14 +20,24 @@
  * Processes a single line of documentation comment.
  * @param line The line to process.
  * @param comment The documentation comment structure to update.
+ * @return false if the line has an invalid format, true otherwise.
  */
-void processComment(const char *line, DocComment *comment);
+bool processComment(const char *line, DocComment *comment);
 
 /**
  * Adds a function's documentation to the collection.
+ * @param ctx The context holding the collection.
  * @param funcDoc Documentation details of the function.
  * @return true if addition is successful, false otherwise.
  */
-bool addFunctionDoc(FunctionDoc *funcDoc);
+bool addFunctionDoc(ccdoc_context *ctx, FunctionDoc *funcDoc);
+
+/**
+ * Removes the documentation of all functions belonging to a module.
+ * @param ctx The context holding the collection.
+ * @param moduleName The module name as built by moduleNameOfFile.
+ * @return The number of removed functions.
+ */
+int removeModuleDocs(ccdoc_context *ctx, const char *moduleName);
 
 #endif 
@@ -5,22 +5,48 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include "file_processing.h"
-#include "global.h"
+#include "context.h"
 #include "constants.h"
 #include "documentation_processing.h"
+#include "prefetch.h"
+#include "utility.h"
+#include "parse_cache.h"
+#include "param_check.h"
+#include "conditionals.h"
+
+/**
+ * @struct ParseState
+ * @brief Holds the state of the line-by-line parser for a single file.
+ */
+typedef struct {
+    const char *filename;             /* Name of the file being processed, used for tracing. */
+    ParsedFile *result;               /* Receives the includes and functions found in the file. */
+    DocComment comment;               /* Comment block currently being collected. */
+    bool inComment;                   /* Indicates if the parser is inside a comment block. */
+    bool commentReady;                /* Indicates if a complete comment waits for its prototype. */
+    char prototypeBuffer[1024];       /* Buffer to store the function prototype. */
+    long long commentStart;           /* Trace timestamp of the start of the comment block. */
+    long lineNumber;                  /* Number of the line being processed. */
+    long commentLine;                 /* Line on which the current comment block started. */
+    long commentLines;                /* Count of lines of the current comment block. */
+    bool skipComment;                 /* Indicates if an over-long comment block is being skipped. */
+    ConditionalState conditionals;    /* Open conditionals and the macros defined by the file. */
+} ParseState;
 
 /**
  * Checks if a file has already been processed to avoid duplicate processing.
+ * @param ctx Context holding the list of processed files.
  * @param filename Name of the file to check.
  * @return true if the file has been processed, false otherwise.
  */
-bool fileAlreadyProcessed(const char *filename) {
+bool fileAlreadyProcessed(const ccdoc_context *ctx, const char *filename) {
         /* Loop through all processed files */
-        for (int i = 0; i < processedCount; i++) {
-        if (strcmp(processedFiles[i], filename) == 0) {
+        for (int i = 0; i < ctx->processedCount; i++) {
+        if (strcmp(ctx->processedFiles[i], filename) == 0) {
             return true;
         }
     }
@@ -30,13 +56,14 @@ bool fileAlreadyProcessed(const char *filename) {
 /**
  * Adds a filename to the list of processed files.
  * This function is called after a file is successfully processed to mark it as done.
+ * @param ctx Context holding the list of processed files.
  * @param filename Name of the file to add to the processed list.
  */
-void addFileToProcessed(const char *filename) {
+void addFileToProcessed(ccdoc_context *ctx, const char *filename) {
         /* Check if the maximum file count has not been reached */
-        if (processedCount < MAX_FILES) {
-        strcpy(processedFiles[processedCount], filename);
-        processedCount++;
+        if (ctx->processedCount < MAX_FILES) {
+        strcpy(ctx->processedFiles[ctx->processedCount], filename);
+        ctx->processedCount++;
         } 
         else {
         fprintf(stderr, "Error: Limit of processed files exceeded\n");
@@ -44,127 +71,703 @@ void addFileToProcessed(const char *filename) {
 }
 
 /**
- * Main function to process a single C source or header file.
- * This function reads the file, extracts documentation comments, and processes them.
- * It also handles included files recursively.
- * @param filename Name of the file to process.
- * @param outputFile File pointer to the output file for documentation.
+ * Removes a file from the list of processed files and from the dependencies.
+ * @param ctx Context holding the lists.
+ * @param filename Name of the file to forget.
  */
-void processFile(const char *filename, FILE *outputFile) {
-    /* Check if the file has already been processed */
-    if (fileAlreadyProcessed(filename)) {
-        return;
+static void forgetProcessedFile(ccdoc_context *ctx, const char *filename) {
+    for (int i = 0; i < ctx->processedCount; i++) {
+        if (strcmp(ctx->processedFiles[i], filename) == 0) {
+            memmove(ctx->processedFiles[i], ctx->processedFiles[i + 1], (ctx->processedCount - i - 1) * sizeof(ctx->processedFiles[0]));
+            ctx->processedCount--;
+            break;
+        }
     }
-    /* Open the file for reading */
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Unable to open file %s\n", filename);
-        return;
+    for (int i = 0; i < ctx->dependencyCount; i++) {
+        if (strcmp(ctx->dependencies[i], filename) == 0) {
+            memmove(ctx->dependencies[i], ctx->dependencies[i + 1], (ctx->dependencyCount - i - 1) * sizeof(ctx->dependencies[0]));
+            ctx->dependencyCount--;
+            break;
+        }
     }
+}
 
-    /* Add the file to the processed list */
-    addFileToProcessed(filename);
+/**
+ * Prepares the parser state for a new file.
+ * @param state The parser state to initialize.
+ * @param filename Name of the file that is going to be processed.
+ * @param result The parse result receiving the includes and functions.
+ */
+static void initParseState(ParseState *state, const char *filename, ParsedFile *result) {
+    memset(state, 0, sizeof(ParseState));
+    state->filename = filename;
+    state->result = result;
+}
 
-    /* Define and initialize variables for processing */
-    DocComment comment;
-    char line[1024];
-    bool inComment = false;
-    bool commentReady = false;
-    char prototypeBuffer[1024] = {0}; /* Buffer to store the function prototype */
+/**
+ * Processes a single line of a source or header file.
+ * Includes are recorded, comment blocks are collected and the function prototype
+ * following a complete comment block is extracted and recorded in the parse result.
+ * A comment block longer than the limit of the context is given up and skipped up to its end.
+ * @param ctx Context whose timeline recorder, limits and statistics are used; its documentation is not changed.
+ * @param state Parser state of the file the line belongs to.
+ * @param line The line to process.
+ */
+static void processLine(ccdoc_context *ctx, ParseState *state, const char *line) {
     char *functionStart;
     char *functionEnd;
-    char fileType = (strstr(filename, ".h") != NULL) ? 'H' : 'C'; 
-
-    /* Process the file line by line */
-    while (fgets(line, sizeof(line), file)) {
-        /* Process includes, comments and function prototypes */
-        if (strstr(line, "#include")) {
-            char includedFileName[256];
-            if (sscanf(line, "#include \"%255[^\"]\"", includedFileName) == 1) {
-                processFile(includedFileName, outputFile); 
-            }
-        } 
-        else if (strstr(line, "/**") || strstr(line, "/*!")) {
-            /* Start of a comment block */
-            inComment = true;
-            initDocComment(&comment);
-            memset(prototypeBuffer, 0, sizeof(prototypeBuffer));
-        } 
-        else if (inComment && strstr(line, "*/")) {
-            /* End of a comment block */
-            inComment = false;
-            commentReady = true;
-        } 
-        else if (inComment) {
-            /* Inside a comment block, process the current line */
-            processComment(line, &comment);
-        } 
-        else if (commentReady) {
-
-            /* After a complete comment block, look for the function prototype */
-            if (strchr(line, '{') || strstr(line, ";")) {
-                strncat(prototypeBuffer, line, sizeof(prototypeBuffer) - strlen(prototypeBuffer) - 1);
-                if (strchr(prototypeBuffer, '{') || strstr(prototypeBuffer, ";")) {
-                    /* Process the function prototype */
-                    char *start = prototypeBuffer;
-                    while (*start && isspace((unsigned char)*start)) {
-                        start++;
-                    }
 
-                    functionStart = strchr(start, ' ');
-                    functionEnd = strchr(start, ')');
-
-                    if (functionStart && functionEnd && (functionEnd > functionStart)) {                        
-                        /* Extract return type and function name */
-                        char returnType[256];
-                        strncpy(returnType, start, functionStart - start);
-                        returnType[functionStart - start] = '\0';
-
-                        while (isspace((unsigned char)*functionStart)) {
-                            functionStart++;
-                        }
-
-                        char functionName[1024];
-                        strncpy(functionName, functionStart, functionEnd - functionStart + 1);
-                        functionName[functionEnd - functionStart + 1] = '\0';
-
-                        /* Create a FunctionDoc object and add it to the global array */
-                        FunctionDoc funcDoc;
-                        strncpy(funcDoc.returnType, returnType, sizeof(funcDoc.returnType));
-                        strncpy(funcDoc.functionName, functionName, sizeof(funcDoc.functionName));
-                        strncpy(funcDoc.moduleName, filename, sizeof(funcDoc.moduleName));
-                        funcDoc.fileTypes[0] = fileType;
-                        funcDoc.fileTypes[1] = '\0';
-                        funcDoc.comment = comment;
-
-                        /* Reset flags and initialize a new DocComment for the next function */
-                        addFunctionDoc(&funcDoc);
-                        commentReady = false;
-                        initDocComment(&comment);
+    /* An over-long comment block is skipped up to its end without being parsed */
+    if (state->skipComment) {
+        if (strstr(line, "*/")) {
+            state->skipComment = false;
+        }
+        return;
+    }
+
+    /* Process includes, comments and function prototypes */
+    if (strstr(line, "#include")) {
+        char includedFileName[256];
+        if (sscanf(line, "#include \"%255[^\"]\"", includedFileName) == 1) {
+            appendParsedInclude(state->result, includedFileName);
+        }
+    } 
+    else if (strstr(line, "/**") || strstr(line, "/*!")) {
+        /* Start of a comment block */
+        state->inComment = true;
+        state->commentStart = traceBegin(ctx->trace);
+        state->commentLine = state->lineNumber;
+        state->commentLines = 0;
+        initDocComment(&state->comment);
+        memset(state->prototypeBuffer, 0, sizeof(state->prototypeBuffer));
+    } 
+    else if (state->inComment && strstr(line, "*/")) {
+        /* End of a comment block */
+        state->inComment = false;
+        state->commentReady = true;
+        traceEnd(ctx->trace, ctx->traceThreadId, "processComment", "parse", state->filename, state->commentStart);
+    } 
+    else if (state->inComment && ctx->limits.maxCommentLines > 0 && ++state->commentLines > ctx->limits.maxCommentLines) {
+        /* The comment block is too long, possibly because it is not terminated */
+        fprintf(stderr, "Warning: Comment block in %s starting at line %ld exceeds %ld lines and is skipped\n",
+                state->filename, state->commentLine, ctx->limits.maxCommentLines);
+        ctx->statistics.limitHits[LIMIT_COMMENT_LINES]++;
+        state->inComment = false;
+        state->skipComment = true;
+        traceEnd(ctx->trace, ctx->traceThreadId, "processComment", "parse", state->filename, state->commentStart);
+    }
+    else if (state->inComment) {
+        /* Inside a comment block, process the current line */
+        if (!processComment(line, &state->comment)) {
+            state->result->invalidCommentFormat = true;
+        }
+    } 
+    else if (state->commentReady) {
+        char *prototypeBuffer = state->prototypeBuffer;
+        size_t prototypeSize = sizeof(state->prototypeBuffer);
+
+        /* After a complete comment block, look for the function prototype */
+        if (strchr(line, '{') || strstr(line, ";")) {
+            strncat(prototypeBuffer, line, prototypeSize - strlen(prototypeBuffer) - 1);
+            if (strchr(prototypeBuffer, '{') || strstr(prototypeBuffer, ";")) {
+                long long prototypeStart = traceBegin(ctx->trace);
+
+                /* Process the function prototype */
+                char *start = prototypeBuffer;
+                while (*start && isspace((unsigned char)*start)) {
+                    start++;
+                }
+
+                functionStart = strchr(start, ' ');
+                functionEnd = strchr(start, ')');
+
+                if (functionStart && functionEnd && (functionEnd > functionStart)) {                        
+                    /* Extract return type and function name */
+                    char returnType[256];
+                    strncpy(returnType, start, functionStart - start);
+                    returnType[functionStart - start] = '\0';
+
+                    while (isspace((unsigned char)*functionStart)) {
+                        functionStart++;
                     }
+
+                    char functionName[1024];
+                    strncpy(functionName, functionStart, functionEnd - functionStart + 1);
+                    functionName[functionEnd - functionStart + 1] = '\0';
+
+                    /* Create a FunctionDoc object; its module is set when it is added to a context */
+                    FunctionDoc funcDoc;
+                    memset(&funcDoc, 0, sizeof(FunctionDoc));
+                    strncpy(funcDoc.returnType, returnType, sizeof(funcDoc.returnType));
+                    strncpy(funcDoc.functionName, functionName, sizeof(funcDoc.functionName));
+                    /* The stored name ends at the first ')', so the parameters are read from the whole prototype */
+                    extractParameterNames(functionStart, funcDoc.paramNames, sizeof(funcDoc.paramNames));
+                    funcDoc.comment = state->comment;
+                    traceEnd(ctx->trace, ctx->traceThreadId, "extractPrototype", "parse", funcDoc.functionName, prototypeStart);
+
+                    /* Reset flags and initialize a new DocComment for the next function */
+                    appendParsedFunction(state->result, &funcDoc);
+                    state->commentReady = false;
+                    initDocComment(&state->comment);
                 }
-            }
-            else {
-                /* Accumulate lines until the complete prototype is read */
-                strncat(prototypeBuffer, line, sizeof(prototypeBuffer) - strlen(prototypeBuffer) - 1);
+                else {
+                    traceEnd(ctx->trace, ctx->traceThreadId, "extractPrototype", "parse", NULL, prototypeStart);
                 }
+            }
+        }
+        else {
+            /* Accumulate lines until the complete prototype is read */
+            strncat(prototypeBuffer, line, prototypeSize - strlen(prototypeBuffer) - 1);
+            }
+    }
+}
+
+/**
+ * Builds the name of the source file belonging to a header file.
+ * @param filename Name of the header file.
+ * @param cFilename Buffer of 256 characters receiving the name of the source file.
+ * @return true if the name could be built, false if the header has no extension.
+ */
+static bool sourceNameOfHeader(const char *filename, char *cFilename) {
+    strncpy(cFilename, filename, 255);
+    cFilename[255] = '\0';
+    char *dot = strrchr(cFilename, '.');
+    if (dot == NULL) {
+        return false;
+    }
+    strcpy(dot, ".c");  /* Replace .h with .c */
+    return true;
+}
+
+/**
+ * Checks if a file exists in the archive of the context or, without an archive, on disk.
+ * @param ctx Context whose archive is searched.
+ * @param filename Name of the file.
+ * @return true if the file exists, false otherwise.
+ */
+static bool inputFileExists(const ccdoc_context *ctx, const char *filename) {
+    if (ctx->archive != NULL) {
+        size_t size;
+        return findArchiveMember(ctx->archive, filename, &size) != NULL;
+    }
+    FILE *testFile = fopen(filename, "r");
+    if (testFile == NULL) {
+        return false;
+    }
+    fclose(testFile);
+    return true;
+}
+
+/**
+ * Processes the source file belonging to a header file, if such a file exists.
+ * @param ctx Context collecting the documentation.
+ * @param filename Name of the header file.
+ */
+static void processSourceOfHeader(ccdoc_context *ctx, const char *filename) {
+    char cFilename[256];
+    if (sourceNameOfHeader(filename, cFilename) && inputFileExists(ctx, cFilename)) {
+        processFile(ctx, cFilename);
+    }
+}
+
+/**
+ * Reads the next line from a memory buffer, behaving like fgets.
+ * @param cursor Pointer to the current read position, advanced past the returned line.
+ * @param end Pointer one past the last byte of the buffer.
+ * @param line Buffer receiving the line including its newline character.
+ * @param size Size of the line buffer.
+ * @return The number of characters stored in line, 0 at the end of the buffer.
+ */
+static size_t readBufferLine(const char **cursor, const char *end, char *line, size_t size) {
+    const char *p = *cursor;
+    size_t length = 0;
+
+    if (p >= end) {
+        return 0;
+    }
+    while (p < end && length < size - 1) {
+        line[length++] = *p;
+        if (*p++ == '\n') {
+            break;
+        }
+    }
+    line[length] = '\0';
+    *cursor = p;
+    return length;
+}
+
+/**
+ * Skips the lines of a region disabled by a conditional up to the next directive.
+ * The lines are only followed for block comments, so a '#' inside a comment is not taken for a
+ * directive; comments and prototypes in the region are not parsed.
+ * @param conditionals The conditional state of the file.
+ * @param cursor Pointer to the start of the first line to skip, advanced to the start of the next directive line.
+ * @param end End of the source code.
+ * @param maxLines Skipping stops once lineNumber reaches this many lines, 0 for no limit.
+ * @param lineNumber Pointer to the number of the last line read, increased by the skipped lines.
+ * @return The number of skipped lines.
+ */
+static long skipDisabledLines(ConditionalState *conditionals, const char **cursor, const char *end, long maxLines, long *lineNumber) {
+    const char *p = *cursor;
+    long skipped = 0;
+
+    while (p < end && (maxLines <= 0 || *lineNumber < maxLines)) {
+        const char *first = p;
+        while (first < end && (*first == ' ' || *first == '\t')) {
+            first++;
+        }
+        if (first < end && *first == '#' && !conditionals->commented) {
+            break;
+        }
+        const char *newline = memchr(first, '\n', (size_t)(end - first));
+        p = newline != NULL ? newline + 1 : end;
+        trackComments(conditionals, first, (size_t)(p - first));
+        (*lineNumber)++;
+        skipped++;
+    }
+    *cursor = p;
+    return skipped;
+}
+
+/**
+ * Reads the content of an open file into memory.
+ * @param file The file to read.
+ * @param maxSize Reading stops once more than this many bytes are read, 0 to read the whole file.
+ * @param size Pointer to the variable receiving the number of bytes read.
+ * @return Newly allocated buffer with the content, or NULL if memory could not be allocated.
+ */
+static char *loadFile(FILE *file, size_t maxSize, size_t *size) {
+    size_t capacity = 16384;
+    size_t length = 0;
+    char *data = malloc(capacity);
+
+    while (data != NULL) {
+        length += fread(data + length, 1, capacity - length, file);
+        if (length < capacity || (maxSize > 0 && length > maxSize)) {
+            break;
+        }
+        capacity *= 2;
+        char *grown = realloc(data, capacity);
+        if (grown == NULL) {
+            free(data);
+        }
+        data = grown;
+    }
+    *size = length;
+    return data;
+}
+
+/**
+ * Queues the files the parser is going to open next for reading ahead.
+ * These are the files included from the live regions of a parsed file that have not been
+ * processed yet and, for a header, its source file. The prefetcher goes on from them by itself.
+ * @param ctx Context holding the list of processed files and the prefetcher.
+ * @param filename Name of the parsed file.
+ * @param parsed The parse result of the file.
+ */
+static void prefetchDependencies(ccdoc_context *ctx, const char *filename, const ParsedFile *parsed) {
+    for (int i = 0; i < parsed->includeCount; i++) {
+        if (!fileAlreadyProcessed(ctx, parsed->includes[i])) {
+            queuePrefetch(ctx->prefetcher, parsed->includes[i]);
+        }
+    }
+
+    char cFilename[256];
+    if (strstr(filename, ".h") != NULL && sourceNameOfHeader(filename, cFilename)) {
+        queuePrefetch(ctx->prefetcher, cFilename);
+    }
+}
+
+/**
+ * Starts reading ahead for a file added to the context, unless an enclosing call already does.
+ * The file itself is read by the parser; the prefetcher starts from the includes it reports.
+ * @param ctx Context whose prefetch setting and limits are used.
+ * @return true if the call started the prefetcher and has to stop it, false otherwise.
+ */
+static bool beginPrefetch(ccdoc_context *ctx) {
+    if (!ctx->prefetch || ctx->archive != NULL || ctx->prefetcher != NULL) {
+        return false;
+    }
+    ctx->prefetcher = startPrefetcher(ctx->limits.maxFileBytes);
+    return ctx->prefetcher != NULL;
+}
+
+/**
+ * Stops reading ahead once the file that started it has been processed.
+ * @param ctx Context holding the prefetcher.
+ * @param started The result of beginPrefetch.
+ */
+static void endPrefetch(ccdoc_context *ctx, bool started) {
+    if (started) {
+        stopPrefetcher(ctx->prefetcher);
+        ctx->prefetcher = NULL;
+    }
+}
+
+/**
+ * Parses source code held in memory line by line.
+ * Only the part of the source code within the byte, line and time limits of the context is
+ * parsed; a diagnostic is printed and the hit is counted in the statistics of the context.
+ * Regions disabled by preprocessor conditionals, evaluated with the macros of the context, are skipped.
+ * @param ctx Context whose timeline recorder, limits and statistics are used.
+ * @param name Name of the file the source code comes from.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ * @param result The parse result receiving the includes and functions.
+ * @return true if a limit was hit or memory ran out, so the result is incomplete, false otherwise.
+ */
+static bool parseSource(ccdoc_context *ctx, const char *name, const char *data, size_t size, ParsedFile *result) {
+    const ResourceLimits *limits = &ctx->limits;
+    long commentLimitHits = ctx->statistics.limitHits[LIMIT_COMMENT_LINES];
+    long long parseStart = traceBegin(ctx->trace);
+    long long clockStart = limits->maxFileMilliseconds > 0 ? currentMicroseconds() : 0;
+    char line[1024];
+    const char *cursor = data;
+    bool truncated = false;
+    bool atLineStart = true;
+
+    /* The state holds a whole comment block, too much for the stack of a worker thread */
+    ParseState *state = malloc(sizeof(ParseState));
+    if (state == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for parsing %s\n", name);
+        return true;
+    }
+    initParseState(state, name, result);
+    initConditionals(&state->conditionals, ctx->macros);
+
+    if (limits->maxFileBytes > 0 && size > limits->maxFileBytes) {
+        fprintf(stderr, "Warning: File %s exceeds %zu bytes, the rest of it is not parsed\n", name, limits->maxFileBytes);
+        ctx->statistics.limitHits[LIMIT_BYTES]++;
+        size = limits->maxFileBytes;
+        truncated = true;
+    }
+
+    /* Process the source code line by line; longer lines arrive in several pieces */
+    size_t length;
+    long pieces = 0;
+    while ((length = readBufferLine(&cursor, data + size, line, sizeof(line))) > 0) {
+        if (atLineStart && limits->maxFileLines > 0 && state->lineNumber == limits->maxFileLines) {
+            fprintf(stderr, "Warning: File %s exceeds %ld lines, the rest of it is not parsed\n", name, limits->maxFileLines);
+            ctx->statistics.limitHits[LIMIT_LINES]++;
+            truncated = true;
+            break;
+        }
+        bool lineStart = atLineStart;
+        if (atLineStart) {
+            state->lineNumber++;
+        }
+        atLineStart = line[length - 1] == '\n';
+
+        /* Directives are only recognized at the start of a line outside comment blocks */
+        bool directive = lineStart && !state->inComment && !state->skipComment &&
+                         processDirective(&state->conditionals, line, name, state->lineNumber);
+        trackComments(&state->conditionals, line, length);
+        if (!directive && state->conditionals.live) {
+            processLine(ctx, state, line);
+        }
+        if (!state->conditionals.live && !state->conditionals.continued && atLineStart) {
+            ctx->statistics.linesSkipped += skipDisabledLines(&state->conditionals, &cursor, data + size, limits->maxFileLines, &state->lineNumber);
+        }
+
+        /* Reading the clock for every line would cost more than parsing it */
+        if (limits->maxFileMilliseconds > 0 && (++pieces & 255) == 0 &&
+            currentMicroseconds() - clockStart > limits->maxFileMilliseconds * 1000LL) {
+            fprintf(stderr, "Warning: Parsing %s takes longer than %ld ms, the rest of it is not parsed\n", name, limits->maxFileMilliseconds);
+            ctx->statistics.limitHits[LIMIT_TIME]++;
+            truncated = true;
+            break;
+        }
+    }
+
+    /* A comment block still open at the end of the file swallowed everything after its start */
+    if ((state->inComment || state->skipComment) && !truncated) {
+        fprintf(stderr, "Warning: Comment block in %s starting at line %ld is not terminated\n", name, state->commentLine);
+        ctx->statistics.unterminatedComments++;
+    }
+    finishConditionals(&state->conditionals, name, !truncated);
+
+    ctx->statistics.filesParsed++;
+    ctx->statistics.bytesParsed += (long)(cursor - data);
+    ctx->statistics.linesParsed += state->lineNumber;
+    ctx->statistics.functionsParsed += result->functionCount;
+    free(state);
+    traceEnd(ctx->trace, ctx->traceThreadId, "parseSource", "parse", name, parseStart);
+    return truncated || ctx->statistics.limitHits[LIMIT_COMMENT_LINES] != commentLimitHits;
+}
+
+/**
+ * Computes a fingerprint of the limits that decide which part of a file is parsed.
+ * The time limit is left out: a result cut short by it is never shared, and a complete
+ * result does not depend on it.
+ * @param limits The limits.
+ * @return The fingerprint.
+ */
+static uint64_t limitsFingerprint(const ResourceLimits *limits) {
+    unsigned long long values[3] = {
+        limits->maxFileBytes, (unsigned long long)limits->maxFileLines, (unsigned long long)limits->maxCommentLines
+    };
+    return hashContent((const char *)values, sizeof(values));
+}
+
+/**
+ * Adds a parse result to the context under the name the file was opened with.
+ * Includes are processed recursively at the position where they appear in the file,
+ * so the documentation is collected in the same order as if the file was parsed in place.
+ * @param ctx Context collecting the documentation.
+ * @param name Name of the file the parse result belongs to.
+ * @param parsed The parse result.
+ */
+static void addParsedFile(ccdoc_context *ctx, const char *name, const ParsedFile *parsed) {
+    char fileType = (strstr(name, ".h") != NULL) ? 'H' : 'C';
+    if (ctx->prefetcher != NULL) {
+        prefetchDependencies(ctx, name, parsed);
+    }
+
+    /* This function recurses once per include level, so the copy of a function lives on the heap */
+    FunctionDoc *funcDoc = NULL;
+    if (parsed->functionCount > 0 && (funcDoc = malloc(sizeof(FunctionDoc))) == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for the functions of %s\n", name);
+        return;
+    }
+    for (int i = 0; i < parsed->itemCount; i++) {
+        const ParsedItem *item = &parsed->items[i];
+        if (item->kind == PARSED_INCLUDE) {
+            processFile(ctx, parsed->includes[item->index]);
+        }
+        else {
+            *funcDoc = parsed->functions[item->index];
+            strncpy(funcDoc->moduleName, name, sizeof(funcDoc->moduleName));
+            funcDoc->fileTypes[0] = fileType;
+            funcDoc->fileTypes[1] = '\0';
+            addFunctionDoc(ctx, funcDoc);
         }
     }
+    free(funcDoc);
+    if (parsed->invalidCommentFormat) {
+        ctx->invalidCommentFormat = 1;
+    }
 
     /* If the file is a header file, attempt to find the corresponding source file */
     if (fileType == 'H') {
-        char cFilename[256];
-        strcpy(cFilename, filename);
-        char *dot = strrchr(cFilename, '.');
-        if (dot) {
-            strcpy(dot, ".c");  /* Replace .h with .c */
-            FILE *testFile = fopen(cFilename, "r");
-            if (testFile != NULL) {
-                fclose(testFile);
-                processFile(cFilename, outputFile);
-            }
+        processSourceOfHeader(ctx, name);
+    }
+}
+
+/**
+ * Parses source code, or takes its parse result from the shared cache, and adds it to the context.
+ * @param ctx Context collecting the documentation.
+ * @param name Name of the file the source code comes from.
+ * @param path Canonical path of the file, or NULL if the source code does not come from a file.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ */
+static void processSource(ccdoc_context *ctx, const char *name, const char *path, const char *data, size_t size) {
+    ParsedFile parsed;
+    initParsedFile(&parsed);
+
+    /* Without a cache, the parse result lives only while it is added */
+    if (ctx->cache == NULL || path == NULL) {
+        parseSource(ctx, name, data, size, &parsed);
+        addParsedFile(ctx, name, &parsed);
+        freeParsedFile(&parsed);
+        return;
+    }
+
+    /* The macros and the limits decide which regions are parsed, so they are part of the key */
+    uint64_t contentHash = hashContent(data, size) ^ macrosFingerprint(ctx->macros) ^ limitsFingerprint(&ctx->limits);
+    const ParsedFile *cached = findParsedFile(ctx->cache, path, contentHash, size);
+    if (cached == NULL) {
+        /* A result cut short by a limit is not shared, so every context reports the limit itself */
+        if (parseSource(ctx, name, data, size, &parsed)) {
+            abandonParsedFile(ctx->cache, path, contentHash, size);
+            addParsedFile(ctx, name, &parsed);
+            freeParsedFile(&parsed);
+            return;
         }
+        cached = storeParsedFile(ctx->cache, path, contentHash, size, &parsed);
+    }
+    else {
+        ctx->statistics.cacheHits++;
+    }
+    if (cached != NULL) {
+        addParsedFile(ctx, name, cached);
+    }
+}
+
+/**
+ * Records a file as an input of the generated document.
+ * @param ctx Context holding the list of dependencies.
+ * @param filename Name of the file.
+ */
+static void addDependency(ccdoc_context *ctx, const char *filename) {
+    if (ctx->dependencyCount < MAX_FILES) {
+        snprintf(ctx->dependencies[ctx->dependencyCount], sizeof(ctx->dependencies[0]), "%s", filename);
+        ctx->dependencyCount++;
     }
+}
+
+/**
+ * Processes a member of the archive attached to the context.
+ * The member is parsed in place; its includes are resolved against the archive.
+ * @param ctx Context collecting the documentation.
+ * @param filename Name of the member.
+ * @return false if the archive has no such member, true otherwise.
+ */
+static bool processArchiveMember(ccdoc_context *ctx, const char *filename) {
+    size_t size;
+    const char *data = findArchiveMember(ctx->archive, filename, &size);
+    if (data == NULL) {
+        fprintf(stderr, "Error: File %s is not in the archive\n", filename);
+        return false;
+    }
+    addFileToProcessed(ctx, filename);
+    addDependency(ctx, filename);
+
+    long long fileStart = traceBegin(ctx->trace);
+    processSource(ctx, filename, NULL, data, size);
+    traceEnd(ctx->trace, ctx->traceThreadId, "processFile", "parse", filename, fileStart);
+    return true;
+}
 
+/**
+ * Reads a file from disk and processes it.
+ * The file is read with a single call; if prefetching is enabled, the files it includes
+ * are read by a background thread ahead of the parser.
+ * @param ctx Context collecting the documentation.
+ * @param filename Name of the file to process.
+ * @return false if the file could not be opened or read, true otherwise.
+ */
+static bool processDiskFile(ccdoc_context *ctx, const char *filename) {
+    /* Open the file for reading */
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Unable to open file %s\n", filename);
+        return false;
+    }
+
+    /* Add the file to the processed list */
+    addFileToProcessed(ctx, filename);
+
+    long long fileStart = traceBegin(ctx->trace);
+    size_t size;
+    char *data = loadFile(file, ctx->limits.maxFileBytes, &size);
     fclose(file);
+    if (data == NULL) {
+        fprintf(stderr, "Error: Unable to read file %s\n", filename);
+        return false;
+    }
+
+    /* Record the file as an input of the generated document */
+    addDependency(ctx, filename);
+
+    /* The path is kept off the stack, which holds one frame of this function per include level */
+    char *path = malloc(4096);
+    processSource(ctx, filename, path != NULL && canonicalPath(filename, path, 4096) ? path : NULL, data, size);
+
+    free(path);
+    free(data);
+    traceEnd(ctx->trace, ctx->traceThreadId, "processFile", "parse", filename, fileStart);
+    return true;
+}
+
+/**
+ * Main function to process a single C source or header file.
+ * This function reads the file, extracts documentation comments, and processes them.
+ * It also handles included files recursively, up to the include depth limit of the context.
+ * If an archive is attached to the context, the file is taken from the archive instead of the disk.
+ * @param ctx Context collecting the documentation.
+ * @param filename Name of the file to process.
+ * @return false if the file could not be opened or read, true otherwise.
+ */
+bool processFile(ccdoc_context *ctx, const char *filename) {
+    /* Check if the file has already been processed */
+    if (fileAlreadyProcessed(ctx, filename)) {
+        return true;
+    }
+
+    /* Stop a runaway include recursion; the file may still be reached on a shorter path */
+    if (ctx->limits.maxIncludeDepth > 0 && ctx->includeDepth >= ctx->limits.maxIncludeDepth) {
+        fprintf(stderr, "Warning: File %s is nested deeper than %ld includes and is skipped\n", filename, ctx->limits.maxIncludeDepth);
+        ctx->statistics.limitHits[LIMIT_INCLUDE_DEPTH]++;
+        return true;
+    }
+
+    bool prefetching = beginPrefetch(ctx);
+    ctx->includeDepth++;
+    bool processed = ctx->archive != NULL ? processArchiveMember(ctx, filename) : processDiskFile(ctx, filename);
+    ctx->includeDepth--;
+    endPrefetch(ctx, prefetching);
+    return processed;
+}
+
+/**
+ * Processes source code held in memory in the same way processFile processes a file.
+ * Includes are resolved against the attached archive or, without one, the file system.
+ * @param ctx Context collecting the documentation.
+ * @param name Name under which the buffer is recorded.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ * @return true if the buffer was processed or had already been processed.
+ */
+bool processBuffer(ccdoc_context *ctx, const char *name, const char *data, size_t size) {
+    /* Check if the buffer has already been processed */
+    if (fileAlreadyProcessed(ctx, name)) {
+        return true;
+    }
+    addFileToProcessed(ctx, name);
+
+    long long bufferStart = traceBegin(ctx->trace);
+    bool prefetching = beginPrefetch(ctx);
+    processSource(ctx, name, NULL, data, size);
+    endPrefetch(ctx, prefetching);
+    traceEnd(ctx->trace, ctx->traceThreadId, "processBuffer", "parse", name, bufferStart);
+    return true;
+}
+
+/**
+ * Processes a file again after it has changed, replacing the documentation of its module.
+ * A header and its source file form one module, so the documentation of both is removed
+ * and both files are parsed again. Other modules are left untouched; includes that were
+ * already processed are not parsed again.
+ * @param ctx Context collecting the documentation.
+ * @param filename Name of the changed file.
+ * @return false if the file could not be opened, true otherwise.
+ */
+bool reprocessFile(ccdoc_context *ctx, const char *filename) {
+    char moduleName[256];
+    int moduleFileCount = 0;
+
+    /* The list can hold every processed file, which is too large for the stack of a server thread */
+    char (*moduleFiles)[256] = malloc(MAX_FILES * sizeof(*moduleFiles));
+    if (moduleFiles == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for reprocessing %s\n", filename);
+        return false;
+    }
+
+    /* Collect the processed files of the module, in the order they were processed */
+    moduleNameOfFile(filename, moduleName, sizeof(moduleName));
+    for (int i = 0; i < ctx->processedCount; i++) {
+        char fileModule[256];
+        moduleNameOfFile(ctx->processedFiles[i], fileModule, sizeof(fileModule));
+        if (strcmp(fileModule, moduleName) == 0) {
+            strcpy(moduleFiles[moduleFileCount++], ctx->processedFiles[i]);
+        }
+    }
+    if (moduleFileCount == 0) {
+        snprintf(moduleFiles[moduleFileCount++], sizeof(moduleFiles[0]), "%s", filename);
+    }
+
+    /* Drop the old documentation and parse the files of the module again */
+    removeModuleDocs(ctx, moduleName);
+    for (int i = 0; i < moduleFileCount; i++) {
+        forgetProcessedFile(ctx, moduleFiles[i]);
+    }
+    bool processed = true;
+    for (int i = 0; i < moduleFileCount; i++) {
+        if (!processFile(ctx, moduleFiles[i])) {
+            processed = false;
+        }
+    }
+    free(moduleFiles);
+    return processed;
 }
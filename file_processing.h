@@ -6,9 +6,10 @@
 #ifndef FILE_PROCESSING_H
 #define FILE_PROCESSING_H
 
-#include "data_structures.h"
+#include "ccdoc.h"
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* ____________________________________________________________________________
 
@@ -17,23 +18,44 @@
 */
 
 /**
- * Processes the specified source file and outputs formatted documentation to the provided output file.
+ * Processes the specified source file and collects its documentation in the context.
+ * @param ctx The context collecting the documentation.
  * @param filename The name of the file to process.
- * @param outputFile The file where the formatted documentation will be written.
+ * @return false if the file could not be opened, true otherwise.
  */
-void processFile(const char *filename, FILE *outputFile);
+bool processFile(ccdoc_context *ctx, const char *filename);
+
+/**
+ * Processes source code held in memory and collects its documentation in the context.
+ * @param ctx The context collecting the documentation.
+ * @param name The name under which the buffer is recorded.
+ * @param data The source code, not necessarily null-terminated.
+ * @param size The number of bytes in data.
+ * @return true if the buffer was processed or had already been processed.
+ */
+bool processBuffer(ccdoc_context *ctx, const char *name, const char *data, size_t size);
+
+/**
+ * Processes a file again after it has changed, replacing the documentation of its module.
+ * @param ctx The context collecting the documentation.
+ * @param filename The name of the changed file.
+ * @return false if the file could not be opened, true otherwise.
+ */
+bool reprocessFile(ccdoc_context *ctx, const char *filename);
 
 /**
  * Checks if the specified file has already been processed.
+ * @param ctx The context holding the list of processed files.
  * @param filename The name of the file to check.
  * @return true if the file has already been processed, false otherwise.
  */
-bool fileAlreadyProcessed(const char *filename);
+bool fileAlreadyProcessed(const ccdoc_context *ctx, const char *filename);
 
 /**
  * Records a file as processed to prevent duplicate processing.
+ * @param ctx The context holding the list of processed files.
  * @param filename The name of the file to mark as processed.
  */
-void addFileToProcessed(const char *filename);
+void addFileToProcessed(ccdoc_context *ctx, const char *filename);
 
 #endif 
\ No newline at end of file
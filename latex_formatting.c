@@ -9,7 +9,8 @@
 #include <stdbool.h>
 #include <string.h>
 #include "latex_formatting.h"
-#include "global.h"
+#include "context.h"
+#include "utility.h"
 
 /**
  * Formats a module name for LaTeX, changing .h to .c if necessary.
@@ -48,6 +49,33 @@ void escapeLaTeXChars(char *str) {
     strcpy(str, temp);
 }
 
+/**
+ * Builds the name under which a function's module appears in the document. A header whose
+ * module also has a source file, or whose functions were seen in the source, is shown as the
+ * source file.
+ * @param ctx Pointer to the context holding all documented functions.
+ * @param funcDoc Pointer to the documentation of the function.
+ * @param moduleName Buffer of 256 characters receiving the module name.
+ */
+void documentModuleName(const ccdoc_context *ctx, const FunctionDoc *funcDoc, char *moduleName) {
+    /* Checks if a corresponding .c file exists for a .h file */
+    bool hasCVersion = false;
+    for (int i = 0; i < ctx->functionCount; i++) {
+        if (strcmp(ctx->functionDocs[i].moduleName, funcDoc->moduleName) == 0 && strchr(ctx->functionDocs[i].fileTypes, 'C')) {
+            hasCVersion = true;
+            break;
+        }
+    }
+
+    strcpy(moduleName, funcDoc->moduleName);
+    char *dot = strrchr(moduleName, '.');
+    if (dot && (hasCVersion || strchr(funcDoc->fileTypes, 'C'))) {
+        strcpy(dot, ".c");  /* Change the suffix to .c */
+    }
+
+    formatModuleName(moduleName);
+}
+
 /**
  * Starts a LaTeX document, writing the preamble and section headers.
  * @param outputFile The output file for the LaTeX document.
@@ -60,6 +88,7 @@ void startLaTeXDocument(FILE *outputFile) {
 
 /**
  * @brief Formats function documentation into LaTeX format.
+ * @param ctx Pointer to the context holding all documented functions.
  * @param funcDoc Pointer to the documentation of the function.
  * @param outputFile File pointer to the output file for LaTeX formatted documentation.
  * @param isNewModule Pointer to a flag indicating if the current module is a new module in the document.
@@ -69,29 +98,14 @@ void startLaTeXDocument(FILE *outputFile) {
  * while also managing the structure of the document sections. It checks for corresponding .c files
  * for header files and formats module and function names with LaTeX special characters escaped.
  */
-void formatToLaTeX(const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName) {
+void formatToLaTeX(const ccdoc_context *ctx, const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName) {
     const DocComment *comment = &funcDoc->comment;
     char formattedModuleName[256];
     char tempStr[1024];
 
-    /* Checks if a corresponding .c file exists for a .h file */
-    bool hasCVersion = false;
-    for (int i = 0; i < functionCount; i++) {
-        if (strcmp(functionDocs[i].moduleName, funcDoc->moduleName) == 0 && strchr(functionDocs[i].fileTypes, 'C')) {
-            hasCVersion = true;
-            break;
-        }
-    }
-
     /* Format module name */
-    strcpy(formattedModuleName, funcDoc->moduleName);
+    documentModuleName(ctx, funcDoc, formattedModuleName);
     escapeLaTeXChars(formattedModuleName);
-    char *dot = strrchr(formattedModuleName, '.');
-    if (dot && (hasCVersion || strchr(funcDoc->fileTypes, 'C'))) {
-        strcpy(dot, ".c");  /* Change the suffix to .c */
-    }
-
-    formatModuleName(formattedModuleName);
 
     /* Check, if the module is new */
     if (strcmp(lastModuleName, formattedModuleName) != 0) {
@@ -161,6 +175,53 @@ void formatToLaTeX(const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModu
     fprintf(outputFile, "\n");
 }
 
+/**
+ * Formats function documentation with a user-supplied template.
+ * @param ctx Pointer to the context holding all documented functions.
+ * @param outputTemplate The compiled template.
+ * @param funcDoc Pointer to the documentation of the function.
+ * @param outputFile File pointer to the output file.
+ * @param isNewModule Pointer to a flag indicating if the current module is a new module in the document.
+ * @param lastModuleName String representing the last processed module name.
+ * The module section of the template is written before the first function of every module,
+ * then the function section.
+ */
+void formatWithTemplate(const ccdoc_context *ctx, const ccdoc_template *outputTemplate, const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName) {
+    const DocComment *comment = &funcDoc->comment;
+    char moduleName[256];
+    char prototype[520];
+    char identifier[256];
+    TemplateValues values;
+
+    documentModuleName(ctx, funcDoc, moduleName);
+    snprintf(prototype, sizeof(prototype), "%s %s", funcDoc->returnType, funcDoc->functionName);
+    functionIdentifier(funcDoc->functionName, identifier, sizeof(identifier));
+
+    values.fields[FIELD_MODULE] = moduleName;
+    values.fields[FIELD_PROTOTYPE] = prototype;
+    values.fields[FIELD_NAME] = identifier;
+    values.fields[FIELD_RETURN_TYPE] = funcDoc->returnType;
+    values.fields[FIELD_BRIEF] = comment->brief;
+    values.fields[FIELD_DETAILS] = comment->details;
+    values.fields[FIELD_DESCRIPTION] = comment->freeText;
+    values.fields[FIELD_AUTHOR] = comment->author;
+    values.fields[FIELD_VERSION] = comment->version;
+    values.fields[FIELD_RETURN] = comment->returnVal;
+    values.comment = comment;
+
+    /* Check, if the module is new */
+    if (strcmp(lastModuleName, moduleName) != 0) {
+        strcpy(lastModuleName, moduleName);
+        *isNewModule = true;
+    }
+
+    if (*isNewModule) {
+        renderTemplateSection(outputTemplate, TEMPLATE_MODULE, &values, outputFile);
+        *isNewModule = false;
+    }
+    renderTemplateSection(outputTemplate, TEMPLATE_FUNCTION, &values, outputFile);
+}
+
 /**
  * Ends a LaTeX document, writing the end document tag.
  * @param outputFile The output file for the LaTeX document.
@@ -6,7 +6,9 @@
 #ifndef LATEX_FORMATTING_H
 #define LATEX_FORMATTING_H
 
+#include "ccdoc.h"
 #include "data_structures.h"
+#include "output_template.h"
 #include <stdio.h>
 #include <stdbool.h>
 
@@ -28,6 +30,14 @@ void formatModuleName(char *moduleName);
  */
 void escapeLaTeXChars(char *str);
 
+/**
+ * Builds the name under which the module of a function appears in the document.
+ * @param ctx The context holding all documented functions.
+ * @param funcDoc Documentation of the function.
+ * @param moduleName Buffer of 256 characters receiving the module name.
+ */
+void documentModuleName(const ccdoc_context *ctx, const FunctionDoc *funcDoc, char *moduleName);
+
 /**
  * Starts a LaTeX document, writing the necessary headers.
  * @param outputFile The file where the LaTeX document is written.
@@ -36,12 +46,24 @@ void startLaTeXDocument(FILE *outputFile);
 
 /**
  * Formats the documentation of a function for LaTeX.
+ * @param ctx The context holding all documented functions.
+ * @param funcDoc Documentation of the function.
+ * @param outputFile The file where the formatted documentation will be written.
+ * @param isNewModule Pointer to a flag indicating if a new module is started.
+ * @param lastModuleName The name of the last processed module.
+ */
+void formatToLaTeX(const ccdoc_context *ctx, const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName);
+
+/**
+ * Formats the documentation of a function with a user-supplied template.
+ * @param ctx The context holding all documented functions.
+ * @param outputTemplate The compiled template.
  * @param funcDoc Documentation of the function.
  * @param outputFile The file where the formatted documentation will be written.
  * @param isNewModule Pointer to a flag indicating if a new module is started.
  * @param lastModuleName The name of the last processed module.
  */
-void formatToLaTeX(const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName);
+void formatWithTemplate(const ccdoc_context *ctx, const ccdoc_template *outputTemplate, const FunctionDoc *funcDoc, FILE *outputFile, bool *isNewModule, char *lastModuleName);
 
 /**
  * Ends a LaTeX document, writing the necessary footers.
@@ -1,93 +1,519 @@
 /**
  * Module main.c
  * This module contains the main function of the program.
+ * The program is a thin client of the libccdoc library declared in ccdoc.h.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
-#include "global.h"
 #include <string.h>
-#include "file_processing.h"
-#include "latex_formatting.h"
+#include "ccdoc.h"
+#include "manifest.h"
 
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
-//Global variables
+/**
+ * @struct Options
+ * @brief Holds the command-line arguments of the program.
+ */
+typedef struct {
+    const char *inputFileName;        /* Input file (obligatory unless a manifest is given). */
+    const char *outputFileName;       /* Output file (optional). */
+    const char *traceFileName;        /* Chrome trace output file, NULL if tracing is disabled. */
+    const char *dependencyFileName;   /* Name of the dependency file (-MF), NULL for the default. */
+    const char *socketPath;           /* Socket of the documentation server, NULL if not serving. */
+    const char *manifestFileName;     /* Manifest listing several documents, NULL for one document. */
+    const char *archiveFileName;      /* Tar archive holding the input files, "-" for standard input. */
+    const char *snapshotFileName;     /* Binary snapshot written after the run (--save-db), NULL for none. */
+    const char *oldSnapshotFileName;  /* Old snapshot compared by --diff, NULL if not comparing. */
+    const char *newSnapshotFileName;  /* New snapshot compared by --diff. */
+    const char *templateFileName;     /* Output template (--template), NULL for the built-in layout. */
+    DiffFormat diffFormat;            /* Format of the change report. */
+    ccdoc_macros *macros;             /* Macros given with -D and -U, NULL if there are none. */
+    GenerationSettings settings;      /* Order, prefetching, dependency files, thread count and limits. */
+    bool showStatistics;              /* Writes the statistics of the run to stderr (--stats). */
+} Options;
 
-char processedFiles[MAX_FILES][256];
-int processedCount = 0;
-FunctionDoc functionDocs[MAX_FUNCTIONS];
-int functionCount = 0;
-int invalidCommentFormat = 0;
+/**
+ * Applies a -D or -U option to the macros of the options, creating them on first use.
+ * @param options The options holding the macros.
+ * @param argv The array of command-line arguments.
+ * @param argc The number of command-line arguments.
+ * @param i Pointer to the index of the option, advanced past a separate argument.
+ * @return true if the option is valid, false otherwise.
+ */
+static bool parseMacroOption(Options *options, char *argv[], int argc, int *i) {
+    bool define = argv[*i][1] == 'D';
+    const char *text = argv[*i] + 2;
+    if (*text == '\0') {
+        if (*i + 1 >= argc) {
+            fprintf(stderr, "Error: Option %s requires a macro name\n", argv[*i]);
+            return false;
+        }
+        text = argv[++*i];
+    }
+    if (options->macros == NULL && (options->macros = ccdocMacrosCreate()) == NULL) {
+        return false;
+    }
+    if (!(define ? ccdocMacrosDefine(options->macros, text) : ccdocMacrosUndefine(options->macros, text))) {
+        fprintf(stderr, "Error: Invalid macro %s for option -%c\n", text, define ? 'D' : 'U');
+        return false;
+    }
+    options->settings.macros = options->macros;
+    return true;
+}
 
 /**
- * Main function of the program.
- * It processes an input C source file and generates LaTeX formatted documentation.
- * 
+ * Parses the command-line arguments into an Options structure.
+ * Options may appear anywhere; the remaining arguments are the input and output file.
  * @param argc The number of command-line arguments.
  * @param argv The array of command-line arguments.
- * @return An integer indicating the status of program execution.
+ * @param options Pointer to the Options structure to fill.
+ * @return true if the arguments are valid, false otherwise.
  */
-int main(int argc, char *argv[]) {
-    char outputFileName[256];  
+static bool parseArguments(int argc, char *argv[], Options *options) {
+    int positionalCount = 0;
+
+    memset(options, 0, sizeof(Options));
+    options->settings.order = ORDER_INCLUDE;
+    options->settings.prefetch = false;
+    defaultResourceLimits(&options->settings.limits);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --trace requires a file name\n");
+                return false;
+            }
+            options->traceFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--order") == 0) {
+            if (i + 1 >= argc || !parseOutputOrder(argv[i + 1], &options->settings.order)) {
+                fprintf(stderr, "Error: Option --order requires one of name, source or include\n");
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --serve requires a socket path\n");
+                return false;
+            }
+            options->socketPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--manifest") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --manifest requires a file name\n");
+                return false;
+            }
+            options->manifestFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--input-tar") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --input-tar requires a file name or -\n");
+                return false;
+            }
+            options->archiveFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--save-db") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --save-db requires a file name\n");
+                return false;
+            }
+            options->snapshotFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--template") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option --template requires a file name\n");
+                return false;
+            }
+            options->templateFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--diff") == 0) {
+            if (i + 2 >= argc) {
+                fprintf(stderr, "Error: Option --diff requires an old and a new snapshot\n");
+                return false;
+            }
+            options->oldSnapshotFileName = argv[++i];
+            options->newSnapshotFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--diff-format") == 0) {
+            if (i + 1 >= argc || !parseDiffFormat(argv[i + 1], &options->diffFormat)) {
+                fprintf(stderr, "Error: Option --diff-format requires one of latex, markdown or json\n");
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                fprintf(stderr, "Error: Option --jobs requires a positive number\n");
+                return false;
+            }
+            options->settings.jobs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--limit") == 0) {
+            if (i + 1 >= argc || !parseResourceLimit(argv[i + 1], &options->settings.limits)) {
+                fprintf(stderr, "Error: Option --limit requires name=value with a name of bytes, lines, comment-lines, time-ms or include-depth\n");
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--check") == 0) {
+            options->settings.checkParams = true;
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            options->showStatistics = true;
+        }
+        else if (strcmp(argv[i], "--prefetch") == 0) {
+            options->settings.prefetch = true;
+        }
+        else if (strcmp(argv[i], "--no-prefetch") == 0) {
+            options->settings.prefetch = false;
+        }
+        else if (strcmp(argv[i], "-MD") == 0) {
+            options->settings.writeDependencies = true;
+        }
+        else if (strcmp(argv[i], "-MP") == 0) {
+            options->settings.phonyTargets = true;
+        }
+        else if (strcmp(argv[i], "-MF") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: Option -MF requires a file name\n");
+                return false;
+            }
+            options->dependencyFileName = argv[++i];
+            options->settings.writeDependencies = true;
+        }
+        else if (strncmp(argv[i], "-D", 2) == 0 || strncmp(argv[i], "-U", 2) == 0) {
+            if (!parseMacroOption(options, argv, argc, &i)) {
+                return false;
+            }
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            return false;
+        }
+        else if (positionalCount == 0) {
+            options->inputFileName = argv[i];
+            positionalCount++;
+        }
+        else if (positionalCount == 1) {
+            options->outputFileName = argv[i];
+            positionalCount++;
+        }
+        else {
+            fprintf(stderr, "Error: Incorrect number of arguments\n");
+            return false;
+        }
+    }
+
+    /* Comparing snapshots reads no sources; the only file argument is the report */
+    if (options->oldSnapshotFileName != NULL) {
+        if (positionalCount > 1 || options->manifestFileName != NULL || options->archiveFileName != NULL ||
+            options->socketPath != NULL || options->snapshotFileName != NULL || options->templateFileName != NULL ||
+            options->settings.checkParams || options->macros != NULL) {
+            fprintf(stderr, "Error: Option --diff takes only an optional report file\n");
+            return false;
+        }
+        options->outputFileName = options->inputFileName;
+        options->inputFileName = NULL;
+        return true;
+    }
 
-    /* Check if the correct number of arguments is provided */
-    if (argc < 2) {
+    /* A manifest names the input and output files itself */
+    if (options->manifestFileName != NULL) {
+        if (positionalCount > 0 || options->dependencyFileName != NULL || options->socketPath != NULL ||
+            options->archiveFileName != NULL || options->snapshotFileName != NULL) {
+            fprintf(stderr, "Error: Option --manifest cannot be combined with input files, -MF, --serve, --input-tar or --save-db\n");
+            return false;
+        }
+        return true;
+    }
+
+    /* An archive is documented as a whole unless an input member is named */
+    if (options->archiveFileName != NULL) {
+        if (options->settings.writeDependencies || options->socketPath != NULL) {
+            fprintf(stderr, "Error: Option --input-tar cannot be combined with -MD, -MF or --serve\n");
+            return false;
+        }
+        return true;
+    }
+
+    /* A check without an output file writes no document, so there is no target for a rule */
+    if (options->settings.checkParams && options->outputFileName == NULL && options->settings.writeDependencies) {
+        fprintf(stderr, "Error: Option --check needs an output file to be combined with -MD or -MF\n");
+        return false;
+    }
+
+    /* Check if the input file is provided */
+    if (options->inputFileName == NULL) {
         fprintf(stderr, "Error: No input file provided\nEnter an input file (obligatory) and an output file (optional)\nFor instance: test.c |or| test.c output.tex\n");
-        return 1;  
+        return false;
     }
+    return true;
+}
 
-    /* Check if the correct number of arguments is provided */
-    if (argc > 3){
-        fprintf(stderr, "Error: Incorrect number of arguments\n");
-        return 1;
+/**
+ * Writes the recorded timeline to the trace file.
+ * @param trace The recorder holding the spans.
+ * @param traceFileName Name of the trace file.
+ * @return true on success, false if the file cannot be opened.
+ */
+static bool writeTraceFile(const Trace *trace, const char *traceFileName) {
+    FILE *traceFile = fopen(traceFileName, "w");
+    if (traceFile == NULL) {
+        fprintf(stderr, "Error: Unable to open trace file %s\n", traceFileName);
+        return false;
     }
+    traceWrite(trace, traceFile);
+    fclose(traceFile);
+    return true;
+}
 
-    /* Check if the input file can be opened */
-    FILE *inputFile = fopen(argv[1], "r");
-    if (inputFile == NULL) {
-        fprintf(stderr, "Error: File %s does not exist or cannot be opened\n", argv[1]);
-        return 2;  
+/**
+ * Parses the input once and answers symbol queries on a socket until the server is stopped.
+ * @param options The command-line options naming the input and the socket.
+ * @return An integer indicating the status of program execution.
+ */
+static int serveDocumentation(const Options *options) {
+    ccdoc_context *ctx = ccdocCreate();
+    if (ctx == NULL) {
+        return 2;
+    }
+    ccdocSetPrefetch(ctx, options->settings.prefetch);
+    ccdocSetLimits(ctx, &options->settings.limits);
+    ccdocSetMacros(ctx, options->macros);
+
+    int status = 0;
+    if (!ccdocAddFile(ctx, options->inputFileName)) {
+        status = 2;
     }
-    fclose(inputFile);  
-  
+    else if (!ccdocServe(ctx, options->socketPath)) {
+        status = 2;
+    }
+    ccdocDestroy(ctx);
+    return status;
+}
+
+/**
+ * Generates the single document named on the command line.
+ * @param options The command-line options naming the input and output file.
+ * @param statistics Pointer to the structure receiving the counters of the run.
+ * @return An integer indicating the status of program execution.
+ */
+static int generateSingleDocument(const Options *options, RunStatistics *statistics) {
+    DocumentTarget target;
+    memset(&target, 0, sizeof(target));
+    snprintf(target.inputFileName, sizeof(target.inputFileName), "%s", options->inputFileName);
+
     /* Determine the output file name based on the arguments */
-    if (argc == 3) {
-        strcpy(outputFileName, argv[2]);  
-    } else {
-        snprintf(outputFileName, sizeof(outputFileName), "%s-doc.tex", argv[1]);  
+    if (options->outputFileName != NULL) {
+        snprintf(target.outputFileName, sizeof(target.outputFileName), "%s", options->outputFileName);
+    } else if (!options->settings.checkParams) {
+        snprintf(target.outputFileName, sizeof(target.outputFileName), "%s-doc.tex", options->inputFileName);
+    }
+    if (options->dependencyFileName != NULL) {
+        snprintf(target.dependencyFileName, sizeof(target.dependencyFileName), "%s", options->dependencyFileName);
+    }
+    if (options->snapshotFileName != NULL) {
+        snprintf(target.snapshotFileName, sizeof(target.snapshotFileName), "%s", options->snapshotFileName);
+    }
+    return generateDocument(&target, &options->settings, NULL, 0, statistics);
+}
+
+/**
+ * Generates the document of the files held in a tar archive.
+ * The archive is read into memory, so no file is unpacked to disk. Without an output file,
+ * the document is written to standard output.
+ * @param options The command-line options naming the archive, the input member and the output file.
+ * @param statistics Pointer to the structure receiving the counters of the run.
+ * @return An integer indicating the status of program execution.
+ */
+static int generateArchiveDocument(const Options *options, RunStatistics *statistics) {
+    FILE *stream = stdin;
+    if (strcmp(options->archiveFileName, "-") != 0) {
+        stream = fopen(options->archiveFileName, "rb");
+        if (stream == NULL) {
+            fprintf(stderr, "Error: Unable to open archive %s\n", options->archiveFileName);
+            return 2;
+        }
+    }
+#ifdef _WIN32
+    else {
+        _setmode(_fileno(stdin), _O_BINARY);
     }
+#endif
 
-    /* Open the output file for writing */
-    FILE *outputFile = fopen(outputFileName, "w");
-    if (outputFile == NULL) {
-        fprintf(stderr, "Error: Unable to open output file %s\n", outputFileName);
-        return 2;  
+    ccdoc_archive *archive = ccdocArchiveRead(stream, options->settings.limits.maxFileBytes);
+    if (stream != stdin) {
+        fclose(stream);
+    }
+    if (archive == NULL) {
+        return 2;
     }
 
-    /* Start the LaTeX document */
-    startLaTeXDocument(outputFile);
+    DocumentTarget target;
+    memset(&target, 0, sizeof(target));
+    if (options->inputFileName != NULL) {
+        snprintf(target.inputFileName, sizeof(target.inputFileName), "%s", options->inputFileName);
+    }
+    if (options->outputFileName != NULL || !options->settings.checkParams) {
+        snprintf(target.outputFileName, sizeof(target.outputFileName), "%s", options->outputFileName ? options->outputFileName : "-");
+    }
+    if (options->snapshotFileName != NULL) {
+        snprintf(target.snapshotFileName, sizeof(target.snapshotFileName), "%s", options->snapshotFileName);
+    }
 
-    /* Process the input file and write documentation to the output file */
-    processFile(argv[1], outputFile);
+    GenerationSettings settings = options->settings;
+    settings.archive = archive;
+    int status = generateDocument(&target, &settings, NULL, 0, statistics);
+    ccdocArchiveDestroy(archive);
+    return status;
+}
 
-    bool isNewModule = true;  
-    char lastModuleName[256] = "";  
+/**
+ * Loads a snapshot file.
+ * @param snapshotFileName Name of the snapshot file.
+ * @return Pointer to the snapshot, or NULL if the file cannot be read or is not a snapshot.
+ */
+static ccdoc_snapshot *loadSnapshot(const char *snapshotFileName) {
+    FILE *snapshotFile = fopen(snapshotFileName, "rb");
+    if (snapshotFile == NULL) {
+        fprintf(stderr, "Error: Unable to open snapshot file %s\n", snapshotFileName);
+        return NULL;
+    }
+    ccdoc_snapshot *snapshot = ccdocSnapshotRead(snapshotFile, snapshotFileName);
+    fclose(snapshotFile);
+    return snapshot;
+}
 
-    /* Loop through all documented functions and format them for LaTeX */
-    for (int i = 0; i < functionCount; i++) {
-        formatToLaTeX(&functionDocs[i], outputFile, &isNewModule, lastModuleName);
+/**
+ * Loads and compiles an output template.
+ * @param templateFileName Name of the template file.
+ * @return Pointer to the compiled template, or NULL if the file cannot be read or is invalid.
+ */
+static ccdoc_template *loadTemplate(const char *templateFileName) {
+    FILE *templateFile = fopen(templateFileName, "rb");
+    if (templateFile == NULL) {
+        fprintf(stderr, "Error: Unable to open template file %s\n", templateFileName);
+        return NULL;
     }
+    ccdoc_template *outputTemplate = ccdocTemplateRead(templateFile, templateFileName);
+    fclose(templateFile);
+    return outputTemplate;
+}
 
-    /* Finalize the LaTeX document */
-    endLaTeXDocument(outputFile);
+/**
+ * Compares two snapshots and writes the change report to the output file or standard output.
+ * @param options The command-line options naming the snapshots, the report file and its format.
+ * @return An integer indicating the status of program execution.
+ */
+static int compareSnapshots(const Options *options) {
+    ccdoc_snapshot *oldSnapshot = loadSnapshot(options->oldSnapshotFileName);
+    ccdoc_snapshot *newSnapshot = oldSnapshot ? loadSnapshot(options->newSnapshotFileName) : NULL;
+    if (newSnapshot == NULL) {
+        ccdocSnapshotDestroy(oldSnapshot);
+        return 2;
+    }
 
-    /* Check if there was an invalid comment format detected */
-    if (invalidCommentFormat) {
-        fprintf(stderr, "Error: Invalid comment format detected\n");
-        fclose(outputFile);
-        return 3;  
+    int status = 0;
+    FILE *reportFile = stdout;
+    if (options->outputFileName != NULL && strcmp(options->outputFileName, "-") != 0) {
+        reportFile = fopen(options->outputFileName, "w");
+    }
+    if (reportFile == NULL) {
+        fprintf(stderr, "Error: Unable to open output file %s\n", options->outputFileName);
+        status = 2;
     }
+    else {
+        if (!ccdocDiffSnapshots(oldSnapshot, newSnapshot, options->diffFormat, reportFile)) {
+            status = 2;
+        }
+        if (reportFile != stdout) {
+            fclose(reportFile);
+        }
+    }
+    ccdocSnapshotDestroy(oldSnapshot);
+    ccdocSnapshotDestroy(newSnapshot);
+    return status;
+}
 
-    fclose(outputFile);  
-    return 0;  
+/**
+ * Main function of the program.
+ * It processes an input C source file and generates LaTeX formatted documentation.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return An integer indicating the status of program execution.
+ */
+int main(int argc, char *argv[]) {
+    Options options;
+
+    /* Check if the correct arguments are provided */
+    if (!parseArguments(argc, argv, &options)) {
+        ccdocMacrosDestroy(options.macros);
+        return 1;
+    }
+
+    /* In diff mode no sources are read */
+    if (options.oldSnapshotFileName != NULL) {
+        return compareSnapshots(&options);
+    }
+
+    /* In server mode no document is written */
+    if (options.socketPath != NULL) {
+        int status = serveDocumentation(&options);
+        ccdocMacrosDestroy(options.macros);
+        return status;
+    }
+
+    /* Compile the output template once for all documents */
+    ccdoc_template *outputTemplate = NULL;
+    if (options.templateFileName != NULL) {
+        outputTemplate = loadTemplate(options.templateFileName);
+        if (outputTemplate == NULL) {
+            ccdocMacrosDestroy(options.macros);
+            return 2;
+        }
+        options.settings.outputTemplate = outputTemplate;
+    }
+
+    /* Create the timeline recorder if requested */
+    if (options.traceFileName != NULL) {
+        options.settings.trace = traceCreate();
+        if (options.settings.trace == NULL) {
+            ccdocTemplateDestroy(outputTemplate);
+            ccdocMacrosDestroy(options.macros);
+            return 2;
+        }
+    }
+
+    /* Generate the documents listed in the manifest, the document of an archive or the one named on the command line */
+    RunStatistics statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    int status;
+    if (options.manifestFileName != NULL) {
+        status = runManifest(options.manifestFileName, &options.settings, &statistics);
+    } else if (options.archiveFileName != NULL) {
+        status = generateArchiveDocument(&options, &statistics);
+    } else {
+        status = generateSingleDocument(&options, &statistics);
+    }
+    if (options.showStatistics) {
+        writeRunStatistics(stderr, &statistics);
+    }
+
+    /* Write the timeline of the run if requested */
+    if (options.settings.trace != NULL) {
+        if (!writeTraceFile(options.settings.trace, options.traceFileName) && status == 0) {
+            status = 2;
+        }
+        traceDestroy(options.settings.trace);
+    }
+    ccdocTemplateDestroy(outputTemplate);
+    ccdocMacrosDestroy(options.macros);
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,369 @@
+/**
+ * Module manifest.c
+ * This module implements the generation of documents declared in manifest.h.
+ * A manifest run creates one parse cache for all documents and a pool of worker threads,
+ * each of which takes the next document from the list and generates it in its own context.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "manifest.h"
+#include "dependencies.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/* Stack size of a worker thread. Some platforms give threads only 512 KB or less by default,
+   while every include level takes a few KB on top of the stack used by parsing. */
+#define WORKER_STACK_SIZE ((size_t)8 << 20)
+
+/**
+ * @struct ManifestRun
+ * @brief State shared by the worker threads of a manifest run.
+ */
+typedef struct {
+    DocumentTarget *targets;          /* Documents listed in the manifest. */
+    int *statuses;                    /* Status of every document. */
+    RunStatistics *statistics;        /* Counters of every document. */
+    int targetCount;                  /* Count of documents. */
+    int nextTarget;                   /* Index of the next document to generate. */
+    pthread_mutex_t lock;             /* Protects nextTarget. */
+    const GenerationSettings *settings;  /* Settings of the generation. */
+    ccdoc_cache *cache;               /* Parse results shared by all documents. */
+} ManifestRun;
+
+/**
+ * @struct Worker
+ * @brief Argument of one worker thread.
+ */
+typedef struct {
+    ManifestRun *run;                 /* The shared run state. */
+    int threadId;                     /* Identifier written to the timeline. */
+} Worker;
+
+/**
+ * Writes the input files of a context as a make rule for the generated document.
+ * @param ctx The context that processed the input.
+ * @param target The generated document.
+ * @param phonyTargets true to add empty rules for the dependencies.
+ * @return true on success, false if the file cannot be opened.
+ */
+static bool writeDependencyFile(const ccdoc_context *ctx, const DocumentTarget *target, bool phonyTargets) {
+    char dependencyFileName[256];
+
+    if (target->dependencyFileName[0] != '\0') {
+        snprintf(dependencyFileName, sizeof(dependencyFileName), "%s", target->dependencyFileName);
+    } else {
+        defaultDependencyFileName(target->outputFileName, dependencyFileName, sizeof(dependencyFileName));
+    }
+
+    FILE *dependencyFile = fopen(dependencyFileName, "w");
+    if (dependencyFile == NULL) {
+        fprintf(stderr, "Error: Unable to open dependency file %s\n", dependencyFileName);
+        return false;
+    }
+    ccdocWriteDependencies(ctx, dependencyFile, target->outputFileName, phonyTargets);
+    fclose(dependencyFile);
+    return true;
+}
+
+/**
+ * Saves the documented functions of a context as a binary snapshot.
+ * @param ctx The context holding the documentation.
+ * @param snapshotFileName Name of the snapshot file.
+ * @return true on success, false if the file cannot be written.
+ */
+static bool writeSnapshotFile(const ccdoc_context *ctx, const char *snapshotFileName) {
+    FILE *snapshotFile = fopen(snapshotFileName, "wb");
+    if (snapshotFile == NULL) {
+        fprintf(stderr, "Error: Unable to open snapshot file %s\n", snapshotFileName);
+        return false;
+    }
+    bool saved = ccdocSaveSnapshot(ctx, snapshotFile);
+    if (fclose(snapshotFile) != 0) {
+        saved = false;
+    }
+    return saved;
+}
+
+/**
+ * Generates one document.
+ * @param target The document to generate.
+ * @param settings Settings of the generation.
+ * @param cache Shared parse results, may be NULL.
+ * @param threadId Identifier of the calling thread, written to the timeline.
+ * @param statistics Pointer to the structure receiving the counters of the run, may be NULL.
+ * @return 0 on success, 2 if a file cannot be opened, 3 if an invalid comment was found,
+ *         4 if the parameter check found a problem.
+ */
+int generateDocument(const DocumentTarget *target, const GenerationSettings *settings, ccdoc_cache *cache, int threadId, RunStatistics *statistics) {
+    /* Check if the input file can be opened; members of an archive are checked when they are added */
+    if (settings->archive == NULL) {
+        FILE *inputFile = fopen(target->inputFileName, "r");
+        if (inputFile == NULL) {
+            fprintf(stderr, "Error: File %s does not exist or cannot be opened\n", target->inputFileName);
+            return 2;
+        }
+        fclose(inputFile);
+    }
+
+    /* Open the output file for writing; a check alone writes no document */
+    bool noOutput = target->outputFileName[0] == '\0';
+    bool standardOutput = noOutput || strcmp(target->outputFileName, "-") == 0;
+    FILE *outputFile = standardOutput ? stdout : fopen(target->outputFileName, "w");
+    if (outputFile == NULL) {
+        fprintf(stderr, "Error: Unable to open output file %s\n", target->outputFileName);
+        return 2;
+    }
+
+    /* Create the context that owns all documentation state */
+    ccdoc_context *ctx = ccdocCreate();
+    if (ctx == NULL) {
+        if (!standardOutput) {
+            fclose(outputFile);
+        }
+        return 2;
+    }
+    ccdocSetTrace(ctx, settings->trace, threadId);
+    ccdocSetOrder(ctx, settings->order);
+    ccdocSetPrefetch(ctx, settings->prefetch);
+    ccdocSetCache(ctx, cache);
+    ccdocSetArchive(ctx, settings->archive);
+    ccdocSetLimits(ctx, &settings->limits);
+    ccdocSetTemplate(ctx, settings->outputTemplate);
+    ccdocSetMacros(ctx, settings->macros);
+
+    /* Process the input and write documentation to the output file */
+    int status = 0;
+    bool added;
+    if (settings->archive != NULL && target->inputFileName[0] == '\0') {
+        added = ccdocAddArchive(ctx);
+    } else {
+        added = ccdocAddFile(ctx, target->inputFileName);
+    }
+    if (!added) {
+        status = 2;
+    }
+    if (!noOutput) {
+        ccdocEmit(ctx, outputFile);
+    }
+
+    if (settings->writeDependencies && !writeDependencyFile(ctx, target, settings->phonyTargets)) {
+        status = 2;
+    }
+    if (target->snapshotFileName[0] != '\0' && !writeSnapshotFile(ctx, target->snapshotFileName)) {
+        status = 2;
+    }
+
+    /* Check if there was an invalid comment format detected */
+    if (ccdocHasInvalidComments(ctx)) {
+        fprintf(stderr, "Error: Invalid comment format detected in %s\n", target->inputFileName);
+        status = 3;
+    }
+
+    /* Check the documented parameters against the prototypes */
+    if (settings->checkParams) {
+        int problems = ccdocCheckParams(ctx, stderr);
+        if (problems < 0) {
+            status = 2;
+        } else if (problems > 0 && status == 0) {
+            status = 4;
+        }
+    }
+
+    if (statistics != NULL) {
+        ccdocStatistics(ctx, statistics);
+    }
+    ccdocDestroy(ctx);
+    if (standardOutput) {
+        fflush(outputFile);
+    } else {
+        fclose(outputFile);
+    }
+    return status;
+}
+
+/**
+ * Reads the documents listed in a manifest file.
+ * @param manifestFileName Name of the manifest file.
+ * @param targets Pointer receiving the newly allocated array of documents.
+ * @param targetCount Pointer receiving the count of documents.
+ * @return 0 on success, 1 for an invalid line, 2 if the file cannot be read.
+ */
+static int readManifest(const char *manifestFileName, DocumentTarget **targets, int *targetCount) {
+    FILE *manifest = fopen(manifestFileName, "r");
+    if (manifest == NULL) {
+        fprintf(stderr, "Error: Unable to open manifest file %s\n", manifestFileName);
+        return 2;
+    }
+
+    char line[1024];
+    int lineNumber = 0;
+    int capacity = 0;
+    int standardOutputLine = 0;
+    *targets = NULL;
+    *targetCount = 0;
+
+    while (fgets(line, sizeof(line), manifest)) {
+        char input[256];
+        char output[256];
+        char extra[2];
+        lineNumber++;
+
+        int fields = sscanf(line, " %255s %255s %1s", input, output, extra);
+        if (fields <= 0 || input[0] == '#') {
+            continue;
+        }
+        if (fields != 2) {
+            fprintf(stderr, "Error: Line %d of manifest %s must name an input and an output file\n", lineNumber, manifestFileName);
+            fclose(manifest);
+            free(*targets);
+            return 1;
+        }
+
+        /* Documents written to standard output at the same time would be interleaved */
+        if (strcmp(output, "-") == 0) {
+            if (standardOutputLine > 0) {
+                fprintf(stderr, "Error: Line %d of manifest %s writes to standard output, which line %d already does\n",
+                        lineNumber, manifestFileName, standardOutputLine);
+                fclose(manifest);
+                free(*targets);
+                return 1;
+            }
+            standardOutputLine = lineNumber;
+        }
+
+        /* Grow the array of documents if it is full */
+        if (*targetCount == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            DocumentTarget *grown = realloc(*targets, capacity * sizeof(DocumentTarget));
+            if (grown == NULL) {
+                fprintf(stderr, "Error: Unable to allocate memory for manifest\n");
+                fclose(manifest);
+                free(*targets);
+                return 2;
+            }
+            *targets = grown;
+        }
+        DocumentTarget *target = &(*targets)[(*targetCount)++];
+        memset(target, 0, sizeof(DocumentTarget));
+        strcpy(target->inputFileName, input);
+        strcpy(target->outputFileName, output);
+    }
+    fclose(manifest);
+    return 0;
+}
+
+/**
+ * Body of a worker thread: generates documents until none is left.
+ * @param argument Pointer to the Worker structure.
+ * @return Always NULL.
+ */
+static void *runWorker(void *argument) {
+    Worker *worker = argument;
+    ManifestRun *run = worker->run;
+
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        int index = run->nextTarget++;
+        pthread_mutex_unlock(&run->lock);
+        if (index >= run->targetCount) {
+            break;
+        }
+        run->statuses[index] = generateDocument(&run->targets[index], run->settings, run->cache, worker->threadId, &run->statistics[index]);
+    }
+    return NULL;
+}
+
+/**
+ * Determines the number of worker threads.
+ * @param requested The requested number, 0 for one per processor.
+ * @param targetCount Count of documents, the upper limit.
+ * @return The number of worker threads.
+ */
+static int workerCount(int requested, int targetCount) {
+    int count = requested;
+    if (count <= 0) {
+#ifdef _WIN32
+        count = 4;
+#else
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        count = processors > 0 ? (int)processors : 1;
+#endif
+    }
+    return count < targetCount ? count : targetCount;
+}
+
+/**
+ * Generates all documents listed in a manifest file.
+ * @param manifestFileName Name of the manifest file.
+ * @param settings Settings of the generation.
+ * @param statistics Pointer to the structure receiving the sum of the counters of all documents, may be NULL.
+ * @return The highest status returned by generateDocument, 1 for an invalid manifest
+ *         or 2 if the manifest cannot be opened.
+ */
+int runManifest(const char *manifestFileName, const GenerationSettings *settings, RunStatistics *statistics) {
+    ManifestRun run;
+    memset(&run, 0, sizeof(run));
+
+    int status = readManifest(manifestFileName, &run.targets, &run.targetCount);
+    if (status != 0 || run.targetCount == 0) {
+        return status;
+    }
+
+    run.settings = settings;
+    run.cache = ccdocCacheCreate();
+    run.statuses = calloc(run.targetCount, sizeof(int));
+    run.statistics = calloc(run.targetCount, sizeof(RunStatistics));
+    int threadCount = workerCount(settings->jobs, run.targetCount);
+    pthread_t *threads = malloc(threadCount * sizeof(pthread_t));
+    Worker *workers = malloc(threadCount * sizeof(Worker));
+    if (run.cache == NULL || run.statuses == NULL || run.statistics == NULL || threads == NULL || workers == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for manifest\n");
+        status = 2;
+    }
+    else {
+        pthread_mutex_init(&run.lock, NULL);
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setstacksize(&attributes, WORKER_STACK_SIZE);
+
+        /* Start the workers; if a thread cannot be created its share is done by the others */
+        int started = 0;
+        for (int i = 0; i < threadCount; i++) {
+            workers[i].run = &run;
+            workers[i].threadId = i + 1;
+            if (pthread_create(&threads[started], &attributes, runWorker, &workers[i]) == 0) {
+                started++;
+            }
+        }
+        pthread_attr_destroy(&attributes);
+        if (started == 0) {
+            runWorker(&workers[0]);
+        }
+        for (int i = 0; i < started; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_mutex_destroy(&run.lock);
+
+        for (int i = 0; i < run.targetCount; i++) {
+            if (run.statuses[i] > status) {
+                status = run.statuses[i];
+            }
+            if (statistics != NULL) {
+                addRunStatistics(statistics, &run.statistics[i]);
+            }
+        }
+    }
+
+    free(workers);
+    free(threads);
+    free(run.statuses);
+    free(run.statistics);
+    free(run.targets);
+    ccdocCacheDestroy(run.cache);
+    return status;
+}
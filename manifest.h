@@ -0,0 +1,80 @@
+/**
+ * Module manifest.h
+ * This module contains function prototypes for generating documents, either a single one or
+ * a batch of them listed in a manifest file, which are processed concurrently and share the
+ * parse results of common files.
+ */
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "ccdoc.h"
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct DocumentTarget
+ * @brief One document to generate and its input.
+ */
+typedef struct {
+    char inputFileName[256];          /* Input file (root of the include graph), empty for a whole archive. */
+    char outputFileName[256];         /* Generated LaTeX document, "-" for standard output, empty for none. */
+    char dependencyFileName[256];     /* Dependency file, empty for the default name. */
+    char snapshotFileName[256];       /* Binary snapshot of the documented functions, empty for none. */
+} DocumentTarget;
+
+/**
+ * @struct GenerationSettings
+ * @brief Settings shared by all generated documents.
+ */
+typedef struct {
+    OutputOrder order;                /* Order of the documented functions in the output. */
+    bool prefetch;                    /* Reads included files ahead of the parser. */
+    bool writeDependencies;           /* Writes a make dependency file for every document. */
+    bool phonyTargets;                /* Adds empty rules for the dependencies. */
+    int jobs;                         /* Number of worker threads, 0 for one per processor. */
+    Trace *trace;                     /* Timeline recorder, NULL if tracing is disabled. */
+    const ccdoc_archive *archive;     /* Archive the input files are read from, NULL for the file system. */
+    ResourceLimits limits;            /* Limits applied to every processed file. */
+    const ccdoc_template *outputTemplate; /* Template of the documents, NULL for the built-in layout. */
+    bool checkParams;                 /* Checks the documented parameters against the prototypes. */
+    const ccdoc_macros *macros;       /* Macros the conditionals are evaluated with, NULL for none. */
+} GenerationSettings;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Generates one document.
+ * @param target The document to generate.
+ * @param settings Settings of the generation.
+ * @param cache Shared parse results, may be NULL.
+ * @param threadId Identifier of the calling thread, written to the timeline.
+ * @param statistics Pointer to the structure receiving the counters of the run, may be NULL.
+ * @return 0 on success, 2 if a file cannot be opened, 3 if an invalid comment was found,
+ *         4 if the parameter check found a problem.
+ */
+int generateDocument(const DocumentTarget *target, const GenerationSettings *settings, ccdoc_cache *cache, int threadId, RunStatistics *statistics);
+
+/**
+ * Generates all documents listed in a manifest file.
+ * Every non-empty line not starting with '#' names an input file and an output file,
+ * separated by whitespace. The documents are generated concurrently and every distinct
+ * file is parsed only once.
+ * @param manifestFileName Name of the manifest file.
+ * @param settings Settings of the generation.
+ * @param statistics Pointer to the structure receiving the sum of the counters of all documents, may be NULL.
+ * @return The highest status returned by generateDocument, 1 for an invalid manifest
+ *         or 2 if the manifest cannot be opened.
+ */
+int runManifest(const char *manifestFileName, const GenerationSettings *settings, RunStatistics *statistics);
+
+#endif 
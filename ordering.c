@@ -0,0 +1,240 @@
+/**
+ * Module ordering.c
+ * This module implements the ordering pass that runs between parsing and emission.
+ * Functions are represented by compact (moduleId, key, index) records which are sorted with an
+ * LSD radix sort, so the large FunctionDoc structures are never moved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ordering.h"
+#include "utility.h"
+
+/**
+ * @struct OrderRecord
+ * @brief Compact sort record standing in for one documented function.
+ */
+typedef struct {
+    uint64_t key;                     /* Name prefix or source position within the module. */
+    uint32_t moduleId;                /* Rank of the module name among all modules. */
+    uint32_t index;                   /* Index of the function in the functionDocs array. */
+} OrderRecord;
+
+/**
+ * @struct ModuleEntry
+ * @brief Associates the module of a function with the function index while ranking modules.
+ */
+typedef struct {
+    char name[256];                   /* Module name as it appears in the document. */
+    int function;                     /* Index of the function in the functionDocs array. */
+} ModuleEntry;
+
+/* Number of byte digits in a record: eight for the key and four for the module. */
+#define ORDER_DIGITS 12
+
+/**
+ * Parses the name of an output order.
+ * @param name The name of the order ("name", "source" or "include").
+ * @param order Pointer to the variable receiving the order.
+ * @return true if the name is valid, false otherwise.
+ */
+bool parseOutputOrder(const char *name, OutputOrder *order) {
+    if (strcmp(name, "name") == 0) {
+        *order = ORDER_NAME;
+    }
+    else if (strcmp(name, "source") == 0) {
+        *order = ORDER_SOURCE;
+    }
+    else if (strcmp(name, "include") == 0) {
+        *order = ORDER_INCLUDE;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Compares two module entries by name, used with qsort.
+ * @param a Pointer to the first ModuleEntry.
+ * @param b Pointer to the second ModuleEntry.
+ * @return Negative, zero or positive value as with strcmp.
+ */
+static int compareModuleEntries(const void *a, const void *b) {
+    return strcmp(((const ModuleEntry *)a)->name, ((const ModuleEntry *)b)->name);
+}
+
+/**
+ * Skips the pointer declarators that the prototype parser leaves in front of a function name.
+ * @param name The function name.
+ * @return Pointer to the first character of the identifier.
+ */
+static const char *sortableName(const char *name) {
+    while (*name == '*' || *name == ' ') {
+        name++;
+    }
+    return name;
+}
+
+/**
+ * Builds the 64-bit sort key from the first eight bytes of a function name.
+ * Names sharing the prefix get equal keys and are ordered afterwards with strcmp.
+ * @param name The function name.
+ * @return The big-endian prefix of the name, padded with zero bytes.
+ */
+static uint64_t namePrefixKey(const char *name) {
+    uint64_t key = 0;
+    int i = 0;
+    for (; i < 8 && name[i] != '\0'; i++) {
+        key = (key << 8) | (unsigned char)name[i];
+    }
+    /* An empty name would need a shift by the full width, which C leaves undefined */
+    return i == 0 ? 0 : key << (8 * (8 - i));
+}
+
+/**
+ * Extracts one byte digit of a record, least significant first.
+ * @param record The record.
+ * @param digit Digit number, 0 to 7 for the key and 8 to 11 for the module.
+ * @return The value of the digit.
+ */
+static unsigned recordDigit(const OrderRecord *record, int digit) {
+    if (digit < 8) {
+        return (unsigned)(record->key >> (8 * digit)) & 0xFF;
+    }
+    return (unsigned)(record->moduleId >> (8 * (digit - 8))) & 0xFF;
+}
+
+/**
+ * Sorts records by module and key with a stable LSD radix sort.
+ * Digits on which all records agree are skipped.
+ * @param records The records to sort.
+ * @param count Count of records.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool radixSortRecords(OrderRecord *records, int count) {
+    OrderRecord *buffer = malloc(count * sizeof(OrderRecord));
+    if (buffer == NULL) {
+        return false;
+    }
+
+    OrderRecord *source = records;
+    OrderRecord *target = buffer;
+    for (int digit = 0; digit < ORDER_DIGITS; digit++) {
+        int histogram[256] = {0};
+        for (int i = 0; i < count; i++) {
+            histogram[recordDigit(&source[i], digit)]++;
+        }
+        if (histogram[recordDigit(&source[0], digit)] == count) {
+            continue;
+        }
+
+        /* Turn the counts into starting positions and scatter the records */
+        int position = 0;
+        for (int b = 0; b < 256; b++) {
+            int bucketCount = histogram[b];
+            histogram[b] = position;
+            position += bucketCount;
+        }
+        for (int i = 0; i < count; i++) {
+            target[histogram[recordDigit(&source[i], digit)]++] = source[i];
+        }
+
+        OrderRecord *swap = source;
+        source = target;
+        target = swap;
+    }
+
+    if (source != records) {
+        memcpy(records, source, count * sizeof(OrderRecord));
+    }
+    free(buffer);
+    return true;
+}
+
+/**
+ * Orders runs of records with equal module and name prefix by the full function name.
+ * The runs are short, so a stable insertion sort is used.
+ * @param records The records sorted by module and key.
+ * @param count Count of records.
+ * @param functionDocs Array of documented functions the records refer to.
+ */
+static void resolveNameTies(OrderRecord *records, int count, const FunctionDoc *functionDocs) {
+    for (int i = 1; i < count; i++) {
+        OrderRecord current = records[i];
+        int j = i - 1;
+        while (j >= 0 && records[j].moduleId == current.moduleId && records[j].key == current.key &&
+               strcmp(sortableName(functionDocs[records[j].index].functionName),
+                      sortableName(functionDocs[current.index].functionName)) > 0) {
+            records[j + 1] = records[j];
+            j--;
+        }
+        records[j + 1] = current;
+    }
+}
+
+/**
+ * Computes the order in which documented functions are emitted.
+ * Each module gets an identifier by the rank of its name, where a header and its source file
+ * form one module as in the LaTeX output. The records are then radix sorted by module and key.
+ * @param functionDocs Array of documented functions.
+ * @param functionCount Count of documented functions.
+ * @param order The requested order.
+ * @param indices Array of functionCount elements receiving the indices in emission order.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool orderFunctions(const FunctionDoc *functionDocs, int functionCount, OutputOrder order, int *indices) {
+    if (order == ORDER_INCLUDE || functionCount < 2) {
+        for (int i = 0; i < functionCount; i++) {
+            indices[i] = i;
+        }
+        return true;
+    }
+
+    ModuleEntry *modules = malloc(functionCount * sizeof(ModuleEntry));
+    OrderRecord *records = malloc(functionCount * sizeof(OrderRecord));
+    if (modules == NULL || records == NULL) {
+        free(modules);
+        free(records);
+        fprintf(stderr, "Error: Unable to allocate memory for ordering\n");
+        return false;
+    }
+
+    /* Rank the module names, mapping a header to its source file */
+    for (int i = 0; i < functionCount; i++) {
+        moduleNameOfFile(functionDocs[i].moduleName, modules[i].name, sizeof(modules[i].name));
+        modules[i].function = i;
+    }
+    qsort(modules, functionCount, sizeof(ModuleEntry), compareModuleEntries);
+
+    uint32_t moduleId = 0;
+    for (int i = 0; i < functionCount; i++) {
+        if (i > 0 && strcmp(modules[i - 1].name, modules[i].name) != 0) {
+            moduleId++;
+        }
+        OrderRecord *record = &records[modules[i].function];
+        record->moduleId = moduleId;
+        record->index = (uint32_t)modules[i].function;
+        record->key = (order == ORDER_NAME) ? namePrefixKey(sortableName(functionDocs[modules[i].function].functionName))
+                                            : (uint64_t)modules[i].function;
+    }
+    free(modules);
+
+    /* Sort the records and copy out the resulting order */
+    bool sorted = radixSortRecords(records, functionCount);
+    if (sorted) {
+        if (order == ORDER_NAME) {
+            resolveNameTies(records, functionCount, functionDocs);
+        }
+        for (int i = 0; i < functionCount; i++) {
+            indices[i] = (int)records[i].index;
+        }
+    }
+    else {
+        fprintf(stderr, "Error: Unable to allocate memory for ordering\n");
+    }
+    free(records);
+    return sorted;
+}
@@ -0,0 +1,53 @@
+/**
+ * Module ordering.h
+ * This module contains function prototypes for ordering documented functions before they are emitted.
+ */
+
+#ifndef ORDERING_H
+#define ORDERING_H
+
+#include "data_structures.h"
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @enum OutputOrder
+ * @brief Order in which documented functions are emitted.
+ */
+typedef enum {
+    ORDER_NAME,        /* Grouped by module, sorted by function name within each module. */
+    ORDER_SOURCE,      /* Grouped by module, in source order within each module. */
+    ORDER_INCLUDE      /* In the order the include recursion discovered the functions. */
+} OutputOrder;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Parses the name of an output order.
+ * @param name The name of the order ("name", "source" or "include").
+ * @param order Pointer to the variable receiving the order.
+ * @return true if the name is valid, false otherwise.
+ */
+bool parseOutputOrder(const char *name, OutputOrder *order);
+
+/**
+ * Computes the order in which documented functions are emitted.
+ * Modules are sorted by name and the functions are not moved; only their indices are sorted.
+ * @param functionDocs Array of documented functions.
+ * @param functionCount Count of documented functions.
+ * @param order The requested order.
+ * @param indices Array of functionCount elements receiving the indices in emission order.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool orderFunctions(const FunctionDoc *functionDocs, int functionCount, OutputOrder order, int *indices);
+
+#endif 
@@ -0,0 +1,483 @@
+/**
+ * Module output_template.c
+ * This module implements the output templates declared in output_template.h.
+ * Compilation turns the template into a flat list of operations: literal text segments, field
+ * values, and conditions and loops that jump to a precomputed position. Rendering only walks
+ * that list, so the cost per function does not depend on how the template was written.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "output_template.h"
+#include "utility.h"
+
+/* Maximal nesting of conditions and loops in a template. */
+#define MAX_TEMPLATE_DEPTH 16
+
+/**
+ * @enum TemplateOpcode
+ * @brief Kind of a compiled template operation.
+ */
+typedef enum {
+    OP_TEXT,                          /* Write a segment of the template text. */
+    OP_FIELD,                         /* Write a field with LaTeX special characters escaped. */
+    OP_RAW_FIELD,                     /* Write a field as it is. */
+    OP_IF,                            /* Jump if the field is empty. */
+    OP_IF_NOT,                        /* Jump if the field is not empty. */
+    OP_LOOP,                          /* Start the parameter loop, jump if there are no parameters. */
+    OP_LOOP_END                       /* Jump back to the loop body if parameters remain. */
+} TemplateOpcode;
+
+/**
+ * @struct TemplateOp
+ * @brief One compiled template operation.
+ */
+typedef struct {
+    TemplateOpcode opcode;            /* Kind of the operation. */
+    TemplateField field;              /* Field of OP_FIELD, OP_RAW_FIELD, OP_IF and OP_IF_NOT. */
+    size_t offset;                    /* Start of the text segment of OP_TEXT. */
+    size_t length;                    /* Length of the text segment of OP_TEXT. */
+    int jump;                         /* Target of OP_IF, OP_IF_NOT, OP_LOOP and OP_LOOP_END. */
+} TemplateOp;
+
+struct ccdoc_template {
+    char *text;                       /* Copy of the template text the segments point into. */
+    TemplateOp *ops;                  /* The operations of all sections. */
+    int opCount;                      /* Count of operations. */
+    int opCapacity;                   /* Allocated count of operations. */
+    int sectionStart[TEMPLATE_SECTION_COUNT]; /* First operation of every section. */
+    int sectionEnd[TEMPLATE_SECTION_COUNT];   /* Operation following every section. */
+};
+
+/**
+ * @struct OpenBlock
+ * @brief Condition or loop whose closing tag has not been reached yet.
+ */
+typedef struct {
+    int op;                           /* Index of the operation opening the block. */
+    TemplateField field;              /* Field named by the opening tag. */
+} OpenBlock;
+
+/* Names of the fields, indexed by TemplateField. */
+static const char *const FIELD_NAMES[TEMPLATE_FIELD_COUNT] = {
+    "module", "prototype", "name", "returnType", "brief", "details", "description",
+    "author", "version", "return", "params", "paramName", "paramDesc", "last"
+};
+
+/* Names of the sections, indexed by TemplateSection. */
+static const char *const SECTION_NAMES[TEMPLATE_SECTION_COUNT] = {
+    "begin", "module", "function", "end"
+};
+
+/**
+ * Finds a name in a table of names.
+ * @param names The table.
+ * @param count Count of names in the table.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @return Index of the name, or -1 if it is not in the table.
+ */
+static int findName(const char *const *names, int count, const char *name, size_t length) {
+    for (int i = 0; i < count; i++) {
+        if (strlen(names[i]) == length && strncmp(names[i], name, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Checks whether the content of a tag names a field or section, so it is not LaTeX that
+ * happens to hold two braces, like "{\bf x}" inside a group.
+ * @param name The name, not necessarily null-terminated.
+ * @param length Length of the name.
+ * @return true if the name is a non-empty identifier, false otherwise.
+ */
+static bool isTagName(const char *name, size_t length) {
+    if (length == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Appends an operation to a template.
+ * @param outputTemplate The template being compiled.
+ * @param opcode Kind of the operation.
+ * @param field Field of the operation.
+ * @return Index of the new operation, or -1 if memory could not be allocated.
+ */
+static int appendOp(ccdoc_template *outputTemplate, TemplateOpcode opcode, TemplateField field) {
+    if (outputTemplate->opCount == outputTemplate->opCapacity) {
+        int capacity = outputTemplate->opCapacity ? outputTemplate->opCapacity * 2 : 64;
+        TemplateOp *grown = realloc(outputTemplate->ops, (size_t)capacity * sizeof(TemplateOp));
+        if (grown == NULL) {
+            return -1;
+        }
+        outputTemplate->ops = grown;
+        outputTemplate->opCapacity = capacity;
+    }
+    TemplateOp *op = &outputTemplate->ops[outputTemplate->opCount];
+    op->opcode = opcode;
+    op->field = field;
+    op->offset = 0;
+    op->length = 0;
+    op->jump = -1;
+    return outputTemplate->opCount++;
+}
+
+/**
+ * Appends a segment of literal text to a template.
+ * @param outputTemplate The template being compiled.
+ * @param offset Start of the segment in the template text.
+ * @param length Length of the segment.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool appendText(ccdoc_template *outputTemplate, size_t offset, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    int index = appendOp(outputTemplate, OP_TEXT, FIELD_MODULE);
+    if (index < 0) {
+        return false;
+    }
+    outputTemplate->ops[index].offset = offset;
+    outputTemplate->ops[index].length = length;
+    return true;
+}
+
+/**
+ * Returns the line on which a position of the template lies.
+ * @param text The template text.
+ * @param position The position.
+ * @return The line number, starting at 1.
+ */
+static int lineOfPosition(const char *text, size_t position) {
+    int line = 1;
+    for (size_t i = 0; i < position; i++) {
+        if (text[i] == '\n') {
+            line++;
+        }
+    }
+    return line;
+}
+
+/**
+ * Compiles a template.
+ * @param text The template text, not necessarily null-terminated.
+ * @param size The number of bytes in text.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if the template is invalid.
+ */
+ccdoc_template *compileTemplate(const char *text, size_t size, const char *name) {
+    ccdoc_template *outputTemplate = calloc(1, sizeof(ccdoc_template));
+    if (outputTemplate == NULL || (outputTemplate->text = malloc(size + 1)) == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for template %s\n", name);
+        free(outputTemplate);
+        return NULL;
+    }
+    memcpy(outputTemplate->text, text, size);
+    outputTemplate->text[size] = '\0';
+    text = outputTemplate->text;
+
+    OpenBlock blocks[MAX_TEMPLATE_DEPTH];
+    int depth = 0;
+    int loopDepth = 0;
+    int section = -1;
+    bool defined[TEMPLATE_SECTION_COUNT] = { false };
+    const char *error = NULL;
+    size_t position = 0;
+    size_t errorPosition = 0;
+
+    while (error == NULL && position < size) {
+        const char *tag = strstr(text + position, "{{");
+        if (tag == NULL) {
+            tag = text + size;
+        }
+        /* In a run of braces the tag starts at the last two, so "\texttt{{{name}}}" works */
+        while (tag[0] != '\0' && tag[2] == '{') {
+            tag++;
+        }
+        size_t tagPosition = (size_t)(tag - text);
+        errorPosition = position;
+        if (section >= 0) {
+            if (!appendText(outputTemplate, position, tagPosition - position)) {
+                error = "out of memory";
+                break;
+            }
+        } else {
+            for (size_t i = position; i < tagPosition && error == NULL; i++) {
+                if (strchr(" \t\r\n", text[i]) == NULL) {
+                    error = "text before the first section";
+                }
+            }
+        }
+        if (error != NULL || tagPosition >= size) {
+            break;
+        }
+
+        errorPosition = tagPosition;
+        const char *end = strstr(tag + 2, "}}");
+        if (end == NULL) {
+            end = text + size;
+        }
+
+        /* The tag without surrounding spaces and its kind */
+        const char *content = tag + 2;
+        while (content < end && *content == ' ') {
+            content++;
+        }
+        size_t length = (size_t)(end - content);
+        while (length > 0 && content[length - 1] == ' ') {
+            length--;
+        }
+        char kind = length > 0 && strchr("@!?^#/&", content[0]) ? content[0] : '\0';
+        const char *tagName = kind ? content + 1 : content;
+        size_t nameLength = kind ? length - 1 : length;
+
+        /* Braces around anything but a name are text, so "\newcommand{\x}{{\bf x}}" needs no escape */
+        if (kind != '!' && !isTagName(tagName, nameLength) &&
+            (*end != '\0' || !isalnum((unsigned char)tagName[0]))) {
+            if (section < 0) {
+                error = "text before the first section";
+            } else if (!appendText(outputTemplate, tagPosition, 2)) {
+                error = "out of memory";
+            }
+            position = tagPosition + 2;
+            continue;
+        }
+        if (*end == '\0') {
+            error = "unterminated tag";
+            break;
+        }
+        position = (size_t)(end - text) + 2;
+        if (kind == '!') {
+            continue;
+        }
+
+        if (kind == '@') {
+            int newSection = findName(SECTION_NAMES, TEMPLATE_SECTION_COUNT, tagName, nameLength);
+            if (newSection < 0) {
+                error = "unknown section";
+            } else if (depth > 0) {
+                error = "section starts inside a block";
+            } else if (defined[newSection]) {
+                error = "section defined twice";
+            } else {
+                if (section >= 0) {
+                    outputTemplate->sectionEnd[section] = outputTemplate->opCount;
+                }
+                section = newSection;
+                defined[section] = true;
+                outputTemplate->sectionStart[section] = outputTemplate->opCount;
+                /* A section marker takes its whole line */
+                if (text[position] == '\r') {
+                    position++;
+                }
+                if (text[position] == '\n') {
+                    position++;
+                }
+            }
+            continue;
+        }
+        if (section < 0) {
+            error = "tag before the first section";
+            break;
+        }
+
+        int field = findName(FIELD_NAMES, TEMPLATE_FIELD_COUNT, tagName, nameLength);
+        if (field < 0) {
+            error = "unknown field";
+        } else if (field > FIELD_PARAMS && loopDepth == 0) {
+            error = "parameter field outside {{#params}}";
+        } else if (kind == '/') {
+            if (depth == 0 || blocks[depth - 1].field != (TemplateField)field) {
+                error = "closing tag does not match the open block";
+            } else {
+                OpenBlock *block = &blocks[--depth];
+                if (outputTemplate->ops[block->op].opcode == OP_LOOP) {
+                    int index = appendOp(outputTemplate, OP_LOOP_END, FIELD_PARAMS);
+                    if (index < 0) {
+                        error = "out of memory";
+                        break;
+                    }
+                    outputTemplate->ops[index].jump = block->op + 1;
+                    loopDepth--;
+                }
+                outputTemplate->ops[block->op].jump = outputTemplate->opCount;
+            }
+        } else if (kind == '?' || kind == '^' || kind == '#') {
+            if (kind == '#' && field != FIELD_PARAMS) {
+                error = "only {{#params}} can be repeated";
+            } else if (kind == '#' && loopDepth > 0) {
+                error = "{{#params}} inside {{#params}}";
+            } else if (depth == MAX_TEMPLATE_DEPTH) {
+                error = "blocks nested too deeply";
+            } else {
+                TemplateOpcode opcode = kind == '#' ? OP_LOOP : kind == '?' ? OP_IF : OP_IF_NOT;
+                int index = appendOp(outputTemplate, opcode, (TemplateField)field);
+                if (index < 0) {
+                    error = "out of memory";
+                    break;
+                }
+                blocks[depth].op = index;
+                blocks[depth].field = (TemplateField)field;
+                depth++;
+                loopDepth += kind == '#';
+            }
+        } else if (kind == '\0' || kind == '&') {
+            if (field == FIELD_PARAMS || field == FIELD_LAST) {
+                error = "field can only be used in a condition";
+            } else if (appendOp(outputTemplate, kind == '&' ? OP_RAW_FIELD : OP_FIELD, (TemplateField)field) < 0) {
+                error = "out of memory";
+            }
+        }
+    }
+
+    if (error == NULL && depth > 0) {
+        error = "block is not closed";
+        errorPosition = size;
+    }
+    if (error == NULL && section < 0) {
+        error = "template has no sections";
+        errorPosition = size;
+    }
+    if (error != NULL) {
+        fprintf(stderr, "Error: Template %s, line %d: %s\n", name, lineOfPosition(text, errorPosition), error);
+        destroyTemplate(outputTemplate);
+        return NULL;
+    }
+    outputTemplate->sectionEnd[section] = outputTemplate->opCount;
+    return outputTemplate;
+}
+
+/**
+ * Reads a template from a stream and compiles it.
+ * @param inputFile The stream holding the template.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if it could not be read or is invalid.
+ */
+ccdoc_template *readTemplate(FILE *inputFile, const char *name) {
+    size_t size = 0;
+    size_t capacity = 4096;
+    char *text = malloc(capacity);
+    while (text != NULL) {
+        size += fread(text + size, 1, capacity - size, inputFile);
+        if (size < capacity) {
+            break;
+        }
+        capacity *= 2;
+        char *grown = realloc(text, capacity);
+        if (grown == NULL) {
+            free(text);
+        }
+        text = grown;
+    }
+    if (text == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for template %s\n", name);
+        return NULL;
+    }
+    if (ferror(inputFile)) {
+        fprintf(stderr, "Error: Unable to read template %s\n", name);
+        free(text);
+        return NULL;
+    }
+    ccdoc_template *outputTemplate = compileTemplate(text, size, name);
+    free(text);
+    return outputTemplate;
+}
+
+/**
+ * Releases a compiled template.
+ * @param outputTemplate The template to destroy, may be NULL.
+ */
+void destroyTemplate(ccdoc_template *outputTemplate) {
+    if (outputTemplate == NULL) {
+        return;
+    }
+    free(outputTemplate->ops);
+    free(outputTemplate->text);
+    free(outputTemplate);
+}
+
+/**
+ * Returns the value of a field.
+ * @param values Values of the fields.
+ * @param field The field.
+ * @param param Index of the current parameter, or -1 outside the parameter loop.
+ * @return The value, an empty string if the field is not set.
+ */
+static const char *fieldValue(const TemplateValues *values, TemplateField field, int param) {
+    if (values == NULL) {
+        return "";
+    }
+    const DocComment *comment = values->comment;
+    switch (field) {
+        case FIELD_PARAMS: return comment != NULL && comment->paramCount > 0 ? "1" : "";
+        case FIELD_PARAM_NAME: return comment->paramName[param];
+        case FIELD_PARAM_DESC: return comment->paramDesc[param];
+        case FIELD_LAST: return param == comment->paramCount - 1 ? "1" : "";
+        default: return values->fields[field] != NULL ? values->fields[field] : "";
+    }
+}
+
+/**
+ * Writes one section of a template.
+ * @param outputTemplate The compiled template.
+ * @param section The section to write.
+ * @param values Values of the fields, may be NULL for sections that use no fields.
+ * @param outputFile The file where the section is written.
+ */
+void renderTemplateSection(const ccdoc_template *outputTemplate, TemplateSection section, const TemplateValues *values, FILE *outputFile) {
+    const TemplateOp *ops = outputTemplate->ops;
+    int paramCount = values != NULL && values->comment != NULL ? values->comment->paramCount : 0;
+    int param = -1;
+    int i = outputTemplate->sectionStart[section];
+    int end = outputTemplate->sectionEnd[section];
+
+    while (i < end) {
+        const TemplateOp *op = &ops[i];
+        switch (op->opcode) {
+            case OP_TEXT:
+                fwrite(outputTemplate->text + op->offset, 1, op->length, outputFile);
+                i++;
+                break;
+            case OP_FIELD:
+                writeLaTeXString(outputFile, fieldValue(values, op->field, param));
+                i++;
+                break;
+            case OP_RAW_FIELD:
+                fputs(fieldValue(values, op->field, param), outputFile);
+                i++;
+                break;
+            case OP_IF:
+                i = fieldValue(values, op->field, param)[0] != '\0' ? i + 1 : op->jump;
+                break;
+            case OP_IF_NOT:
+                i = fieldValue(values, op->field, param)[0] == '\0' ? i + 1 : op->jump;
+                break;
+            case OP_LOOP:
+                if (paramCount > 0) {
+                    param = 0;
+                    i++;
+                } else {
+                    i = op->jump;
+                }
+                break;
+            case OP_LOOP_END:
+                if (++param < paramCount) {
+                    i = op->jump;
+                } else {
+                    param = -1;
+                    i++;
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * Module output_template.h
+ * This module contains function prototypes for user-supplied output templates. A template is
+ * compiled once into a list of operations, which is then run for every documented function
+ * without looking at the template text again.
+ *
+ * A template consists of four sections, each started by a marker on its own line:
+ * {{@begin}} (written once at the start), {{@module}} (before the functions of every module),
+ * {{@function}} (for every function) and {{@end}} (written once at the end). Inside them:
+ *   {{field}}              the value of a field, with LaTeX special characters escaped
+ *   {{&field}}             the value of a field as it is
+ *   {{?field}}...{{/field}} the enclosed part if the field is not empty
+ *   {{^field}}...{{/field}} the enclosed part if the field is empty
+ *   {{#params}}...{{/params}} the enclosed part once for every documented parameter
+ *   {{! comment }}         nothing
+ * The fields are module, prototype, name, returnType, brief, details, description, author,
+ * version, return and params; inside the parameter loop also paramName, paramDesc and last,
+ * which is set for the last parameter. In a run of braces the tag starts at the last two, and
+ * braces around anything but a name, like "{{\bf x}}", are copied as text.
+ */
+
+#ifndef OUTPUT_TEMPLATE_H
+#define OUTPUT_TEMPLATE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "data_structures.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @enum TemplateSection
+ * @brief Part of the document a template section produces.
+ */
+typedef enum {
+    TEMPLATE_BEGIN,                   /* Start of the document. */
+    TEMPLATE_MODULE,                  /* Heading of a module. */
+    TEMPLATE_FUNCTION,                /* Documentation of one function. */
+    TEMPLATE_END,                     /* End of the document. */
+    TEMPLATE_SECTION_COUNT            /* Number of sections. */
+} TemplateSection;
+
+/**
+ * @enum TemplateField
+ * @brief Value a template can refer to.
+ */
+typedef enum {
+    FIELD_MODULE,                     /* Module name as shown in the document. */
+    FIELD_PROTOTYPE,                  /* Return type and declarator of the function. */
+    FIELD_NAME,                       /* Identifier of the function. */
+    FIELD_RETURN_TYPE,                /* Return type of the function. */
+    FIELD_BRIEF,                      /* Brief description. */
+    FIELD_DETAILS,                    /* Detailed description. */
+    FIELD_DESCRIPTION,                /* Free text of the comment. */
+    FIELD_AUTHOR,                     /* Author. */
+    FIELD_VERSION,                    /* Version. */
+    FIELD_RETURN,                     /* Description of the return value. */
+    FIELD_PARAMS,                     /* Set if the function has documented parameters. */
+    FIELD_PARAM_NAME,                 /* Name of the current parameter. */
+    FIELD_PARAM_DESC,                 /* Description of the current parameter. */
+    FIELD_LAST,                       /* Set for the last parameter. */
+    TEMPLATE_FIELD_COUNT              /* Number of fields. */
+} TemplateField;
+
+/**
+ * @struct TemplateValues
+ * @brief Values of the fields for one rendering of a section.
+ */
+typedef struct {
+    const char *fields[FIELD_PARAMS]; /* Text of the fields before FIELD_PARAMS, never NULL. */
+    const DocComment *comment;        /* Comment holding the parameters, NULL if there are none. */
+} TemplateValues;
+
+/**
+ * @struct ccdoc_template
+ * @brief Opaque compiled template. It is never changed after compilation, so it can be shared
+ * by contexts on several threads.
+ */
+typedef struct ccdoc_template ccdoc_template;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Compiles a template.
+ * @param text The template text, not necessarily null-terminated.
+ * @param size The number of bytes in text.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if the template is invalid.
+ */
+ccdoc_template *compileTemplate(const char *text, size_t size, const char *name);
+
+/**
+ * Reads a template from a stream and compiles it.
+ * @param inputFile The stream holding the template.
+ * @param name Name of the template, used in error messages.
+ * @return Pointer to the compiled template, or NULL if it could not be read or is invalid.
+ */
+ccdoc_template *readTemplate(FILE *inputFile, const char *name);
+
+/**
+ * Releases a compiled template.
+ * @param outputTemplate The template to destroy, may be NULL.
+ */
+void destroyTemplate(ccdoc_template *outputTemplate);
+
+/**
+ * Writes one section of a template.
+ * @param outputTemplate The compiled template.
+ * @param section The section to write.
+ * @param values Values of the fields, may be NULL for sections that use no fields.
+ * @param outputFile The file where the section is written.
+ */
+void renderTemplateSection(const ccdoc_template *outputTemplate, TemplateSection section, const TemplateValues *values, FILE *outputFile);
+
+#endif
@@ -0,0 +1,353 @@
+/**
+ * Module param_check.c
+ * This module implements the parameter checks declared in param_check.h.
+ * The prototype's parameter names of one function are put in a small open-addressing table
+ * and the documented ones are marked in a bitset, so a function is checked in time linear in
+ * its number of parameters.
+ */
+
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "param_check.h"
+#include "parse_cache.h"
+#include "utility.h"
+
+/* Maximal number of parameters of one function that are checked. */
+#define MAX_CHECKED_PARAMS 32
+
+/* Number of slots of the name table, a power of two larger than MAX_CHECKED_PARAMS. */
+#define NAME_TABLE_SIZE 64
+
+/* Words that are part of a type and never the name of a parameter. */
+static const char *const TYPE_WORDS[] = {
+    "void", "char", "short", "int", "long", "float", "double", "signed", "unsigned", "const",
+    "volatile", "restrict", "register", "struct", "union", "enum", "bool", "_Bool"
+};
+
+/**
+ * @struct ParamTable
+ * @brief Parameter names of one prototype, with the ones already documented.
+ */
+typedef struct {
+    char names[MAX_CHECKED_PARAMS][64];   /* Names in prototype order. */
+    int count;                            /* Count of names. */
+    signed char slots[NAME_TABLE_SIZE];   /* Indices into names, -1 for an empty slot. */
+    uint32_t documented;                  /* Bit i is set once names[i] has an @param entry. */
+} ParamTable;
+
+/**
+ * Checks if a word belongs to a type.
+ * @param word The word, not necessarily null-terminated.
+ * @param length Length of the word.
+ * @return true if the word is a type keyword, false otherwise.
+ */
+static bool isTypeWord(const char *word, size_t length) {
+    for (size_t i = 0; i < sizeof(TYPE_WORDS) / sizeof(TYPE_WORDS[0]); i++) {
+        if (strlen(TYPE_WORDS[i]) == length && strncmp(TYPE_WORDS[i], word, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks if a word introduces a structure, union or enumeration tag.
+ * @param word The word, not necessarily null-terminated.
+ * @param length Length of the word.
+ * @return true for "struct", "union" and "enum", false otherwise.
+ */
+static bool isTagKeyword(const char *word, size_t length) {
+    return (length == 6 && strncmp(word, "struct", 6) == 0) ||
+           (length == 5 && strncmp(word, "union", 5) == 0) ||
+           (length == 4 && strncmp(word, "enum", 4) == 0);
+}
+
+/**
+ * Checks if a word is a type qualifier, which cannot be the whole type of a parameter.
+ * @param word The word, not necessarily null-terminated.
+ * @param length Length of the word.
+ * @return true for "const", "volatile" and "restrict", false otherwise.
+ */
+static bool isQualifier(const char *word, size_t length) {
+    return (length == 5 && strncmp(word, "const", 5) == 0) ||
+           (length == 8 && strncmp(word, "volatile", 8) == 0) ||
+           (length == 8 && strncmp(word, "restrict", 8) == 0);
+}
+
+/**
+ * Checks if a character can be part of an identifier.
+ * @param c The character.
+ * @return true for letters, digits and underscores.
+ */
+static bool isIdentifierChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * Copies the first identifier of a text.
+ * @param text The text; characters before the identifier, such as '*', are skipped.
+ * @param identifier Buffer of 64 characters receiving the identifier, empty if there is none.
+ */
+static void copyIdentifier(const char *text, char *identifier) {
+    size_t length = 0;
+    while (*text && !isIdentifierChar(*text)) {
+        text++;
+    }
+    while (isIdentifierChar(text[length]) && length < 63) {
+        length++;
+    }
+    memcpy(identifier, text, length);
+    identifier[length] = '\0';
+}
+
+/**
+ * Copies the last identifier of a text.
+ * @param text The text, e.g. "char *name" or "argv[]".
+ * @param identifier Buffer of 64 characters receiving the identifier, empty if there is none.
+ */
+static void copyLastIdentifier(const char *text, char *identifier) {
+    const char *last = "";
+    for (const char *p = text; *p; ) {
+        if (isIdentifierChar(*p) && !isdigit((unsigned char)*p)) {
+            last = p;
+            while (isIdentifierChar(*p)) {
+                p++;
+            }
+        } else {
+            p++;
+        }
+    }
+    copyIdentifier(last, identifier);
+}
+
+/**
+ * Finds the name of one parameter declaration.
+ * @param start Start of the declaration.
+ * @param end End of the declaration.
+ * @param name Buffer of 64 characters receiving the name.
+ * @return true if the parameter is named, false otherwise.
+ */
+static bool parameterName(const char *start, const char *end, char *name) {
+    const char *last = NULL;
+    const char *previous = NULL;
+    size_t lastLength = 0;
+    size_t previousLength = 0;
+    int words = 0;
+    int depth = 0;
+    bool qualifiersOnly = true;       /* All words before the last one are qualifiers. */
+    bool pointerBefore = false;       /* A '*' comes before the last word. */
+    bool pointerAfter = false;        /* A '*' follows the last word. */
+
+    for (const char *p = start; p < end; ) {
+        if (*p == '(') {
+            /* A function pointer is named inside its first parentheses */
+            const char *q = p + 1;
+            while (q < end && (isspace((unsigned char)*q) || *q == '*')) {
+                q++;
+            }
+            if (depth == 0 && q > p + 1 && q[-1] == '*') {
+                size_t length = 0;
+                while (q + length < end && isIdentifierChar(q[length]) && length < 63) {
+                    length++;
+                }
+                memcpy(name, q, length);
+                name[length] = '\0';
+                return length > 0;
+            }
+            depth++;
+            p++;
+        } else if (*p == '[') {
+            depth++;
+            p++;
+        } else if (*p == ')' || *p == ']') {
+            depth -= depth > 0;
+            p++;
+        } else if (depth == 0 && (isalpha((unsigned char)*p) || *p == '_')) {
+            const char *word = p;
+            while (p < end && isIdentifierChar(*p)) {
+                p++;
+            }
+            if (last != NULL) {
+                qualifiersOnly = qualifiersOnly && isQualifier(last, lastLength);
+                pointerBefore = pointerBefore || pointerAfter;
+            }
+            pointerAfter = false;
+            previous = last;
+            previousLength = lastLength;
+            last = word;
+            lastLength = (size_t)(p - word);
+            words++;
+        } else {
+            pointerAfter = pointerAfter || (depth == 0 && *p == '*');
+            p++;
+        }
+    }
+
+    /* The name is the last word, unless the declaration is only a type such as "struct tag",
+       "const Type" or "const Type *", whose last word names a typedef */
+    if (words < 2 || lastLength > 63 || isTypeWord(last, lastLength) || isTagKeyword(previous, previousLength) ||
+        pointerAfter || (qualifiersOnly && !pointerBefore)) {
+        return false;
+    }
+    memcpy(name, last, lastLength);
+    name[lastLength] = '\0';
+    return true;
+}
+
+/**
+ * Extracts the names of the parameters from a function declarator.
+ * @param declarator The declarator, e.g. "add(int a, int b);"; the list ends at its closing parenthesis.
+ * @param names Buffer receiving the names separated by single spaces.
+ * @param size Size of the buffer.
+ * @return The number of extracted names, or -1 if the declarator has no parameter list.
+ */
+int extractParameterNames(const char *declarator, char *names, size_t size) {
+    const char *p = strchr(declarator, '(');
+    size_t length = 0;
+    int count = 0;
+
+    names[0] = '\0';
+    if (p == NULL) {
+        return -1;
+    }
+    p++;
+    while (*p && *p != ')') {
+        /* A declaration ends at a comma or parenthesis outside nested parentheses and brackets */
+        const char *start = p;
+        int depth = 0;
+        while (*p && !(depth == 0 && (*p == ',' || *p == ')'))) {
+            if (*p == '(' || *p == '[') {
+                depth++;
+            } else if ((*p == ')' || *p == ']') && depth > 0) {
+                depth--;
+            }
+            p++;
+        }
+
+        char name[64];
+        if (parameterName(start, p, name) && length + strlen(name) + 2 <= size) {
+            length += snprintf(names + length, size - length, "%s%s", count > 0 ? " " : "", name);
+            count++;
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Finds a name in the table of a prototype.
+ * @param table The table.
+ * @param name The name.
+ * @return Index of the parameter, or -1 if the prototype has no parameter of that name.
+ */
+static int findParam(const ParamTable *table, const char *name) {
+    if (name[0] == '\0') {
+        return -1;
+    }
+    size_t slot = (size_t)hashContent(name, strlen(name)) & (NAME_TABLE_SIZE - 1);
+    while (table->slots[slot] >= 0) {
+        if (strcmp(table->names[table->slots[slot]], name) == 0) {
+            return table->slots[slot];
+        }
+        slot = (slot + 1) & (NAME_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+/**
+ * Fills the table of a prototype from the stored parameter names.
+ * @param table The table to fill.
+ * @param paramNames The names separated by single spaces.
+ */
+static void buildParamTable(ParamTable *table, const char *paramNames) {
+    memset(table->slots, -1, sizeof(table->slots));
+    table->count = 0;
+    table->documented = 0;
+    for (const char *p = paramNames; *p && table->count < MAX_CHECKED_PARAMS; ) {
+        copyIdentifier(p, table->names[table->count]);
+        p += strlen(table->names[table->count]);
+        while (*p == ' ') {
+            p++;
+        }
+        /* A repeated name keeps its first position */
+        if (table->names[table->count][0] == '\0' || findParam(table, table->names[table->count]) >= 0) {
+            continue;
+        }
+        size_t slot = (size_t)hashContent(table->names[table->count], strlen(table->names[table->count])) & (NAME_TABLE_SIZE - 1);
+        while (table->slots[slot] >= 0) {
+            slot = (slot + 1) & (NAME_TABLE_SIZE - 1);
+        }
+        table->slots[slot] = (signed char)table->count;
+        table->count++;
+    }
+}
+
+/**
+ * Checks the documented parameters of a function against its prototype.
+ * @param funcDoc Documentation of the function.
+ * @param reportFile The file where the problems are reported.
+ * @return The number of reported problems.
+ */
+int checkFunctionParams(const FunctionDoc *funcDoc, FILE *reportFile) {
+    const DocComment *comment = &funcDoc->comment;
+    char identifier[256];
+    ParamTable table;
+    int problems = 0;
+    int lastIndex = -1;
+    bool misordered = false;
+
+    /* Declarations without a parameter list, such as structures, are not checked */
+    if (strchr(funcDoc->functionName, '(') == NULL) {
+        return 0;
+    }
+    functionIdentifier(funcDoc->functionName, identifier, sizeof(identifier));
+    buildParamTable(&table, funcDoc->paramNames);
+
+    for (int i = 0; i < comment->paramTagCount; i++) {
+        /* The entry is stored as its first two words; the second is only the name after a type */
+        char first[64];
+        char second[64];
+        const char *space = strchr(comment->paramTags[i], ' ');
+        copyIdentifier(comment->paramTags[i], first);
+        copyLastIdentifier(space ? space + 1 : "", second);
+        bool typed = isTypeWord(first, strlen(first)) || (space != NULL && strpbrk(space, "*[") != NULL);
+
+        int index = findParam(&table, first);
+        if (index < 0 && typed) {
+            index = findParam(&table, second);
+        }
+        if (index < 0) {
+            fprintf(reportFile, "Error: %s: @param %s of %s does not name a parameter\n",
+                    funcDoc->moduleName, typed && second[0] ? second : first, identifier);
+            problems++;
+            continue;
+        }
+        if (table.documented & (UINT32_C(1) << index)) {
+            fprintf(reportFile, "Error: %s: @param %s of %s is documented more than once\n",
+                    funcDoc->moduleName, table.names[index], identifier);
+            problems++;
+            continue;
+        }
+        table.documented |= UINT32_C(1) << index;
+        misordered = misordered || index < lastIndex;
+        lastIndex = index;
+    }
+
+    for (int i = 0; i < table.count; i++) {
+        if (!(table.documented & (UINT32_C(1) << i))) {
+            fprintf(reportFile, "Error: %s: parameter %s of %s is not documented\n",
+                    funcDoc->moduleName, table.names[i], identifier);
+            problems++;
+        }
+    }
+    if (misordered) {
+        fprintf(reportFile, "Error: %s: @param entries of %s are not in prototype order (%s)\n",
+                funcDoc->moduleName, identifier, funcDoc->paramNames);
+        problems++;
+    }
+    return problems;
+}
@@ -0,0 +1,44 @@
+/**
+ * Module param_check.h
+ * This module contains function prototypes for checking the documented parameters of functions
+ * against their prototypes. The parameter names are extracted when the prototype is parsed,
+ * so the check needs no second pass over the sources.
+ */
+
+#ifndef PARAM_CHECK_H
+#define PARAM_CHECK_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "data_structures.h"
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Extracts the names of the parameters from a function declarator.
+ * Unnamed parameters, "void" and "..." are left out; the name of a function pointer parameter
+ * is taken from its "(*name)" part.
+ * @param declarator The declarator, e.g. "add(int a, int b);"; the list ends at its closing parenthesis.
+ * @param names Buffer receiving the names separated by single spaces.
+ * @param size Size of the buffer.
+ * @return The number of extracted names, or -1 if the declarator has no parameter list.
+ */
+int extractParameterNames(const char *declarator, char *names, size_t size);
+
+/**
+ * Checks the documented parameters of a function against its prototype and reports parameters
+ * that are not documented, @param entries that name no parameter and entries in a different
+ * order than the prototype.
+ * An @param entry names a parameter either by its first word ("@param count Number of items")
+ * or by its second word after a type ("@param int count Number of items").
+ * @param funcDoc Documentation of the function.
+ * @param reportFile The file where the problems are reported.
+ * @return The number of reported problems.
+ */
+int checkFunctionParams(const FunctionDoc *funcDoc, FILE *reportFile);
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * Module parse_cache.c
+ * This module implements parse results and the shared cache declared in parse_cache.h.
+ * Files are keyed by canonical path together with a hash and the size of their content,
+ * so a file changed between two lookups is parsed again. Cached results are never modified,
+ * so contexts may read them without holding the lock. A file being parsed has an entry marked
+ * as such, and threads looking it up wait until its result is stored instead of parsing it too.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "parse_cache.h"
+
+/* Number of hash buckets of the cache, a power of two. */
+#define CACHE_BUCKETS 1024
+
+/**
+ * @struct CacheEntry
+ * @brief Parse result of one file version, chained in a hash bucket.
+ */
+typedef struct CacheEntry {
+    char *path;                       /* Canonical path of the file. */
+    uint64_t contentHash;             /* Hash of the content of the file. */
+    size_t size;                      /* Size of the content of the file. */
+    ParsedFile parsed;                /* Parse result. */
+    bool parsing;                     /* The file is being parsed and has no result yet. */
+    struct CacheEntry *next;          /* Next entry in the same bucket. */
+} CacheEntry;
+
+/**
+ * @struct ccdoc_cache
+ * @brief Hash table of parse results protected by a mutex.
+ */
+struct ccdoc_cache {
+    CacheEntry *buckets[CACHE_BUCKETS];  /* Chains of entries. */
+    pthread_mutex_t lock;                /* Protects the buckets and the statistics. */
+    pthread_cond_t stored;               /* Signaled when a file being parsed is stored or abandoned. */
+    long hits;                           /* Lookups answered from the cache. */
+    long misses;                         /* Lookups of files not in the cache. */
+};
+
+/**
+ * Grows an array so that it can hold at least one more element.
+ * @param array Pointer to the array pointer.
+ * @param capacity Pointer to the allocated number of elements.
+ * @param count Number of elements in use.
+ * @param elementSize Size of one element.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool reserveElement(void **array, int *capacity, int count, size_t elementSize) {
+    if (count < *capacity) {
+        return true;
+    }
+    int grown = *capacity ? *capacity * 2 : 8;
+    void *resized = realloc(*array, grown * elementSize);
+    if (resized == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for parse results\n");
+        return false;
+    }
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+/**
+ * Initializes an empty parse result.
+ * @param parsed The parse result to initialize.
+ */
+void initParsedFile(ParsedFile *parsed) {
+    memset(parsed, 0, sizeof(ParsedFile));
+}
+
+/**
+ * Releases the arrays of a parse result and leaves it empty.
+ * @param parsed The parse result to release.
+ */
+void freeParsedFile(ParsedFile *parsed) {
+    free(parsed->items);
+    free(parsed->includes);
+    free(parsed->functions);
+    initParsedFile(parsed);
+}
+
+/**
+ * Appends an include directive to a parse result.
+ * @param parsed The parse result.
+ * @param filename Name of the included file.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool appendParsedInclude(ParsedFile *parsed, const char *filename) {
+    if (!reserveElement((void **)&parsed->includes, &parsed->includeCapacity, parsed->includeCount, sizeof(parsed->includes[0])) ||
+        !reserveElement((void **)&parsed->items, &parsed->itemCapacity, parsed->itemCount, sizeof(ParsedItem))) {
+        return false;
+    }
+    snprintf(parsed->includes[parsed->includeCount], sizeof(parsed->includes[0]), "%s", filename);
+    parsed->items[parsed->itemCount].kind = PARSED_INCLUDE;
+    parsed->items[parsed->itemCount++].index = parsed->includeCount++;
+    return true;
+}
+
+/**
+ * Appends a documented function to a parse result.
+ * @param parsed The parse result.
+ * @param funcDoc Documentation of the function.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool appendParsedFunction(ParsedFile *parsed, const FunctionDoc *funcDoc) {
+    if (!reserveElement((void **)&parsed->functions, &parsed->functionCapacity, parsed->functionCount, sizeof(FunctionDoc)) ||
+        !reserveElement((void **)&parsed->items, &parsed->itemCapacity, parsed->itemCount, sizeof(ParsedItem))) {
+        return false;
+    }
+    parsed->functions[parsed->functionCount] = *funcDoc;
+    parsed->items[parsed->itemCount].kind = PARSED_FUNCTION;
+    parsed->items[parsed->itemCount++].index = parsed->functionCount++;
+    return true;
+}
+
+/**
+ * Computes the 64-bit FNV-1a hash of a file's content.
+ * @param data The content.
+ * @param size The number of bytes in data.
+ * @return The hash.
+ */
+uint64_t hashContent(const char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Selects the bucket of a file version.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @return Index of the bucket.
+ */
+static unsigned bucketOf(const char *path, uint64_t contentHash) {
+    uint64_t hash = contentHash;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ull;
+    }
+    return (unsigned)(hash & (CACHE_BUCKETS - 1));
+}
+
+/**
+ * Finds an entry in its bucket; the caller must hold the lock.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @return The entry, or NULL if there is none.
+ */
+static CacheEntry *findEntry(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size) {
+    for (CacheEntry *entry = cache->buckets[bucketOf(path, contentHash)]; entry; entry = entry->next) {
+        if (entry->contentHash == contentHash && entry->size == size && strcmp(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Creates an empty cache.
+ * @return Pointer to the cache, or NULL if memory could not be allocated.
+ */
+ccdoc_cache *createParseCache(void) {
+    ccdoc_cache *cache = calloc(1, sizeof(ccdoc_cache));
+    if (cache == NULL) {
+        fprintf(stderr, "Error: Unable to allocate parse cache\n");
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    pthread_cond_init(&cache->stored, NULL);
+    return cache;
+}
+
+/**
+ * Releases a cache and all parse results it holds.
+ * @param cache The cache to destroy, may be NULL.
+ */
+void destroyParseCache(ccdoc_cache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    for (int i = 0; i < CACHE_BUCKETS; i++) {
+        CacheEntry *entry = cache->buckets[i];
+        while (entry != NULL) {
+            CacheEntry *next = entry->next;
+            freeParsedFile(&entry->parsed);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+    }
+    pthread_cond_destroy(&cache->stored);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+/**
+ * Inserts an entry for a file version into its bucket; the caller must hold the lock.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @return The empty entry, or NULL if memory could not be allocated.
+ */
+static CacheEntry *insertEntry(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size) {
+    CacheEntry *entry = calloc(1, sizeof(CacheEntry));
+    char *pathCopy = malloc(strlen(path) + 1);
+    if (entry == NULL || pathCopy == NULL) {
+        free(entry);
+        free(pathCopy);
+        return NULL;
+    }
+    strcpy(pathCopy, path);
+    entry->path = pathCopy;
+    entry->contentHash = contentHash;
+    entry->size = size;
+
+    unsigned bucket = bucketOf(path, contentHash);
+    entry->next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    return entry;
+}
+
+/**
+ * Looks up the parse result of a file.
+ * If another thread is parsing the file, the call waits until that thread stores the result.
+ * If the file has not been parsed, it is marked as being parsed by the caller, who must then
+ * call storeParsedFile or abandonParsedFile.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @return The cached parse result, or NULL if the caller has to parse the file.
+ */
+const ParsedFile *findParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size) {
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry *entry;
+    while ((entry = findEntry(cache, path, contentHash, size)) != NULL && entry->parsing) {
+        pthread_cond_wait(&cache->stored, &cache->lock);
+    }
+    if (entry != NULL) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+        /* Without memory for the mark, other threads parse the file too and the first stored result wins */
+        CacheEntry *marker = insertEntry(cache, path, contentHash, size);
+        if (marker != NULL) {
+            marker->parsing = true;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return entry ? &entry->parsed : NULL;
+}
+
+/**
+ * Stores the parse result of a file, taking ownership of its arrays, and wakes the threads
+ * waiting for it. If another thread stored the same file in the meantime, the new result is
+ * released and the stored one is returned.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @param parsed The parse result; it is left empty after the call.
+ * @return The cached parse result, or NULL if memory could not be allocated.
+ */
+const ParsedFile *storeParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size, ParsedFile *parsed) {
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry *entry = findEntry(cache, path, contentHash, size);
+    bool inserted = entry == NULL;
+    if (inserted) {
+        entry = insertEntry(cache, path, contentHash, size);
+    }
+    if (entry != NULL && (inserted || entry->parsing)) {
+        entry->parsed = *parsed;
+        entry->parsing = false;
+        initParsedFile(parsed);
+        pthread_cond_broadcast(&cache->stored);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    freeParsedFile(parsed);
+    return entry ? &entry->parsed : NULL;
+}
+
+/**
+ * Removes the mark of a file the caller was parsing without storing a result, and wakes the
+ * threads waiting for it, so one of them parses the file itself.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ */
+void abandonParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size) {
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry **link = &cache->buckets[bucketOf(path, contentHash)];
+    while (*link != NULL) {
+        CacheEntry *entry = *link;
+        if (entry->parsing && entry->contentHash == contentHash && entry->size == size && strcmp(entry->path, path) == 0) {
+            *link = entry->next;
+            free(entry->path);
+            free(entry);
+            pthread_cond_broadcast(&cache->stored);
+            break;
+        }
+        link = &entry->next;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Reads the number of lookups answered from the cache and the number of files parsed.
+ * @param cache The cache.
+ * @param hits Pointer to the variable receiving the number of lookups answered from the cache.
+ * @param misses Pointer to the variable receiving the number of files that had to be parsed.
+ */
+void parseCacheStatistics(ccdoc_cache *cache, long *hits, long *misses) {
+    pthread_mutex_lock(&cache->lock);
+    *hits = cache->hits;
+    *misses = cache->misses;
+    pthread_mutex_unlock(&cache->lock);
+}
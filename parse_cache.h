@@ -0,0 +1,161 @@
+/**
+ * Module parse_cache.h
+ * This module contains the result of parsing one file and the cache that shares these results
+ * between contexts, so a file used by many documentation targets is parsed only once.
+ */
+
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include "data_structures.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @enum ParsedItemKind
+ * @brief Kind of an entry found while parsing a file.
+ */
+typedef enum {
+    PARSED_INCLUDE,                   /* A quoted #include directive. */
+    PARSED_FUNCTION                   /* A documented function. */
+} ParsedItemKind;
+
+/**
+ * @struct ParsedItem
+ * @brief Refers to one include or function, in the order they appear in the file.
+ */
+typedef struct {
+    ParsedItemKind kind;              /* Kind of the entry. */
+    int index;                        /* Index into the includes or the functions array. */
+} ParsedItem;
+
+/**
+ * @struct ParsedFile
+ * @brief Everything the parser found in one file, independent of the name it was opened under.
+ * The module name and file type of the functions are filled in when the file is added to a context.
+ */
+typedef struct {
+    ParsedItem *items;                /* Includes and functions in file order. */
+    int itemCount;                    /* Count of items. */
+    int itemCapacity;                 /* Allocated size of the items array. */
+    char (*includes)[256];            /* Names of the included files. */
+    int includeCount;                 /* Count of included files. */
+    int includeCapacity;              /* Allocated size of the includes array. */
+    FunctionDoc *functions;           /* Documented functions. */
+    int functionCount;                /* Count of documented functions. */
+    int functionCapacity;             /* Allocated size of the functions array. */
+    bool invalidCommentFormat;        /* Indicates if an invalid comment format was found. */
+} ParsedFile;
+
+/**
+ * @struct ccdoc_cache
+ * @brief Opaque, thread-safe cache of parsed files shared by several contexts.
+ */
+typedef struct ccdoc_cache ccdoc_cache;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Initializes an empty parse result.
+ * @param parsed The parse result to initialize.
+ */
+void initParsedFile(ParsedFile *parsed);
+
+/**
+ * Releases the arrays of a parse result.
+ * @param parsed The parse result to release.
+ */
+void freeParsedFile(ParsedFile *parsed);
+
+/**
+ * Appends an include directive to a parse result.
+ * @param parsed The parse result.
+ * @param filename Name of the included file.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool appendParsedInclude(ParsedFile *parsed, const char *filename);
+
+/**
+ * Appends a documented function to a parse result.
+ * @param parsed The parse result.
+ * @param funcDoc Documentation of the function.
+ * @return true on success, false if memory could not be allocated.
+ */
+bool appendParsedFunction(ParsedFile *parsed, const FunctionDoc *funcDoc);
+
+/**
+ * Computes the 64-bit FNV-1a hash of a file's content.
+ * @param data The content.
+ * @param size The number of bytes in data.
+ * @return The hash.
+ */
+uint64_t hashContent(const char *data, size_t size);
+
+/**
+ * Creates an empty cache.
+ * @return Pointer to the cache, or NULL if memory could not be allocated.
+ */
+ccdoc_cache *createParseCache(void);
+
+/**
+ * Releases a cache and all parse results it holds.
+ * @param cache The cache to destroy, may be NULL.
+ */
+void destroyParseCache(ccdoc_cache *cache);
+
+/**
+ * Looks up the parse result of a file.
+ * If another thread is parsing the file, the call waits until that thread stores the result.
+ * If the file has not been parsed, it is marked as being parsed by the caller, who must then
+ * call storeParsedFile or abandonParsedFile.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @return The cached parse result, or NULL if the caller has to parse the file.
+ */
+const ParsedFile *findParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size);
+
+/**
+ * Stores the parse result of a file, taking ownership of its arrays, and wakes the threads
+ * waiting for it. If another thread stored the same file in the meantime, the new result is
+ * released and the stored one is returned.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ * @param parsed The parse result; it is left empty after the call.
+ * @return The cached parse result, or NULL if memory could not be allocated.
+ */
+const ParsedFile *storeParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size, ParsedFile *parsed);
+
+/**
+ * Removes the mark of a file the caller was parsing without storing a result, and wakes the
+ * threads waiting for it, so one of them parses the file itself.
+ * @param cache The cache.
+ * @param path Canonical path of the file.
+ * @param contentHash Hash of the content of the file.
+ * @param size Size of the content of the file.
+ */
+void abandonParsedFile(ccdoc_cache *cache, const char *path, uint64_t contentHash, size_t size);
+
+/**
+ * Reads the number of lookups answered from the cache and the number of files parsed.
+ * @param cache The cache.
+ * @param hits Pointer to the variable receiving the number of lookups answered from the cache.
+ * @param misses Pointer to the variable receiving the number of files that had to be parsed.
+ */
+void parseCacheStatistics(ccdoc_cache *cache, long *hits, long *misses);
+
+#endif 
@@ -0,0 +1,251 @@
+/**
+ * Module prefetch.c
+ * This module implements the background reader declared in prefetch.h.
+ * On POSIX systems the kernel is asked with posix_fadvise (or F_RDADVISE on macOS) to load each
+ * file in the background, and the thread follows the includes of a mapping of the file. Elsewhere
+ * the thread does nothing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "prefetch.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct Prefetcher {
+    pthread_t thread;                 /* The background thread. */
+    pthread_mutex_t lock;             /* Protects the files and the stop request. */
+    pthread_cond_t queued;            /* Signaled when a file is queued or the thread is asked to stop. */
+    char (*files)[256];               /* Every file queued so far; the ones from next on are not read yet. */
+    int count;                        /* Count of queued files. */
+    int capacity;                     /* Allocated count of files. */
+    int next;                         /* Index of the next file to read. */
+    bool stopping;                    /* The thread is asked to stop. */
+    size_t maxFileBytes;              /* Bytes of a file that are looked through, 0 for the whole file. */
+};
+
+/**
+ * Queues a file unless it was queued before; the caller must hold the lock.
+ * @param prefetcher The prefetcher.
+ * @param filename The name of the file.
+ */
+static void queueLocked(Prefetcher *prefetcher, const char *filename) {
+    for (int i = 0; i < prefetcher->count; i++) {
+        if (strcmp(prefetcher->files[i], filename) == 0) {
+            return;
+        }
+    }
+    if (prefetcher->count == prefetcher->capacity) {
+        int capacity = prefetcher->capacity ? prefetcher->capacity * 2 : 64;
+        char (*grown)[256] = realloc(prefetcher->files, (size_t)capacity * sizeof(prefetcher->files[0]));
+        if (grown == NULL) {
+            return;
+        }
+        prefetcher->files = grown;
+        prefetcher->capacity = capacity;
+    }
+    snprintf(prefetcher->files[prefetcher->count++], sizeof(prefetcher->files[0]), "%s", filename);
+    pthread_cond_signal(&prefetcher->queued);
+}
+
+/**
+ * Queues the files named by the quoted #include lines of a file's content.
+ * As in the parser, an include is a line starting with "#include"; conditionals are not
+ * evaluated, so the includes of disabled regions are read ahead as well.
+ * @param prefetcher The prefetcher.
+ * @param data The content of the file.
+ * @param size Number of bytes in data.
+ */
+static void queueIncludes(Prefetcher *prefetcher, const char *data, size_t size) {
+    const char *end = data + size;
+    for (const char *p = data; p < end; ) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        const char *next = newline != NULL ? newline + 1 : end;
+        if (next - p > 8 && memcmp(p, "#include", 8) == 0) {
+            const char *name = p + 8;
+            while (name < next && (*name == ' ' || *name == '\t')) {
+                name++;
+            }
+            const char *quote = name < next && *name == '"' ? memchr(name + 1, '"', (size_t)(next - name - 1)) : NULL;
+            if (quote != NULL && quote - name - 1 > 0 && quote - name - 1 < 256) {
+                char includedFileName[256];
+                memcpy(includedFileName, name + 1, (size_t)(quote - name - 1));
+                includedFileName[quote - name - 1] = '\0';
+                pthread_mutex_lock(&prefetcher->lock);
+                queueLocked(prefetcher, includedFileName);
+                pthread_mutex_unlock(&prefetcher->lock);
+            }
+        }
+        p = next;
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * Checks if every page of a mapped file is already in the page cache.
+ * @param data The mapping.
+ * @param size Size of the mapping.
+ * @return true if all pages are resident, false if one is not or the check is not possible.
+ */
+static bool fullyCached(void *data, size_t size) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t pages = pageSize > 0 ? (size + (size_t)pageSize - 1) / (size_t)pageSize : 0;
+    unsigned char *resident = pages > 0 ? malloc(pages) : NULL;
+    bool cached = resident != NULL && mincore(data, size, (void *)resident) == 0;
+    for (size_t i = 0; i < pages && cached; i++) {
+        cached = (resident[i] & 1) != 0;
+    }
+    free(resident);
+    return cached;
+}
+#endif
+
+/**
+ * Asks the operating system to load a file into the page cache and queues the files it includes.
+ * The hint covers the whole file and returns at once. The includes are then found in a mapping
+ * of the file, so its content is never copied into the process. A file that is already cached
+ * is not looked through: the parser gets to it without waiting and reports its includes itself.
+ * @param prefetcher The prefetcher.
+ * @param filename The name of the file.
+ */
+static void readAhead(Prefetcher *prefetcher, const char *filename) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return;
+    }
+    size_t size = (size_t)info.st_size;
+    if (prefetcher->maxFileBytes > 0 && size > prefetcher->maxFileBytes) {
+        size = prefetcher->maxFileBytes;
+    }
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return;
+    }
+    if (fullyCached(data, size)) {
+        munmap(data, size);
+        close(fd);
+        return;
+    }
+#if defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+    struct radvisory advice;
+    advice.ra_offset = 0;
+    advice.ra_count = info.st_size > 0x7FFFFFFF ? 0x7FFFFFFF : (int)info.st_size;
+    fcntl(fd, F_RDADVISE, &advice);
+#endif
+    close(fd);
+    queueIncludes(prefetcher, data, size);
+    munmap(data, size);
+#else
+    (void)prefetcher;
+    (void)filename;
+    return;
+#endif
+
+    /* The parser goes on with the source file of a header */
+    const char *dot = strrchr(filename, '.');
+    if (dot != NULL && strcmp(dot, ".h") == 0) {
+        char cFilename[256];
+        snprintf(cFilename, sizeof(cFilename), "%.*s.c", (int)(dot - filename), filename);
+        pthread_mutex_lock(&prefetcher->lock);
+        queueLocked(prefetcher, cFilename);
+        pthread_mutex_unlock(&prefetcher->lock);
+    }
+}
+
+/**
+ * Body of the background thread: reads queued files until it is asked to stop.
+ * @param argument Pointer to the prefetcher.
+ * @return Always NULL.
+ */
+static void *runPrefetcher(void *argument) {
+    Prefetcher *prefetcher = argument;
+    char filename[256];
+
+    pthread_mutex_lock(&prefetcher->lock);
+    for (;;) {
+        while (!prefetcher->stopping && prefetcher->next == prefetcher->count) {
+            pthread_cond_wait(&prefetcher->queued, &prefetcher->lock);
+        }
+        if (prefetcher->stopping) {
+            break;
+        }
+        memcpy(filename, prefetcher->files[prefetcher->next++], sizeof(filename));
+        pthread_mutex_unlock(&prefetcher->lock);
+        readAhead(prefetcher, filename);
+        pthread_mutex_lock(&prefetcher->lock);
+    }
+    pthread_mutex_unlock(&prefetcher->lock);
+    return NULL;
+}
+
+/**
+ * Starts the background thread reading input files ahead of the parser.
+ * @param maxFileBytes Bytes of a file that are looked through for includes, 0 for the whole file.
+ * @return The prefetcher, or NULL if the thread could not be started.
+ */
+Prefetcher *startPrefetcher(size_t maxFileBytes) {
+    Prefetcher *prefetcher = calloc(1, sizeof(Prefetcher));
+    if (prefetcher == NULL) {
+        return NULL;
+    }
+    prefetcher->maxFileBytes = maxFileBytes;
+    pthread_mutex_init(&prefetcher->lock, NULL);
+    pthread_cond_init(&prefetcher->queued, NULL);
+    if (pthread_create(&prefetcher->thread, NULL, runPrefetcher, prefetcher) != 0) {
+        pthread_cond_destroy(&prefetcher->queued);
+        pthread_mutex_destroy(&prefetcher->lock);
+        free(prefetcher);
+        return NULL;
+    }
+    return prefetcher;
+}
+
+/**
+ * Queues a file to be read ahead, unless it was queued before.
+ * @param prefetcher The prefetcher, may be NULL.
+ * @param filename The name of the file.
+ */
+void queuePrefetch(Prefetcher *prefetcher, const char *filename) {
+    if (prefetcher == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&prefetcher->lock);
+    queueLocked(prefetcher, filename);
+    pthread_mutex_unlock(&prefetcher->lock);
+}
+
+/**
+ * Stops the background thread once it has finished the file it is reading, and releases the prefetcher.
+ * @param prefetcher The prefetcher to stop, may be NULL.
+ */
+void stopPrefetcher(Prefetcher *prefetcher) {
+    if (prefetcher == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&prefetcher->lock);
+    prefetcher->stopping = true;
+    pthread_cond_signal(&prefetcher->queued);
+    pthread_mutex_unlock(&prefetcher->lock);
+    pthread_join(prefetcher->thread, NULL);
+    pthread_cond_destroy(&prefetcher->queued);
+    pthread_mutex_destroy(&prefetcher->lock);
+    free(prefetcher->files);
+    free(prefetcher);
+}
@@ -0,0 +1,54 @@
+/**
+ * Module prefetch.h
+ * This module contains function prototypes for reading input files ahead of the parser.
+ * A background thread walks the include graph from the files it is given and asks the operating
+ * system to load every file it reaches, so the parser later finds them in the page cache instead
+ * of waiting for the disk.
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stddef.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct Prefetcher
+ * @brief Opaque background reader of input files.
+ */
+typedef struct Prefetcher Prefetcher;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Starts the background thread reading input files ahead of the parser.
+ * Every queued file is loaded into the page cache, and the files it includes with a quoted
+ * #include, and for a header its source file, are queued in turn.
+ * @param maxFileBytes Bytes of a file that are looked through for includes, 0 for the whole file.
+ * @return The prefetcher, or NULL if the thread could not be started.
+ */
+Prefetcher *startPrefetcher(size_t maxFileBytes);
+
+/**
+ * Queues a file to be read ahead, unless it was queued before.
+ * @param prefetcher The prefetcher, may be NULL.
+ * @param filename The name of the file.
+ */
+void queuePrefetch(Prefetcher *prefetcher, const char *filename);
+
+/**
+ * Stops the background thread once it has finished the file it is reading, and releases the prefetcher.
+ * @param prefetcher The prefetcher to stop, may be NULL.
+ */
+void stopPrefetcher(Prefetcher *prefetcher);
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * Module resource_limits.c
+ * This module implements the resource limits and run statistics declared in resource_limits.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "resource_limits.h"
+
+/* Names of the limits, in the order of LimitKind. */
+static const char *const LIMIT_NAMES[LIMIT_KIND_COUNT] = {
+    "bytes", "lines", "comment-lines", "time-ms", "include-depth"
+};
+
+/**
+ * Fills in the default limits.
+ * @param limits The limits to initialize.
+ */
+void defaultResourceLimits(ResourceLimits *limits) {
+    limits->maxFileBytes = 16 * 1024 * 1024;
+    limits->maxFileLines = 1000000;
+    limits->maxCommentLines = 1000;
+    limits->maxFileMilliseconds = 0;
+    limits->maxIncludeDepth = 64;
+}
+
+/**
+ * Parses a limit given as "name=value".
+ * @param spec The limit specification.
+ * @param limits The limits receiving the new value.
+ * @return true if the specification is valid, false otherwise.
+ */
+bool parseResourceLimit(const char *spec, ResourceLimits *limits) {
+    const char *equals = strchr(spec, '=');
+    if (equals == NULL || equals[1] == '\0' || equals[1] == '-') {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(equals + 1, &end, 10);
+    if (*end != '\0' || errno != 0 || value > 0x7FFFFFFFUL) {
+        return false;
+    }
+
+    size_t nameLength = (size_t)(equals - spec);
+    for (int kind = 0; kind < LIMIT_KIND_COUNT; kind++) {
+        if (strlen(LIMIT_NAMES[kind]) != nameLength || strncmp(spec, LIMIT_NAMES[kind], nameLength) != 0) {
+            continue;
+        }
+        switch ((LimitKind)kind) {
+            case LIMIT_BYTES:         limits->maxFileBytes = (size_t)value; break;
+            case LIMIT_LINES:         limits->maxFileLines = (long)value; break;
+            case LIMIT_COMMENT_LINES: limits->maxCommentLines = (long)value; break;
+            case LIMIT_TIME:          limits->maxFileMilliseconds = (long)value; break;
+            case LIMIT_INCLUDE_DEPTH: limits->maxIncludeDepth = (long)value; break;
+            default:                  return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Returns the name of a limit.
+ * @param kind The limit.
+ * @return The name of the limit.
+ */
+const char *limitName(LimitKind kind) {
+    return (kind >= 0 && kind < LIMIT_KIND_COUNT) ? LIMIT_NAMES[kind] : "unknown";
+}
+
+/**
+ * Adds the counters of one run to a total.
+ * @param total The statistics receiving the sum.
+ * @param part The statistics to add.
+ */
+void addRunStatistics(RunStatistics *total, const RunStatistics *part) {
+    total->filesParsed += part->filesParsed;
+    total->bytesParsed += part->bytesParsed;
+    total->linesParsed += part->linesParsed;
+    total->linesSkipped += part->linesSkipped;
+    total->functionsParsed += part->functionsParsed;
+    total->cacheHits += part->cacheHits;
+    for (int kind = 0; kind < LIMIT_KIND_COUNT; kind++) {
+        total->limitHits[kind] += part->limitHits[kind];
+    }
+    total->unterminatedComments += part->unterminatedComments;
+}
+
+/**
+ * Writes the statistics in a human-readable form.
+ * @param outputFile The file where the statistics are written.
+ * @param statistics The statistics to write.
+ */
+void writeRunStatistics(FILE *outputFile, const RunStatistics *statistics) {
+    fprintf(outputFile, "Files parsed:          %ld\n", statistics->filesParsed);
+    fprintf(outputFile, "Files from cache:      %ld\n", statistics->cacheHits);
+    fprintf(outputFile, "Bytes parsed:          %ld\n", statistics->bytesParsed);
+    fprintf(outputFile, "Lines parsed:          %ld\n", statistics->linesParsed);
+    fprintf(outputFile, "Lines skipped:         %ld\n", statistics->linesSkipped);
+    fprintf(outputFile, "Functions found:       %ld\n", statistics->functionsParsed);
+    fprintf(outputFile, "Unterminated comments: %ld\n", statistics->unterminatedComments);
+    fprintf(outputFile, "Limit hits:           ");
+    for (int kind = 0; kind < LIMIT_KIND_COUNT; kind++) {
+        fprintf(outputFile, " %s=%ld", LIMIT_NAMES[kind], statistics->limitHits[kind]);
+    }
+    fprintf(outputFile, "\n");
+}
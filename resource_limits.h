@@ -0,0 +1,102 @@
+/**
+ * Module resource_limits.h
+ * This module contains the per-file resource limits that protect a run against pathological
+ * inputs, and the statistics of a run, which include how often the limits were hit.
+ */
+
+#ifndef RESOURCE_LIMITS_H
+#define RESOURCE_LIMITS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @enum LimitKind
+ * @brief Identifies one of the resource limits.
+ */
+typedef enum {
+    LIMIT_BYTES,                      /* Size of a file; the rest of the file is not parsed. */
+    LIMIT_LINES,                      /* Lines of a file; the rest of the file is not parsed. */
+    LIMIT_COMMENT_LINES,              /* Lines of one comment block; the comment is skipped. */
+    LIMIT_TIME,                       /* Parse time of a file; the rest of the file is not parsed. */
+    LIMIT_INCLUDE_DEPTH,              /* Nesting of includes; deeper files are not processed. */
+    LIMIT_KIND_COUNT                  /* Number of limits. */
+} LimitKind;
+
+/**
+ * @struct ResourceLimits
+ * @brief Limits applied to every processed file. A value of 0 disables a limit.
+ */
+typedef struct {
+    size_t maxFileBytes;              /* Bytes of a file that are parsed. */
+    long maxFileLines;                /* Lines of a file that are parsed. */
+    long maxCommentLines;             /* Lines of a comment block. */
+    long maxFileMilliseconds;         /* Wall time spent parsing one file, off by default so the output does not depend on the machine. */
+    long maxIncludeDepth;             /* Nesting depth of included files. */
+} ResourceLimits;
+
+/**
+ * @struct RunStatistics
+ * @brief Counters collected while documents are generated.
+ */
+typedef struct {
+    long filesParsed;                 /* Files that were parsed. */
+    long bytesParsed;                 /* Bytes that were parsed. */
+    long linesParsed;                 /* Lines that were parsed. */
+    long linesSkipped;                /* Lines of disabled conditional regions, counted in linesParsed. */
+    long functionsParsed;             /* Documented functions found by the parser. */
+    long cacheHits;                   /* Files whose parse result was taken from a shared cache. */
+    long limitHits[LIMIT_KIND_COUNT]; /* Times each limit was hit. */
+    long unterminatedComments;        /* Comment blocks still open at the end of a file. */
+} RunStatistics;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Fills in the default limits, which are far above what hand-written sources need.
+ * @param limits The limits to initialize.
+ */
+void defaultResourceLimits(ResourceLimits *limits);
+
+/**
+ * Parses a limit given as "name=value", where name is one of bytes, lines, comment-lines,
+ * time-ms or include-depth and value is a non-negative number, 0 meaning no limit.
+ * @param spec The limit specification.
+ * @param limits The limits receiving the new value.
+ * @return true if the specification is valid, false otherwise.
+ */
+bool parseResourceLimit(const char *spec, ResourceLimits *limits);
+
+/**
+ * Returns the name of a limit as used by parseResourceLimit.
+ * @param kind The limit.
+ * @return The name of the limit.
+ */
+const char *limitName(LimitKind kind);
+
+/**
+ * Adds the counters of one run to a total.
+ * @param total The statistics receiving the sum.
+ * @param part The statistics to add.
+ */
+void addRunStatistics(RunStatistics *total, const RunStatistics *part);
+
+/**
+ * Writes the statistics in a human-readable form.
+ * @param outputFile The file where the statistics are written.
+ * @param statistics The statistics to write.
+ */
+void writeRunStatistics(FILE *outputFile, const RunStatistics *statistics);
+
+#endif
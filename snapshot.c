@@ -0,0 +1,318 @@
+/**
+ * Module snapshot.c
+ * This module implements the binary snapshots declared in snapshot.h.
+ * A snapshot is read with three calls, one each for the header, the records and the string
+ * table; the strings of the loaded functions point into the string table.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "parse_cache.h"
+#include "utility.h"
+
+/* Identifies a snapshot file. */
+static const char SNAPSHOT_MAGIC[8] = { 'C', 'C', 'D', 'O', 'C', 'D', 'B', '\0' };
+
+/* Version of the snapshot format. */
+#define SNAPSHOT_VERSION 1
+
+/* Size of the header: magic, version, record count and string table size. */
+#define SNAPSHOT_HEADER_SIZE 20
+
+/* Size of a record: four hashes and five string offsets. */
+#define SNAPSHOT_RECORD_SIZE 52
+
+/* Size of the text fields of a function. */
+#define SNAPSHOT_TEXT_SIZE 8192
+
+struct ccdoc_snapshot {
+    SnapshotSymbol *symbols;          /* Functions in the order they were written. */
+    int symbolCount;                  /* Count of functions. */
+    char *strings;                    /* String table the functions point into. */
+};
+
+/**
+ * @struct StringTable
+ * @brief Growable buffer of null-terminated strings.
+ */
+typedef struct {
+    char *data;                       /* The strings. */
+    size_t size;                      /* Number of bytes used. */
+    size_t capacity;                  /* Allocated size of data. */
+} StringTable;
+
+/**
+ * Stores a 32-bit integer in little-endian byte order.
+ * @param out Buffer receiving 4 bytes.
+ * @param value The value to store.
+ */
+static void putUint32(unsigned char *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/**
+ * Stores a 64-bit integer in little-endian byte order.
+ * @param out Buffer receiving 8 bytes.
+ * @param value The value to store.
+ */
+static void putUint64(unsigned char *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/**
+ * Loads a 32-bit integer stored in little-endian byte order.
+ * @param in Buffer holding 4 bytes.
+ * @return The value.
+ */
+static uint32_t getUint32(const unsigned char *in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+/**
+ * Loads a 64-bit integer stored in little-endian byte order.
+ * @param in Buffer holding 8 bytes.
+ * @return The value.
+ */
+static uint64_t getUint64(const unsigned char *in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+/**
+ * Appends a string to a string table.
+ * @param table The string table.
+ * @param str The string to append.
+ * @param offset Pointer to the variable receiving the offset of the string in the table.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool appendString(StringTable *table, const char *str, uint32_t *offset) {
+    size_t length = strlen(str) + 1;
+    if (table->size + length > table->capacity) {
+        size_t capacity = table->capacity ? table->capacity : 4096;
+        while (table->size + length > capacity) {
+            capacity *= 2;
+        }
+        char *grown = realloc(table->data, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        table->data = grown;
+        table->capacity = capacity;
+    }
+    memcpy(table->data + table->size, str, length);
+    *offset = (uint32_t)table->size;
+    table->size += length;
+    return true;
+}
+
+/**
+ * Joins the documented parameters of a function into one text.
+ * @param comment The documentation of the function.
+ * @param params Buffer receiving the text.
+ * @param size Size of the buffer.
+ */
+static void joinParams(const DocComment *comment, char *params, size_t size) {
+    size_t length = 0;
+    params[0] = '\0';
+    for (int i = 0; i < comment->paramCount && length < size; i++) {
+        length += snprintf(params + length, size - length, "%s%s: %s", i > 0 ? "; " : "",
+                           comment->paramName[i], comment->paramDesc[i]);
+    }
+}
+
+/**
+ * Writes documented functions as a binary snapshot.
+ * @param outputFile The file where the snapshot is written, opened in binary mode.
+ * @param functionDocs Array of documented functions.
+ * @param indices Indices of the functions to write, in the order they are written.
+ * @param count Count of indices.
+ * @return true on success, false if the snapshot could not be written.
+ */
+bool writeSnapshot(FILE *outputFile, const FunctionDoc *functionDocs, const int *indices, int count) {
+    StringTable table = { NULL, 0, 0 };
+    unsigned char *records = malloc((size_t)(count > 0 ? count : 1) * SNAPSHOT_RECORD_SIZE);
+    char key[600];
+    char text[SNAPSHOT_TEXT_SIZE];
+    bool written = records != NULL;
+
+    for (int i = 0; i < count && written; i++) {
+        const FunctionDoc *funcDoc = &functionDocs[indices[i]];
+        unsigned char *record = records + (size_t)i * SNAPSHOT_RECORD_SIZE;
+        char module[256];
+        char identifier[256];
+        uint32_t offsets[5];
+
+        /* The join key; a header and its source file form one module, whichever was parsed first */
+        moduleNameOfFile(funcDoc->moduleName, module, sizeof(module));
+        functionIdentifier(funcDoc->functionName, identifier, sizeof(identifier));
+        snprintf(key, sizeof(key), "%s\n%s", module, identifier);
+        putUint64(record, hashContent(key, strlen(key)));
+        written = appendString(&table, module, &offsets[0]) &&
+                  appendString(&table, identifier, &offsets[1]);
+
+        snprintf(text, sizeof(text), "%s %s", funcDoc->returnType, funcDoc->functionName);
+        putUint64(record + 8, hashContent(text, strlen(text)));
+        written = written && appendString(&table, text, &offsets[2]);
+
+        joinParams(&funcDoc->comment, text, sizeof(text));
+        putUint64(record + 16, hashContent(text, strlen(text)));
+        written = written && appendString(&table, text, &offsets[3]);
+
+        putUint64(record + 24, hashContent(funcDoc->comment.returnVal, strlen(funcDoc->comment.returnVal)));
+        written = written && appendString(&table, funcDoc->comment.returnVal, &offsets[4]);
+
+        for (int j = 0; j < 5; j++) {
+            putUint32(record + 32 + 4 * j, offsets[j]);
+        }
+    }
+
+    if (written) {
+        unsigned char header[SNAPSHOT_HEADER_SIZE];
+        memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        putUint32(header + 8, SNAPSHOT_VERSION);
+        putUint32(header + 12, (uint32_t)count);
+        putUint32(header + 16, (uint32_t)table.size);
+        written = fwrite(header, 1, sizeof(header), outputFile) == sizeof(header) &&
+                  fwrite(records, SNAPSHOT_RECORD_SIZE, (size_t)count, outputFile) == (size_t)count &&
+                  (table.size == 0 || fwrite(table.data, 1, table.size, outputFile) == table.size);
+    }
+    if (!written) {
+        fprintf(stderr, "Error: Unable to write snapshot\n");
+    }
+    free(records);
+    free(table.data);
+    return written;
+}
+
+/**
+ * Reads a snapshot written by writeSnapshot.
+ * @param inputFile The file holding the snapshot, opened in binary mode.
+ * @param name Name of the file, used in error messages.
+ * @return Pointer to the snapshot, or NULL if the file is not a valid snapshot.
+ */
+ccdoc_snapshot *readSnapshot(FILE *inputFile, const char *name) {
+    unsigned char header[SNAPSHOT_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), inputFile) != sizeof(header) ||
+        memcmp(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        fprintf(stderr, "Error: File %s is not a ccdoc snapshot\n", name);
+        return NULL;
+    }
+    if (getUint32(header + 8) != SNAPSHOT_VERSION) {
+        fprintf(stderr, "Error: Snapshot %s has unsupported version %lu\n", name, (unsigned long)getUint32(header + 8));
+        return NULL;
+    }
+    uint32_t count = getUint32(header + 12);
+    uint32_t stringSize = getUint32(header + 16);
+    if (count > 0x7FFFFFFFUL / SNAPSHOT_RECORD_SIZE) {
+        fprintf(stderr, "Error: Snapshot %s is corrupted\n", name);
+        return NULL;
+    }
+
+    /* Counts beyond the end of a seekable file are rejected before anything is allocated for them */
+    long start = ftell(inputFile);
+    if (start >= 0 && fseek(inputFile, 0, SEEK_END) == 0) {
+        long end = ftell(inputFile);
+        bool fits = end >= start && (uint64_t)count * SNAPSHOT_RECORD_SIZE + stringSize <= (uint64_t)(end - start);
+        if (fseek(inputFile, start, SEEK_SET) != 0 || !fits) {
+            fprintf(stderr, "Error: Snapshot %s is truncated or corrupted\n", name);
+            return NULL;
+        }
+    }
+
+    ccdoc_snapshot *snapshot = calloc(1, sizeof(ccdoc_snapshot));
+    unsigned char *records = malloc((size_t)(count > 0 ? count : 1) * SNAPSHOT_RECORD_SIZE);
+    if (snapshot == NULL || records == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for snapshot %s\n", name);
+        free(records);
+        free(snapshot);
+        return NULL;
+    }
+    snapshot->strings = malloc(stringSize > 0 ? stringSize : 1);
+    snapshot->symbols = malloc((size_t)(count > 0 ? count : 1) * sizeof(SnapshotSymbol));
+    if (snapshot->strings == NULL || snapshot->symbols == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for snapshot %s\n", name);
+        free(records);
+        destroySnapshot(snapshot);
+        return NULL;
+    }
+
+    /* Every offset must point into the string table, which must end with a null character */
+    bool valid = fread(records, SNAPSHOT_RECORD_SIZE, count, inputFile) == count &&
+                 fread(snapshot->strings, 1, stringSize, inputFile) == stringSize &&
+                 (stringSize == 0 ? count == 0 : snapshot->strings[stringSize - 1] == '\0');
+    for (uint32_t i = 0; i < count && valid; i++) {
+        const unsigned char *record = records + (size_t)i * SNAPSHOT_RECORD_SIZE;
+        const char *fields[5];
+        for (int j = 0; j < 5 && valid; j++) {
+            uint32_t offset = getUint32(record + 32 + 4 * j);
+            valid = offset < stringSize;
+            fields[j] = snapshot->strings + (valid ? offset : 0);
+        }
+
+        SnapshotSymbol *symbol = &snapshot->symbols[i];
+        symbol->keyHash = getUint64(record);
+        symbol->prototypeHash = getUint64(record + 8);
+        symbol->paramsHash = getUint64(record + 16);
+        symbol->returnHash = getUint64(record + 24);
+        symbol->module = fields[0];
+        symbol->identifier = fields[1];
+        symbol->prototype = fields[2];
+        symbol->params = fields[3];
+        symbol->returnText = fields[4];
+    }
+    free(records);
+    if (!valid) {
+        fprintf(stderr, "Error: Snapshot %s is truncated or corrupted\n", name);
+        destroySnapshot(snapshot);
+        return NULL;
+    }
+    snapshot->symbolCount = (int)count;
+    return snapshot;
+}
+
+/**
+ * Releases a snapshot.
+ * @param snapshot The snapshot to destroy, may be NULL.
+ */
+void destroySnapshot(ccdoc_snapshot *snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+    free(snapshot->symbols);
+    free(snapshot->strings);
+    free(snapshot);
+}
+
+/**
+ * Returns the number of functions in a snapshot.
+ * @param snapshot The snapshot.
+ * @return The number of functions.
+ */
+int snapshotSymbolCount(const ccdoc_snapshot *snapshot) {
+    return snapshot->symbolCount;
+}
+
+/**
+ * Returns a function of a snapshot.
+ * @param snapshot The snapshot.
+ * @param index Position of the function.
+ * @return Pointer to the function, or NULL if the index is out of range.
+ */
+const SnapshotSymbol *snapshotSymbolAt(const ccdoc_snapshot *snapshot, int index) {
+    if (index < 0 || index >= snapshot->symbolCount) {
+        return NULL;
+    }
+    return &snapshot->symbols[index];
+}
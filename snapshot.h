@@ -0,0 +1,93 @@
+/**
+ * Module snapshot.h
+ * This module contains function prototypes for saving the documented functions of a run as a
+ * binary snapshot and loading such snapshots again, so two versions of an API can be compared
+ * without parsing the sources again.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "data_structures.h"
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct SnapshotSymbol
+ * @brief One documented function of a loaded snapshot.
+ * The hashes let two snapshots be compared without looking at the text.
+ */
+typedef struct {
+    uint64_t keyHash;                 /* Hash of the module and identifier, used to join snapshots. */
+    uint64_t prototypeHash;           /* Hash of the prototype. */
+    uint64_t paramsHash;              /* Hash of the parameter documentation. */
+    uint64_t returnHash;              /* Hash of the return value documentation. */
+    const char *module;               /* Module of the function. */
+    const char *identifier;           /* Identifier of the function. */
+    const char *prototype;            /* Return type and declarator of the function. */
+    const char *params;               /* Documented parameters, separated by "; ". */
+    const char *returnText;           /* Documented return value. */
+} SnapshotSymbol;
+
+/**
+ * @struct ccdoc_snapshot
+ * @brief Opaque snapshot of the documented functions of one run.
+ */
+typedef struct ccdoc_snapshot ccdoc_snapshot;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Writes documented functions as a binary snapshot.
+ * The file starts with a header naming the format version and the counts, followed by one
+ * fixed-size record per function and a table of null-terminated strings. All integers are
+ * stored in little-endian byte order.
+ * @param outputFile The file where the snapshot is written, opened in binary mode.
+ * @param functionDocs Array of documented functions.
+ * @param indices Indices of the functions to write, in the order they are written.
+ * @param count Count of indices.
+ * @return true on success, false if the snapshot could not be written.
+ */
+bool writeSnapshot(FILE *outputFile, const FunctionDoc *functionDocs, const int *indices, int count);
+
+/**
+ * Reads a snapshot written by writeSnapshot.
+ * @param inputFile The file holding the snapshot, opened in binary mode.
+ * @param name Name of the file, used in error messages.
+ * @return Pointer to the snapshot, or NULL if the file is not a valid snapshot.
+ */
+ccdoc_snapshot *readSnapshot(FILE *inputFile, const char *name);
+
+/**
+ * Releases a snapshot.
+ * @param snapshot The snapshot to destroy, may be NULL.
+ */
+void destroySnapshot(ccdoc_snapshot *snapshot);
+
+/**
+ * Returns the number of functions in a snapshot.
+ * @param snapshot The snapshot.
+ * @return The number of functions.
+ */
+int snapshotSymbolCount(const ccdoc_snapshot *snapshot);
+
+/**
+ * Returns a function of a snapshot, in the order it was written.
+ * @param snapshot The snapshot.
+ * @param index Position of the function, from 0 to snapshotSymbolCount() - 1.
+ * @return Pointer to the function, or NULL if the index is out of range.
+ */
+const SnapshotSymbol *snapshotSymbolAt(const ccdoc_snapshot *snapshot, int index);
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * Module symbol_index.c
+ * This module implements the lookup structure declared in symbol_index.h.
+ * Exact lookups probe an open addressing hash table and prefix lookups binary search
+ * an array of indices sorted by identifier.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "symbol_index.h"
+#include "utility.h"
+
+/**
+ * Computes the FNV-1a hash of a string.
+ * @param str The string to hash.
+ * @return The 32-bit hash.
+ */
+static uint32_t hashIdentifier(const char *str) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Sorts the function indices by identifier with an insertion sort.
+ * The collection is limited to MAX_FUNCTIONS entries, so this is cheaper than qsort,
+ * which would need the identifiers in a global variable.
+ * @param index The index whose sorted array is filled.
+ */
+static void sortIdentifiers(SymbolIndex *index) {
+    for (int i = 0; i < index->count; i++) {
+        int current = i;
+        int j = i - 1;
+        while (j >= 0 && strcmp(index->identifiers[index->sorted[j]], index->identifiers[current]) > 0) {
+            index->sorted[j + 1] = index->sorted[j];
+            j--;
+        }
+        index->sorted[j + 1] = current;
+    }
+}
+
+/**
+ * Builds the index over an array of documented functions.
+ * @param index The index to build.
+ * @param functionDocs Array of documented functions.
+ * @param functionCount Count of documented functions.
+ */
+void buildSymbolIndex(SymbolIndex *index, const FunctionDoc *functionDocs, int functionCount) {
+    memset(index->slots, 0, sizeof(index->slots));
+    index->count = functionCount;
+
+    for (int i = 0; i < functionCount; i++) {
+        functionIdentifier(functionDocs[i].functionName, index->identifiers[i], sizeof(index->identifiers[i]));
+
+        /* Insert into the first free slot of the probe sequence */
+        uint32_t slot = hashIdentifier(index->identifiers[i]) & (SYMBOL_INDEX_SLOTS - 1);
+        while (index->slots[slot] != 0) {
+            slot = (slot + 1) & (SYMBOL_INDEX_SLOTS - 1);
+        }
+        index->slots[slot] = i + 1;
+    }
+
+    sortIdentifiers(index);
+    index->valid = true;
+}
+
+/**
+ * Finds the functions with the given identifier.
+ * Functions with the same identifier but different return types are all returned.
+ * @param index The index to search.
+ * @param name The identifier to find.
+ * @param matches Array receiving the indices of the matching functions.
+ * @param maxMatches Size of the matches array.
+ * @return The number of matches stored in the array.
+ */
+int findSymbols(const SymbolIndex *index, const char *name, int *matches, int maxMatches) {
+    int matchCount = 0;
+    uint32_t slot = hashIdentifier(name) & (SYMBOL_INDEX_SLOTS - 1);
+
+    /* Follow the probe sequence until an empty slot */
+    while (index->slots[slot] != 0 && matchCount < maxMatches) {
+        int function = index->slots[slot] - 1;
+        if (strcmp(index->identifiers[function], name) == 0) {
+            matches[matchCount++] = function;
+        }
+        slot = (slot + 1) & (SYMBOL_INDEX_SLOTS - 1);
+    }
+    return matchCount;
+}
+
+/**
+ * Finds the functions whose identifier starts with the given prefix, in identifier order.
+ * @param index The index to search.
+ * @param prefix The prefix to find.
+ * @param matches Array receiving the indices of the matching functions.
+ * @param maxMatches Size of the matches array.
+ * @return The number of matches stored in the array.
+ */
+int findSymbolsByPrefix(const SymbolIndex *index, const char *prefix, int *matches, int maxMatches) {
+    size_t prefixLength = strlen(prefix);
+    int low = 0;
+    int high = index->count;
+
+    /* Find the first identifier not smaller than the prefix */
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (strcmp(index->identifiers[index->sorted[middle]], prefix) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    int matchCount = 0;
+    for (int i = low; i < index->count && matchCount < maxMatches; i++) {
+        if (strncmp(index->identifiers[index->sorted[i]], prefix, prefixLength) != 0) {
+            break;
+        }
+        matches[matchCount++] = index->sorted[i];
+    }
+    return matchCount;
+}
@@ -0,0 +1,79 @@
+/**
+ * Module symbol_index.h
+ * This module contains the lookup structure used to find documented functions by name or prefix
+ * without scanning the whole collection.
+ */
+
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include "constants.h"
+#include "data_structures.h"
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Constants
+   ____________________________________________________________________________
+*/
+
+/* Number of hash slots, a power of two at least twice MAX_FUNCTIONS. */
+#define SYMBOL_INDEX_SLOTS 256
+
+#if SYMBOL_INDEX_SLOTS < 2 * MAX_FUNCTIONS
+#error "SYMBOL_INDEX_SLOTS must be at least twice MAX_FUNCTIONS"
+#endif
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct SymbolIndex
+ * @brief Hash table and sorted array over the identifiers of the documented functions.
+ */
+typedef struct {
+    char identifiers[MAX_FUNCTIONS][256];  /* Identifier of every documented function. */
+    int slots[SYMBOL_INDEX_SLOTS];         /* Open addressing table of function index + 1, 0 if empty. */
+    int sorted[MAX_FUNCTIONS];             /* Function indices sorted by identifier. */
+    int count;                             /* Count of indexed functions. */
+    bool valid;                            /* Indicates if the index matches the collection. */
+} SymbolIndex;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Builds the index over an array of documented functions.
+ * @param index The index to build.
+ * @param functionDocs Array of documented functions.
+ * @param functionCount Count of documented functions.
+ */
+void buildSymbolIndex(SymbolIndex *index, const FunctionDoc *functionDocs, int functionCount);
+
+/**
+ * Finds the functions with the given identifier.
+ * @param index The index to search.
+ * @param name The identifier to find.
+ * @param matches Array receiving the indices of the matching functions.
+ * @param maxMatches Size of the matches array.
+ * @return The number of matches stored in the array.
+ */
+int findSymbols(const SymbolIndex *index, const char *name, int *matches, int maxMatches);
+
+/**
+ * Finds the functions whose identifier starts with the given prefix, in identifier order.
+ * @param index The index to search.
+ * @param prefix The prefix to find.
+ * @param matches Array receiving the indices of the matching functions.
+ * @param maxMatches Size of the matches array.
+ * @return The number of matches stored in the array.
+ */
+int findSymbolsByPrefix(const SymbolIndex *index, const char *prefix, int *matches, int maxMatches);
+
+#endif 
@@ -0,0 +1,409 @@
+/**
+ * Module tar_archive.c
+ * This module implements the in-memory tar archive declared in tar_archive.h.
+ * The archive is read block by block; the content of every regular file is read straight into
+ * its own buffer and the members are found by name through a hash table.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tar_archive.h"
+#include "parse_cache.h"
+
+/* Size of a tar header and of the unit the member content is padded to. */
+#define TAR_BLOCK_SIZE 512
+
+/* Number of hash buckets of the member table. */
+#define ARCHIVE_BUCKETS 1024
+
+/**
+ * @struct ArchiveMember
+ * @brief One regular file of the archive.
+ */
+typedef struct {
+    char name[256];                   /* Name of the member without a leading "./". */
+    char *data;                       /* Content of the member. */
+    size_t size;                      /* Number of bytes in data. */
+    int next;                         /* Next member in the same bucket, -1 at the end. */
+} ArchiveMember;
+
+struct ccdoc_archive {
+    ArchiveMember *members;           /* Members in the order of the archive. */
+    int memberCount;                  /* Count of members. */
+    int memberCapacity;               /* Allocated size of the members array. */
+    int buckets[ARCHIVE_BUCKETS];     /* First member of every bucket, -1 if empty. */
+};
+
+/**
+ * Skips the "./" prefixes of a member name.
+ * @param name The name of the member.
+ * @return Pointer to the name without the prefixes.
+ */
+static const char *memberName(const char *name) {
+    while (name[0] == '.' && name[1] == '/') {
+        name += 2;
+    }
+    return name;
+}
+
+/**
+ * Computes the bucket of a member name.
+ * @param name The name, without a leading "./".
+ * @return Index of the bucket.
+ */
+static int bucketOfName(const char *name) {
+    return (int)(hashContent(name, strlen(name)) % ARCHIVE_BUCKETS);
+}
+
+/**
+ * Finds the position of a member in the member table.
+ * @param archive The archive.
+ * @param name The name, without a leading "./".
+ * @return Position of the member, or -1 if there is no such member.
+ */
+static int findMemberIndex(const ccdoc_archive *archive, const char *name) {
+    for (int i = archive->buckets[bucketOfName(name)]; i >= 0; i = archive->members[i].next) {
+        if (strcmp(archive->members[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Adds a member to the archive, replacing an earlier member of the same name.
+ * @param archive The archive.
+ * @param name Name of the member.
+ * @param data Content of the member; the archive takes ownership of it.
+ * @param size Number of bytes in data.
+ * @return true on success, false if memory could not be allocated.
+ */
+static bool addMember(ccdoc_archive *archive, const char *name, char *data, size_t size) {
+    name = memberName(name);
+    int index = findMemberIndex(archive, name);
+    if (index >= 0) {
+        free(archive->members[index].data);
+        archive->members[index].data = data;
+        archive->members[index].size = size;
+        return true;
+    }
+
+    /* Grow the member table if it is full */
+    if (archive->memberCount == archive->memberCapacity) {
+        int capacity = archive->memberCapacity ? archive->memberCapacity * 2 : 64;
+        ArchiveMember *grown = realloc(archive->members, capacity * sizeof(ArchiveMember));
+        if (grown == NULL) {
+            return false;
+        }
+        archive->members = grown;
+        archive->memberCapacity = capacity;
+    }
+
+    ArchiveMember *member = &archive->members[archive->memberCount];
+    snprintf(member->name, sizeof(member->name), "%s", name);
+    member->data = data;
+    member->size = size;
+    int bucket = bucketOfName(member->name);
+    member->next = archive->buckets[bucket];
+    archive->buckets[bucket] = archive->memberCount++;
+    return true;
+}
+
+/**
+ * Parses a numeric header field, written in octal or, for large values, in base-256.
+ * @param field The field.
+ * @param length Length of the field.
+ * @return The value of the field.
+ */
+static unsigned long long parseNumber(const unsigned char *field, size_t length) {
+    unsigned long long value = 0;
+
+    if (field[0] & 0x80) {
+        /* Base-256: the remaining bits of the field are a big-endian number */
+        value = field[0] & 0x7F;
+        for (size_t i = 1; i < length; i++) {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+    size_t i = 0;
+    while (i < length && field[i] == ' ') {
+        i++;
+    }
+    while (i < length && field[i] >= '0' && field[i] <= '7') {
+        value = value * 8 + (field[i] - '0');
+        i++;
+    }
+    return value;
+}
+
+/**
+ * Checks the checksum of a header block.
+ * @param block The header block.
+ * @return true if the stored checksum matches the content of the block.
+ */
+static bool validHeader(const unsigned char *block) {
+    unsigned long long sum = 0;
+    for (int i = 0; i < TAR_BLOCK_SIZE; i++) {
+        /* The checksum field itself is counted as spaces */
+        sum += (i >= 148 && i < 156) ? ' ' : block[i];
+    }
+    return sum == parseNumber(block + 148, 8);
+}
+
+/**
+ * Skips the content of a member and the padding to the next block.
+ * The content is read block by block, since the stream may be a pipe.
+ * @param stream The stream holding the archive.
+ * @param size Number of bytes of content, as given in the header.
+ * @return true on success, false if the stream ends early.
+ */
+static bool skipMemberData(FILE *stream, unsigned long long size) {
+    char block[TAR_BLOCK_SIZE];
+    unsigned long long blocks = size / TAR_BLOCK_SIZE + (size % TAR_BLOCK_SIZE != 0);
+    for (unsigned long long i = 0; i < blocks; i++) {
+        if (fread(block, 1, TAR_BLOCK_SIZE, stream) != TAR_BLOCK_SIZE) {
+            fprintf(stderr, "Error: Archive ends in the middle of a member\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Reads the first bytes of the content of a member and skips the rest of it and the padding
+ * to the next block. The kept bytes are null-terminated, so text members can be scanned safely.
+ * @param stream The stream holding the archive.
+ * @param size Number of bytes of content, as given in the header.
+ * @param keep Number of bytes kept, at most size and already checked against the limits.
+ * @return Newly allocated buffer with the kept bytes, or NULL if the stream ends early
+ *         or memory could not be allocated.
+ */
+static char *readMemberData(FILE *stream, unsigned long long size, size_t keep) {
+    char block[TAR_BLOCK_SIZE];
+    char *data = malloc(keep + 1);
+    if (data == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for archive member\n");
+        return NULL;
+    }
+    unsigned long long rest = (size / TAR_BLOCK_SIZE + (size % TAR_BLOCK_SIZE != 0)) * TAR_BLOCK_SIZE - keep;
+    bool complete = fread(data, 1, keep, stream) == keep;
+    while (complete && rest > 0) {
+        size_t chunk = rest < TAR_BLOCK_SIZE ? (size_t)rest : TAR_BLOCK_SIZE;
+        complete = fread(block, 1, chunk, stream) == chunk;
+        rest -= chunk;
+    }
+    if (!complete) {
+        fprintf(stderr, "Error: Archive ends in the middle of a member\n");
+        free(data);
+        return NULL;
+    }
+    data[keep] = '\0';
+    return data;
+}
+
+/**
+ * Finds the path record of a pax extended header.
+ * Records have the form "<length> <keyword>=<value>\n".
+ * @param data Content of the extended header.
+ * @param size Number of bytes in data.
+ * @param path Buffer receiving the path; left unchanged if there is none.
+ * @param pathSize Size of the path buffer.
+ */
+static void paxPath(const char *data, size_t size, char *path, size_t pathSize) {
+    size_t offset = 0;
+    while (offset < size) {
+        size_t length = strtoul(data + offset, NULL, 10);
+        const char *record = memchr(data + offset, ' ', size - offset);
+        if (length == 0 || offset + length > size || record == NULL) {
+            return;
+        }
+        record++;
+        const char *end = data + offset + length - 1;  /* The newline ending the record */
+        if (end - record > 5 && strncmp(record, "path=", 5) == 0) {
+            snprintf(path, pathSize, "%.*s", (int)(end - record - 5), record + 5);
+        }
+        offset += length;
+    }
+}
+
+/**
+ * Builds the name of a regular member from its header and a preceding long name.
+ * @param block The header block.
+ * @param longName The GNU long name or pax path of the member, empty if there is none.
+ * @param name Buffer of 512 characters receiving the name.
+ */
+static void headerName(const unsigned char *block, const char *longName, char *name) {
+    if (longName[0] != '\0') {
+        snprintf(name, 512, "%s", longName);
+    }
+    else if (memcmp(block + 257, "ustar", 5) == 0 && block[345] != '\0') {
+        snprintf(name, 512, "%.155s/%.100s", (const char *)block + 345, (const char *)block);
+    }
+    else {
+        snprintf(name, 512, "%.100s", (const char *)block);
+    }
+}
+
+/**
+ * Reads a tar archive from a stream until its end-of-archive marker.
+ * @param stream The stream holding the archive, opened in binary mode.
+ * @param maxMemberSize Byte limit of the parser, 0 for none; no member keeps more than MAX_ARCHIVE_MEMBER_SIZE bytes.
+ * @return Pointer to the archive, or NULL if the stream is not a valid archive or memory
+ *         could not be allocated.
+ */
+ccdoc_archive *readTarArchive(FILE *stream, size_t maxMemberSize) {
+    ccdoc_archive *archive = calloc(1, sizeof(ccdoc_archive));
+    if (archive == NULL) {
+        fprintf(stderr, "Error: Unable to allocate memory for archive\n");
+        return NULL;
+    }
+    memset(archive->buckets, -1, sizeof(archive->buckets));
+    bool capped = maxMemberSize == 0 || maxMemberSize >= MAX_ARCHIVE_MEMBER_SIZE;
+    if (capped) {
+        maxMemberSize = MAX_ARCHIVE_MEMBER_SIZE;
+    }
+
+    unsigned char block[TAR_BLOCK_SIZE];
+    char longName[512] = "";
+    size_t blockSize;
+    while ((blockSize = fread(block, 1, TAR_BLOCK_SIZE, stream)) == TAR_BLOCK_SIZE) {
+        /* A zero block marks the end of the archive */
+        bool zeroBlock = true;
+        for (int i = 0; i < TAR_BLOCK_SIZE && zeroBlock; i++) {
+            zeroBlock = block[i] == 0;
+        }
+        if (zeroBlock) {
+            return archive;
+        }
+        if (!validHeader(block)) {
+            fprintf(stderr, "Error: Input is not a tar archive or is corrupted\n");
+            destroyArchive(archive);
+            return NULL;
+        }
+
+        /* The size comes from the header, so it is checked before anything is allocated */
+        unsigned long long size = parseNumber(block + 124, 12);
+        char type = (char)block[156];
+        bool regular = type == '0' || type == '\0' || type == '7';
+        bool extension = type == 'L' || type == 'x';
+        char name[512];
+        headerName(block, longName, name);
+        longName[0] = '\0';
+
+        if (!regular && !extension) {
+            /* Directories, links and other entries carry no source code */
+            if (!skipMemberData(stream, size)) {
+                destroyArchive(archive);
+                return NULL;
+            }
+            continue;
+        }
+        if (extension && size > MAX_ARCHIVE_HEADER_SIZE) {
+            fprintf(stderr, "Warning: Extended header of archive member exceeds %zu bytes and is skipped\n", MAX_ARCHIVE_HEADER_SIZE);
+            if (!skipMemberData(stream, size)) {
+                destroyArchive(archive);
+                return NULL;
+            }
+            continue;
+        }
+
+        /* A member over the limit is cut like a file on disk: one byte more is kept, so the parser reports the limit */
+        size_t keep = (size_t)size;
+        if (!extension && size > maxMemberSize) {
+            keep = capped ? maxMemberSize : maxMemberSize + 1;
+            if (capped) {
+                fprintf(stderr, "Warning: Archive member %s exceeds %zu bytes, the rest of it is not read\n", name, maxMemberSize);
+            }
+        }
+        char *data = readMemberData(stream, size, keep);
+        if (data == NULL) {
+            destroyArchive(archive);
+            return NULL;
+        }
+
+        if (type == 'L') {
+            /* GNU long name of the next member */
+            snprintf(longName, sizeof(longName), "%.*s", (int)keep, data);
+            free(data);
+        }
+        else if (type == 'x') {
+            /* pax extended header of the next member */
+            paxPath(data, keep, longName, sizeof(longName));
+            free(data);
+        }
+        else {
+            if (strlen(name) >= sizeof(((ArchiveMember *)0)->name)) {
+                fprintf(stderr, "Error: Name of archive member %s is too long\n", name);
+                free(data);
+            }
+            else if (!addMember(archive, name, data, keep)) {
+                fprintf(stderr, "Error: Unable to allocate memory for archive\n");
+                free(data);
+                destroyArchive(archive);
+                return NULL;
+            }
+        }
+    }
+
+    /* Some writers omit the end-of-archive marker */
+    if (blockSize != 0 || ferror(stream)) {
+        fprintf(stderr, "Error: Archive ends in the middle of a header\n");
+        destroyArchive(archive);
+        return NULL;
+    }
+    return archive;
+}
+
+/**
+ * Releases an archive and the content of its members.
+ * @param archive The archive to destroy, may be NULL.
+ */
+void destroyArchive(ccdoc_archive *archive) {
+    if (archive == NULL) {
+        return;
+    }
+    for (int i = 0; i < archive->memberCount; i++) {
+        free(archive->members[i].data);
+    }
+    free(archive->members);
+    free(archive);
+}
+
+/**
+ * Looks up a member of an archive by name.
+ * @param archive The archive.
+ * @param name Name of the member.
+ * @param size Pointer to the variable receiving the size of the member.
+ * @return Pointer to the content of the member, or NULL if the archive has no such member.
+ */
+const char *findArchiveMember(const ccdoc_archive *archive, const char *name, size_t *size) {
+    int index = findMemberIndex(archive, memberName(name));
+    if (index < 0) {
+        return NULL;
+    }
+    *size = archive->members[index].size;
+    return archive->members[index].data;
+}
+
+/**
+ * Returns the number of members of an archive.
+ * @param archive The archive.
+ * @return The number of members.
+ */
+int archiveMemberCount(const ccdoc_archive *archive) {
+    return archive->memberCount;
+}
+
+/**
+ * Returns the name of a member of an archive.
+ * @param archive The archive.
+ * @param index Position of the member.
+ * @return The name of the member, or NULL if the index is out of range.
+ */
+const char *archiveMemberName(const ccdoc_archive *archive, int index) {
+    if (index < 0 || index >= archive->memberCount) {
+        return NULL;
+    }
+    return archive->members[index].name;
+}
@@ -0,0 +1,83 @@
+/**
+ * Module tar_archive.h
+ * This module contains function prototypes for reading a tar archive into memory, so source files
+ * can be documented straight from an archive stream without unpacking it to disk.
+ */
+
+#ifndef TAR_ARCHIVE_H
+#define TAR_ARCHIVE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Most bytes kept of an archive member when no smaller limit is given. */
+#define MAX_ARCHIVE_MEMBER_SIZE ((size_t)1 << 30)
+
+/* Largest GNU long name or pax extended header that is read. */
+#define MAX_ARCHIVE_HEADER_SIZE ((size_t)1 << 16)
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct ccdoc_archive
+ * @brief Opaque table of the regular files of a tar archive and their content.
+ */
+typedef struct ccdoc_archive ccdoc_archive;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Reads a tar archive from a stream until its end-of-archive marker.
+ * The stream is read sequentially, so it may be a pipe. POSIX ustar, GNU long names and
+ * pax path records are understood. Only regular files are kept; a member that appears
+ * twice replaces the earlier one, as when the archive is extracted. The sizes in the headers
+ * are checked before anything is allocated. A member larger than the limit is cut like a
+ * file on disk: maxMemberSize + 1 bytes are kept, so the parser finds it over its byte limit
+ * and reports it, and the rest is skipped without being kept in memory.
+ * @param stream The stream holding the archive, opened in binary mode.
+ * @param maxMemberSize Byte limit of the parser, 0 for none; no member keeps more than MAX_ARCHIVE_MEMBER_SIZE bytes.
+ * @return Pointer to the archive, or NULL if the stream is not a valid archive or memory
+ *         could not be allocated.
+ */
+ccdoc_archive *readTarArchive(FILE *stream, size_t maxMemberSize);
+
+/**
+ * Releases an archive and the content of its members.
+ * @param archive The archive to destroy, may be NULL.
+ */
+void destroyArchive(ccdoc_archive *archive);
+
+/**
+ * Looks up a member of an archive by name. A leading "./" is ignored.
+ * @param archive The archive.
+ * @param name Name of the member.
+ * @param size Pointer to the variable receiving the size of the member.
+ * @return Pointer to the content of the member, or NULL if the archive has no such member.
+ */
+const char *findArchiveMember(const ccdoc_archive *archive, const char *name, size_t *size);
+
+/**
+ * Returns the number of members of an archive.
+ * @param archive The archive.
+ * @return The number of members.
+ */
+int archiveMemberCount(const ccdoc_archive *archive);
+
+/**
+ * Returns the name of a member of an archive, in the order of the archive.
+ * @param archive The archive.
+ * @param index Position of the member, from 0 to archiveMemberCount() - 1.
+ * @return The name of the member, or NULL if the index is out of range.
+ */
+const char *archiveMemberName(const ccdoc_archive *archive, int index);
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * Module test.h
+ * This module contains the checks shared by the unit tests. Every test program includes it once,
+ * calls its test functions from main and returns testResult(). A failed check is reported with
+ * its file and line, and the remaining checks still run.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+/* Count of failed checks of the test program. */
+static int testFailures = 0;
+
+/* Count of checks of the test program. */
+static int testChecks = 0;
+
+/**
+ * Checks that a condition holds.
+ * @param condition The condition.
+ */
+#define CHECK(condition) \
+    do { \
+        testChecks++; \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures++; \
+        } \
+    } while (0)
+
+/**
+ * Checks that two strings are equal.
+ * @param actual The string produced by the code under test.
+ * @param expected The expected string.
+ */
+#define CHECK_STRING(actual, expected) \
+    do { \
+        const char *actualString = (actual); \
+        const char *expectedString = (expected); \
+        testChecks++; \
+        if (actualString == NULL || strcmp(actualString, expectedString) != 0) { \
+            fprintf(stderr, "%s:%d: expected \"%s\", got \"%s\"\n", __FILE__, __LINE__, \
+                    expectedString, actualString ? actualString : "(null)"); \
+            testFailures++; \
+        } \
+    } while (0)
+
+/**
+ * Reports the result of a test program.
+ * @param name Name of the test program.
+ * @return The exit status of the program, 0 if all checks passed and 1 otherwise.
+ */
+static inline int testResult(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, testChecks, testFailures);
+    return testFailures > 0;
+}
+
+/**
+ * Reads everything written to a temporary stream.
+ * @param stream The stream, rewound by this function.
+ * @param buffer Buffer receiving the text.
+ * @param size Size of the buffer.
+ * @return The text in buffer.
+ */
+static inline const char *streamText(FILE *stream, char *buffer, size_t size) {
+    rewind(stream);
+    size_t length = fread(buffer, 1, size - 1, stream);
+    buffer[length] = '\0';
+    return buffer;
+}
+
+#endif
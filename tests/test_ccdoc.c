@@ -0,0 +1,253 @@
+/**
+ * Module test_ccdoc.c
+ * This module contains the unit tests of the context API declared in ccdoc.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ccdoc.h"
+#include "test.h"
+
+/* Source code with two documented functions. */
+static const char SOURCE[] =
+    "/**\n"
+    " * @brief Adds two numbers.\n"
+    " * @param int a the first number\n"
+    " * @param int b the second number\n"
+    " * @return the sum of both\n"
+    " */\n"
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "/**\n"
+    " * @brief Negates a number.\n"
+    " * @param int value the number to negate\n"
+    " */\n"
+    "int negate(int value);\n";
+
+/**
+ * Checks that a buffer is parsed into the symbols of a context.
+ */
+static void testAddBuffer(void) {
+    ccdoc_context *ctx = ccdocCreate();
+    CHECK(ctx != NULL);
+    CHECK(ccdocAddBuffer(ctx, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocSymbolCount(ctx) == 2);
+    CHECK(!ccdocHasInvalidComments(ctx));
+
+    int indices[4];
+    CHECK(ccdocFindSymbols(ctx, "negate", indices, 4) == 1);
+    const FunctionDoc *doc = ccdocSymbolAt(ctx, indices[0]);
+    CHECK(doc != NULL);
+    CHECK_STRING(doc->returnType, "int");
+    CHECK_STRING(doc->moduleName, "math.c");
+    CHECK(doc->comment.paramCount == 1);
+    CHECK(ccdocFindSymbolsByPrefix(ctx, "ad", indices, 4) == 1);
+    CHECK(ccdocFindSymbols(ctx, "missing", indices, 4) == 0);
+    CHECK(ccdocSymbolAt(ctx, 2) == NULL);
+    ccdocDestroy(ctx);
+}
+
+/**
+ * Checks that contexts share no state.
+ */
+static void testIndependentContexts(void) {
+    ccdoc_context *first = ccdocCreate();
+    ccdoc_context *second = ccdocCreate();
+    CHECK(ccdocAddBuffer(first, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocSymbolCount(first) == 2);
+    CHECK(ccdocSymbolCount(second) == 0);
+    ccdocDestroy(first);
+
+    /* The same name can be added again to a fresh context */
+    CHECK(ccdocAddBuffer(second, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocSymbolCount(second) == 2);
+    ccdocDestroy(second);
+}
+
+/**
+ * Checks that disabled regions are skipped up to the directive that ends them, not up to a
+ * directive inside a comment, and that a region depending on an included header is parsed.
+ */
+static void testConditionals(void) {
+    char text[2048];
+    ccdoc_context *ctx = ccdocCreate();
+    snprintf(text, sizeof(text), "#if 0\n/*\n#endif\n*/\n%s#endif\n", SOURCE);
+    CHECK(ccdocAddBuffer(ctx, "hidden.c", text, strlen(text)));
+    CHECK(ccdocSymbolCount(ctx) == 0);
+
+    snprintf(text, sizeof(text), "#include \"config.h\"\n#if HAVE_MATH\n%s#endif\n", SOURCE);
+    CHECK(ccdocAddBuffer(ctx, "math.c", text, strlen(text)));
+    CHECK(ccdocSymbolCount(ctx) == 2);
+    ccdocDestroy(ctx);
+}
+
+/**
+ * Checks that the emitted document holds the documented functions.
+ */
+static void testEmit(void) {
+    static char text[16384];
+    ccdoc_context *ctx = ccdocCreate();
+    FILE *output = tmpfile();
+    CHECK(output != NULL);
+    CHECK(ccdocAddBuffer(ctx, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocEmit(ctx, output));
+    streamText(output, text, sizeof(text));
+    CHECK(strstr(text, "\\documentclass") != NULL);
+    CHECK(strstr(text, "int add(int a, int b)") != NULL);
+    CHECK(strstr(text, "Adds two numbers.") != NULL);
+    CHECK(strstr(text, "\\end{document}") != NULL);
+    fclose(output);
+    ccdocDestroy(ctx);
+}
+
+/**
+ * Checks that functions are emitted in source order unless another order is selected.
+ */
+static void testEmitOrder(void) {
+    static char text[16384];
+    static const char ZETA_FIRST[] =
+        "/**\n * @brief Last by name.\n */\nint zeta(void);\n"
+        "/**\n * @brief First by name.\n */\nint alpha(void);\n";
+    ccdoc_context *ctx = ccdocCreate();
+    FILE *output = tmpfile();
+    CHECK(ccdocAddBuffer(ctx, "order.c", ZETA_FIRST, strlen(ZETA_FIRST)));
+    CHECK(ccdocEmit(ctx, output));
+    streamText(output, text, sizeof(text));
+    CHECK(strstr(text, "zeta") != NULL && strstr(text, "alpha") != NULL && strstr(text, "zeta") < strstr(text, "alpha"));
+
+    ccdocSetOrder(ctx, ORDER_NAME);
+    rewind(output);
+    CHECK(ccdocEmit(ctx, output));
+    streamText(output, text, sizeof(text));
+    CHECK(strstr(text, "zeta") != NULL && strstr(text, "alpha") != NULL && strstr(text, "alpha") < strstr(text, "zeta"));
+    fclose(output);
+    ccdocDestroy(ctx);
+}
+
+/**
+ * Parses a file with or without prefetching and emits the document.
+ * @param filename Name of the file.
+ * @param prefetch true to warm the cache with the included files first.
+ * @param text Buffer receiving the document.
+ * @param size Size of the buffer.
+ * @return The number of symbols found.
+ */
+static int emitFile(const char *filename, bool prefetch, char *text, size_t size) {
+    ccdoc_context *ctx = ccdocCreate();
+    FILE *output = tmpfile();
+    ccdocSetPrefetch(ctx, prefetch);
+    ccdocAddFile(ctx, filename);
+    ccdocEmit(ctx, output);
+    streamText(output, text, size);
+    fclose(output);
+    int count = ccdocSymbolCount(ctx);
+    ccdocDestroy(ctx);
+    return count;
+}
+
+/**
+ * Checks that prefetching the included files does not change the document.
+ */
+static void testPrefetch(void) {
+    static char withPrefetch[16384];
+    static char withoutPrefetch[16384];
+    FILE *header = fopen("test_ccdoc_prefetch.h", "w");
+    FILE *source = fopen("test_ccdoc_prefetch.c", "w");
+    CHECK(header != NULL && source != NULL);
+    if (header == NULL || source == NULL) {
+        return;
+    }
+    fputs(SOURCE, header);
+    fclose(header);
+    fputs("#include \"test_ccdoc_prefetch.h\"\n"
+          "/**\n * @brief Doubles a number.\n * @param int value the number\n */\n"
+          "int twice(int value);\n", source);
+    fclose(source);
+
+    CHECK(emitFile("test_ccdoc_prefetch.c", true, withPrefetch, sizeof(withPrefetch)) == 3);
+    CHECK(emitFile("test_ccdoc_prefetch.c", false, withoutPrefetch, sizeof(withoutPrefetch)) == 3);
+    CHECK_STRING(withPrefetch, withoutPrefetch);
+    remove("test_ccdoc_prefetch.h");
+    remove("test_ccdoc_prefetch.c");
+}
+
+/**
+ * Adds a file to a new context attached to a cache.
+ * @param cache The shared cache.
+ * @param limits The limits of the context.
+ * @param filename Name of the file.
+ * @param statistics Pointer to the structure receiving the counters of the context.
+ * @return The number of symbols found.
+ */
+static int addCachedFile(ccdoc_cache *cache, const ResourceLimits *limits, const char *filename, RunStatistics *statistics) {
+    ccdoc_context *ctx = ccdocCreate();
+    ccdocSetCache(ctx, cache);
+    ccdocSetLimits(ctx, limits);
+    ccdocAddFile(ctx, filename);
+    ccdocStatistics(ctx, statistics);
+    int count = ccdocSymbolCount(ctx);
+    ccdocDestroy(ctx);
+    return count;
+}
+
+/**
+ * Checks that a shared cache neither hands results cut short by a limit to other contexts
+ * nor hands complete results to contexts with tighter limits.
+ */
+static void testCacheLimits(void) {
+    const char *filename = "test_ccdoc_cache.c";
+    FILE *file = fopen(filename, "w");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    fputs(SOURCE, file);
+    fclose(file);
+
+    ResourceLimits loose, tight;
+    defaultResourceLimits(&loose);
+    tight = loose;
+    tight.maxFileLines = 10;
+    RunStatistics statistics;
+    ccdoc_cache *cache = ccdocCacheCreate();
+
+    CHECK(addCachedFile(cache, &tight, filename, &statistics) == 1);
+    CHECK(statistics.limitHits[LIMIT_LINES] == 1);
+    CHECK(addCachedFile(cache, &loose, filename, &statistics) == 2);
+    CHECK(statistics.cacheHits == 0);
+
+    /* The truncated result was not stored, so the limit is reported again */
+    CHECK(addCachedFile(cache, &tight, filename, &statistics) == 1);
+    CHECK(statistics.limitHits[LIMIT_LINES] == 1);
+    CHECK(statistics.cacheHits == 0);
+
+    /* The complete result is shared with contexts using the same limits */
+    CHECK(addCachedFile(cache, &loose, filename, &statistics) == 2);
+    CHECK(statistics.cacheHits == 1);
+    ccdocCacheDestroy(cache);
+    remove(filename);
+}
+
+/**
+ * Checks the handling of invalid arguments.
+ */
+static void testInvalidArguments(void) {
+    CHECK(!ccdocAddBuffer(NULL, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocSymbolCount(NULL) == 0);
+    CHECK(!ccdocEmit(NULL, stdout));
+    ccdocDestroy(NULL);
+}
+
+int main(void) {
+    testAddBuffer();
+    testIndependentContexts();
+    testConditionals();
+    testEmit();
+    testEmitOrder();
+    testPrefetch();
+    testCacheLimits();
+    testInvalidArguments();
+    return testResult("test_ccdoc");
+}
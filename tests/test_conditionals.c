@@ -0,0 +1,184 @@
+/**
+ * Module test_conditionals.c
+ * This module contains the unit tests of the preprocessor conditionals declared in conditionals.h.
+ * Files are fed to processDirective line by line, the way the parser does it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "conditionals.h"
+#include "test.h"
+
+/**
+ * Runs the lines of a file through the conditional state and collects the live lines that are
+ * not directives. Every line is followed for block comments, as the parser does it.
+ * @param predefined Macros given with -D and -U, may be NULL.
+ * @param text The lines of the file.
+ * @return The names of the live lines, each followed by a space.
+ */
+static const char *liveLines(const ccdoc_macros *predefined, const char *text) {
+    static char result[1024];
+    ConditionalState state;
+    char line[256];
+    result[0] = '\0';
+    initConditionals(&state, predefined);
+
+    long lineNumber = 0;
+    while (*text != '\0') {
+        size_t length = strcspn(text, "\n");
+        snprintf(line, sizeof(line), "%.*s\n", (int)length, text);
+        text += length + (text[length] == '\n');
+        bool directive = processDirective(&state, line, "test.c", ++lineNumber);
+        trackComments(&state, line, strlen(line));
+        if (!directive && state.live) {
+            strncat(result, line, length);
+            strcat(result, " ");
+        }
+    }
+    finishConditionals(&state, "test.c", true);
+    return result;
+}
+
+/**
+ * Evaluates the condition of an #if directive.
+ * @param predefined Macros given with -D and -U, may be NULL.
+ * @param condition The condition.
+ * @return "yes" or "no" for the branch that is parsed, the live lines if both are.
+ */
+static const char *condition(const ccdoc_macros *predefined, const char *condition) {
+    char text[512];
+    snprintf(text, sizeof(text), "#if %s\nyes\n#else\nno\n#endif\n", condition);
+    const char *live = liveLines(predefined, text);
+    return strcmp(live, "yes ") == 0 ? "yes" : strcmp(live, "no ") == 0 ? "no" : live;
+}
+
+/**
+ * Checks the evaluation of expressions.
+ */
+static void testExpressions(void) {
+    CHECK_STRING(condition(NULL, "1"), "yes");
+    CHECK_STRING(condition(NULL, "0"), "no");
+    CHECK_STRING(condition(NULL, "1 + 2 * 3 == 7"), "yes");
+    CHECK_STRING(condition(NULL, "(1 + 2) * 3 == 7"), "no");
+    CHECK_STRING(condition(NULL, "0x10 > 15 && !0"), "yes");
+    CHECK_STRING(condition(NULL, "1 ? 0 : 1"), "no");
+    CHECK_STRING(condition(NULL, "-1 < 0 /* comment */"), "yes");
+    CHECK_STRING(condition(NULL, "'a' == 97 && '\\n' == 10"), "yes");
+    CHECK_STRING(condition(NULL, "0 && UNKNOWN"), "no");
+    CHECK_STRING(condition(NULL, "1 || CALL(1, 2)"), "yes");
+}
+
+/**
+ * Checks that malformed expressions are reported and parsed without reading past their end.
+ */
+static void testMalformed(void) {
+    CHECK_STRING(condition(NULL, "'"), "yes");
+    CHECK_STRING(condition(NULL, "'a"), "yes");
+    CHECK_STRING(condition(NULL, "(1"), "yes");
+    CHECK_STRING(condition(NULL, "1 +"), "yes");
+    CHECK_STRING(condition(NULL, "1 / 0"), "yes");
+    CHECK_STRING(condition(NULL, "defined("), "yes");
+    CHECK_STRING(condition(NULL, ""), "yes");
+
+    /* Only a predefined value can end right after the backslash of a character constant */
+    ccdoc_macros *macros = createMacros();
+    CHECK(applyMacroOption(macros, "QUOTE='\\", true));
+    CHECK_STRING(condition(macros, "QUOTE"), "yes");
+    destroyMacros(macros);
+}
+
+/**
+ * Checks predefined macros, #define and #undef.
+ */
+static void testMacros(void) {
+    ccdoc_macros *macros = createMacros();
+    CHECK(applyMacroOption(macros, "A", true));
+    CHECK(applyMacroOption(macros, "LEVEL=3", true));
+    CHECK(applyMacroOption(macros, "B", false));
+    CHECK(!applyMacroOption(macros, "1X", true));
+    CHECK_STRING(condition(macros, "defined(A) && !defined B"), "yes");
+    CHECK_STRING(condition(macros, "LEVEL >= 2 && A"), "yes");
+
+    CHECK_STRING(liveLines(macros, "#undef A\n#ifdef A\na\n#endif\n#ifndef A\nb\n#endif\n"), "b ");
+    CHECK_STRING(liveLines(macros, "#define TWICE (LEVEL * 2)\n#if TWICE == 6\nsix\n#endif\n"), "six ");
+    CHECK_STRING(liveLines(macros, "#define SELF SELF + 1\n#if SELF\nloop\n#endif\n"), "loop ");
+
+    /* Changes of one file are not seen by the next, the name is unknown there */
+    CHECK_STRING(condition(macros, "defined(TWICE)"), "yes no ");
+    destroyMacros(macros);
+}
+
+/**
+ * Checks nesting and the #elif and #else branches.
+ */
+static void testNesting(void) {
+    CHECK_STRING(liveLines(NULL, "#if 0\na\n#elif 1\nb\n#elif 1\nc\n#else\nd\n#endif\ne\n"), "b e ");
+    CHECK_STRING(liveLines(NULL, "#if 0\n#if 1\na\n#else\nb\n#endif\n#else\nc\n#endif\n"), "c ");
+    CHECK_STRING(liveLines(NULL, "#if 1\n#if 0\na\n#endif\nb\n#endif\n"), "b ");
+    CHECK_STRING(liveLines(NULL, "#endif\na\n"), "a ");
+    CHECK_STRING(liveLines(NULL, "#pragma once\n#include \"a.h\"\n"), "#pragma once #include \"a.h\" ");
+}
+
+/**
+ * Checks that continued directives are joined before they are run.
+ */
+static void testContinuation(void) {
+    CHECK_STRING(liveLines(NULL, "#if defined(A) && \\\n    0\nhidden\n#endif\nshown\n"), "shown ");
+    CHECK_STRING(liveLines(NULL, "#if 1 && \\\n    \\\n    2\nshown\n#endif\n"), "shown ");
+    CHECK_STRING(liveLines(NULL, "#define X \\\n    4\n#if X == 4\nfour\n#endif\n"), "four ");
+    CHECK_STRING(liveLines(NULL, "#if 0\n#define Y \\\n#endif\n#endif\nafter\n"), "after ");
+
+    /* A line ending with a backslash outside a directive is not joined */
+    CHECK_STRING(liveLines(NULL, "int x = \\\n1;\n"), "int x = \\ 1; ");
+}
+
+/**
+ * Checks that a condition depending on a name the file never saw parses its branches, since
+ * the name may be defined by an included header.
+ */
+static void testUnknownNames(void) {
+    CHECK_STRING(condition(NULL, "UNKNOWN"), "yes no ");
+    CHECK_STRING(condition(NULL, "!defined(UNKNOWN)"), "yes no ");
+    CHECK_STRING(condition(NULL, "CALL(1, 2) + 1"), "yes no ");
+    CHECK_STRING(condition(NULL, "UNKNOWN ? 1 : 0"), "yes no ");
+    CHECK_STRING(condition(NULL, "1 ? 1 : UNKNOWN"), "yes");
+    CHECK_STRING(liveLines(NULL, "#include \"config.h\"\n#if HAVE_FOO\nfoo\n#endif\n"), "#include \"config.h\" foo ");
+    CHECK_STRING(liveLines(NULL, "#ifndef GUARD\n#define GUARD\nbody\n#endif\n"), "body ");
+    CHECK_STRING(liveLines(NULL, "#define Y (X + 1)\n#if Y > 1\ny\n#endif\n"), "y ");
+
+    /* A branch whose condition is known to fail is still skipped, one known to hold ends the chain */
+    CHECK_STRING(liveLines(NULL, "#if UNKNOWN\na\n#elif 0\nb\n#elif 1\nc\n#else\nd\n#endif\n"), "a c ");
+
+    /* -U and #undef make a name known to be undefined */
+    ccdoc_macros *macros = createMacros();
+    CHECK(applyMacroOption(macros, "HAVE_FOO", false));
+    CHECK_STRING(condition(macros, "HAVE_FOO"), "no");
+    CHECK_STRING(condition(macros, "!defined(HAVE_FOO)"), "yes");
+    destroyMacros(macros);
+    CHECK_STRING(liveLines(NULL, "#undef X\n#ifdef X\nx\n#endif\n"), "");
+}
+
+/**
+ * Checks that a '#' inside a block comment does not start a directive.
+ */
+static void testComments(void) {
+    CHECK_STRING(liveLines(NULL, "/*\n#if 0\n*/\na\n"), "/* #if 0 */ a ");
+    CHECK_STRING(liveLines(NULL, "#if 0\n/*\n#endif\n*/\n#endif\nb\n"), "b ");
+    CHECK_STRING(liveLines(NULL, "#if 1 /* open\n#if 0\n*/\na\n#endif\n"), "#if 0 */ a ");
+    CHECK_STRING(liveLines(NULL, "/* one */ x\n#if 0\na\n#endif\n"), "/* one */ x ");
+
+    /* Comment markers in literals and after a line comment open nothing */
+    CHECK_STRING(liveLines(NULL, "s = \"/*\";\n#if 0\na\n#endif\n"), "s = \"/*\"; ");
+    CHECK_STRING(liveLines(NULL, "c = '\\'';\n// /*\n#if 0\na\n#endif\n"), "c = '\\''; // /* ");
+}
+
+int main(void) {
+    testExpressions();
+    testMalformed();
+    testMacros();
+    testNesting();
+    testContinuation();
+    testUnknownNames();
+    testComments();
+    return testResult("test_conditionals");
+}
@@ -0,0 +1,72 @@
+/**
+ * Module test_dependencies.c
+ * This module contains the unit tests of the dependency files declared in dependencies.h.
+ * The rules are compared with the text a compiler writes for -MD -MP -MF.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dependencies.h"
+#include "test.h"
+
+/**
+ * Writes a dependency rule into a buffer.
+ * @param target The file generated from the dependencies.
+ * @param dependencies Array of dependency file names.
+ * @param count Count of dependencies.
+ * @param phonyTargets true to add the empty rules of -MP.
+ * @return The rule, in a static buffer.
+ */
+static const char *rule(const char *target, const char (*dependencies)[256], int count, bool phonyTargets) {
+    static char text[4096];
+    FILE *stream = tmpfile();
+    writeDependencyRule(stream, target, dependencies, count, phonyTargets);
+    streamText(stream, text, sizeof(text));
+    fclose(stream);
+    return text;
+}
+
+/**
+ * Checks a rule with the empty rules of -MP.
+ */
+static void testRule(void) {
+    const char dependencies[3][256] = { "main.c", "util.h", "types.h" };
+    CHECK_STRING(rule("docs.tex", dependencies, 3, true),
+                 "docs.tex: \\\n main.c \\\n util.h \\\n types.h\n"
+                 "\nutil.h:\n"
+                 "\ntypes.h:\n");
+    CHECK_STRING(rule("docs.tex", dependencies, 1, true), "docs.tex: \\\n main.c\n");
+    CHECK_STRING(rule("docs.tex", dependencies, 0, false), "docs.tex:\n");
+}
+
+/**
+ * Checks that characters with a meaning in make are escaped in targets, dependencies and the
+ * empty rules.
+ */
+static void testEscaping(void) {
+    const char dependencies[3][256] = { "my file.c", "price$.h", "c:\\inc#1.h" };
+    CHECK_STRING(rule("out dir/doc.tex", dependencies, 3, true),
+                 "out\\ dir/doc.tex: \\\n my\\ file.c \\\n price$$.h \\\n c\\:\\\\inc\\#1.h\n"
+                 "\nprice$$.h:\n"
+                 "\nc\\:\\\\inc\\#1.h:\n");
+}
+
+/**
+ * Checks the name of the dependency file derived from the output file.
+ */
+static void testDefaultName(void) {
+    char name[256];
+    defaultDependencyFileName("docs/out.tex", name, sizeof(name));
+    CHECK_STRING(name, "docs/out.d");
+    defaultDependencyFileName("out", name, sizeof(name));
+    CHECK_STRING(name, "out.d");
+    defaultDependencyFileName("build.v2/out", name, sizeof(name));
+    CHECK_STRING(name, "build.v2/out.d");
+}
+
+int main(void) {
+    testRule();
+    testEscaping();
+    testDefaultName();
+    return testResult("test_dependencies");
+}
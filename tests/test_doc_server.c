@@ -0,0 +1,160 @@
+/**
+ * Module test_doc_server.c
+ * This module contains the unit tests of the documentation server declared in doc_server.h.
+ * The server runs in a child process and is queried over its socket like by any client.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ccdoc.h"
+#include "doc_server.h"
+#include "test.h"
+
+#ifdef _WIN32
+
+int main(void) {
+    ccdoc_context *ctx = ccdocCreate();
+    CHECK(!runDocServer(ctx, "ccdoc.sock"));
+    ccdocDestroy(ctx);
+    return testResult("test_doc_server");
+}
+
+#else
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/* Source code with two documented functions. */
+static const char SOURCE[] =
+    "/**\n"
+    " * @brief Adds two numbers.\n"
+    " * @param int a the first number\n"
+    " * @param int b the second number\n"
+    " * @return the sum of both\n"
+    " */\n"
+    "int add(int a, int b);\n"
+    "\n"
+    "/**\n"
+    " * @brief Adds one to a \"counter\".\n"
+    " * @param int value the number\n"
+    " */\n"
+    "int addOne(int value);\n";
+
+/**
+ * Connects to the server, waiting until it listens.
+ * @param socketPath The path of the socket.
+ * @return The connected socket, or -1 if the server does not answer.
+ */
+static int connectToServer(const char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath);
+    for (int attempt = 0; attempt < 500; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0) {
+            return fd;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        usleep(10000);
+    }
+    return -1;
+}
+
+/**
+ * Reads answer lines until the given count of lines has arrived.
+ * @param fd The connected socket.
+ * @param lines Number of lines to read.
+ * @param answer Buffer receiving the lines.
+ * @param size Size of the buffer.
+ * @return true if all lines arrived, false if the connection ended early.
+ */
+static bool readAnswers(int fd, int lines, char *answer, size_t size) {
+    size_t length = 0;
+    int seen = 0;
+    while (seen < lines && length + 1 < size) {
+        ssize_t received = read(fd, answer + length, size - 1 - length);
+        if (received <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < received; i++) {
+            seen += answer[length + i] == '\n';
+        }
+        length += (size_t)received;
+    }
+    answer[length] = '\0';
+    return seen == lines;
+}
+
+/**
+ * Checks that requests sent over the socket, one of them split over two writes, are answered
+ * in order, and that the server shuts down cleanly on SIGTERM.
+ */
+static void testRoundTrip(void) {
+    static char answer[65536];
+    char socketPath[64];
+    snprintf(socketPath, sizeof(socketPath), "/tmp/ccdoc_test_%ld.sock", (long)getpid());
+    unlink(socketPath);
+
+    ccdoc_context *ctx = ccdocCreate();
+    CHECK(ccdocAddBuffer(ctx, "math.c", SOURCE, strlen(SOURCE)));
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(runDocServer(ctx, socketPath) ? 0 : 1);
+    }
+    CHECK(child > 0);
+    if (child < 0) {
+        ccdocDestroy(ctx);
+        return;
+    }
+
+    int fd = connectToServer(socketPath);
+    CHECK(fd >= 0);
+    if (fd >= 0) {
+        static const char FIRST[] = "{\"op\":\"lookup\",\"name\":\"add\"}\n{\"op\":\"pre";
+        static const char SECOND[] = "fix\",\"prefix\":\"add\"}\n{\"op\":\"rename\"}\n";
+        CHECK(write(fd, FIRST, strlen(FIRST)) == (ssize_t)strlen(FIRST));
+        usleep(20000);
+        CHECK(write(fd, SECOND, strlen(SECOND)) == (ssize_t)strlen(SECOND));
+        CHECK(readAnswers(fd, 3, answer, sizeof(answer)));
+
+        char *second = strchr(answer, '\n');
+        char *third = second != NULL ? strchr(second + 1, '\n') : NULL;
+        CHECK(third != NULL);
+        if (third != NULL) {
+            *second++ = '\0';
+            *third++ = '\0';
+            third[strcspn(third, "\n")] = '\0';
+            static const char LOOKUP[] = "{\"ok\":true,\"symbols\":[{\"name\":\"add\",\"returnType\":\"int\"";
+            CHECK(strncmp(answer, LOOKUP, strlen(LOOKUP)) == 0);
+            CHECK(strstr(answer, "\"brief\":\"Adds two numbers.\"") != NULL);
+            CHECK(strstr(answer, "{\"name\":\"int b\",\"description\":\"the second number\"}") != NULL);
+            CHECK(strstr(answer, "addOne") == NULL);
+            CHECK(strstr(second, "\"name\":\"add\"") != NULL && strstr(second, "\"name\":\"addOne\"") != NULL);
+            CHECK(strstr(second, "Adds one to a \\\"counter\\\".") != NULL);
+            CHECK_STRING(third, "{\"ok\":false,\"error\":\"unknown op or missing argument\"}");
+        }
+        close(fd);
+    }
+
+    int status = 0;
+    kill(child, SIGTERM);
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(access(socketPath, F_OK) != 0);
+    ccdocDestroy(ctx);
+}
+
+int main(void) {
+    testRoundTrip();
+    return testResult("test_doc_server");
+}
+
+#endif
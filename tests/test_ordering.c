@@ -0,0 +1,172 @@
+/**
+ * Module test_ordering.c
+ * This module contains the unit tests of the ordering pass declared in ordering.h.
+ * The radix sort is compared with a plain qsort of the same functions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ordering.h"
+#include "utility.h"
+#include "test.h"
+
+/* Functions compared by the reference ordering. */
+static const FunctionDoc *referenceDocs;
+
+/* Order used by the reference ordering. */
+static OutputOrder referenceOrder;
+
+/**
+ * Fills in the module and name of a documented function.
+ * @param funcDoc The function to fill in.
+ * @param moduleName The file the function comes from.
+ * @param functionName The name as stored by the prototype parser.
+ */
+static void setFunction(FunctionDoc *funcDoc, const char *moduleName, const char *functionName) {
+    memset(funcDoc, 0, sizeof(FunctionDoc));
+    snprintf(funcDoc->moduleName, sizeof(funcDoc->moduleName), "%s", moduleName);
+    snprintf(funcDoc->functionName, sizeof(funcDoc->functionName), "%s", functionName);
+}
+
+/**
+ * Compares two function indices by module, then by name or source position, then by index,
+ * used with qsort.
+ * @param a Pointer to the first index.
+ * @param b Pointer to the second index.
+ * @return Negative, zero or positive value as with strcmp.
+ */
+static int compareReference(const void *a, const void *b) {
+    int left = *(const int *)a;
+    int right = *(const int *)b;
+    char leftModule[256], rightModule[256];
+    moduleNameOfFile(referenceDocs[left].moduleName, leftModule, sizeof(leftModule));
+    moduleNameOfFile(referenceDocs[right].moduleName, rightModule, sizeof(rightModule));
+    int result = strcmp(leftModule, rightModule);
+    if (result == 0 && referenceOrder == ORDER_NAME) {
+        const char *leftName = referenceDocs[left].functionName + strspn(referenceDocs[left].functionName, "* ");
+        const char *rightName = referenceDocs[right].functionName + strspn(referenceDocs[right].functionName, "* ");
+        result = strcmp(leftName, rightName);
+    }
+    return result != 0 ? result : left - right;
+}
+
+/**
+ * Orders functions with orderFunctions and checks the result against the reference ordering.
+ * @param functionDocs The functions.
+ * @param count Count of functions.
+ * @param order The order.
+ * @return true if both orderings agree, false otherwise.
+ */
+static bool matchesReference(const FunctionDoc *functionDocs, int count, OutputOrder order) {
+    int *indices = malloc(count * sizeof(int));
+    int *expected = malloc(count * sizeof(int));
+    bool matches = indices != NULL && expected != NULL && orderFunctions(functionDocs, count, order, indices);
+    if (matches) {
+        for (int i = 0; i < count; i++) {
+            expected[i] = i;
+        }
+        referenceDocs = functionDocs;
+        referenceOrder = order;
+        qsort(expected, count, sizeof(int), compareReference);
+        matches = memcmp(indices, expected, count * sizeof(int)) == 0;
+    }
+    free(indices);
+    free(expected);
+    return matches;
+}
+
+/**
+ * Checks the parsing of order names, including invalid ones.
+ */
+static void testParseOutputOrder(void) {
+    OutputOrder order = ORDER_INCLUDE;
+    CHECK(parseOutputOrder("name", &order) && order == ORDER_NAME);
+    CHECK(parseOutputOrder("source", &order) && order == ORDER_SOURCE);
+    CHECK(parseOutputOrder("include", &order) && order == ORDER_INCLUDE);
+    CHECK(!parseOutputOrder("", &order));
+    CHECK(!parseOutputOrder("Name", &order));
+    CHECK(!parseOutputOrder("names", &order));
+    CHECK(order == ORDER_INCLUDE);
+}
+
+/**
+ * Checks the three orders on a small set of functions spread over modules.
+ */
+static void testSmallSet(void) {
+    FunctionDoc *docs = calloc(6, sizeof(FunctionDoc));
+    int indices[6];
+    setFunction(&docs[0], "b.c", "zeta");
+    setFunction(&docs[1], "a.h", "parseValueB");
+    setFunction(&docs[2], "b.c", "alpha");
+    setFunction(&docs[3], "a.c", "*parseValueA");
+    setFunction(&docs[4], "a.c", "make");
+    setFunction(&docs[5], "a.h", "make");
+
+    /* a.h and a.c form one module; equal names keep their source order */
+    CHECK(orderFunctions(docs, 6, ORDER_NAME, indices));
+    CHECK(indices[0] == 4 && indices[1] == 5 && indices[2] == 3 && indices[3] == 1 && indices[4] == 2 && indices[5] == 0);
+
+    CHECK(orderFunctions(docs, 6, ORDER_SOURCE, indices));
+    CHECK(indices[0] == 1 && indices[1] == 3 && indices[2] == 4 && indices[3] == 5 && indices[4] == 0 && indices[5] == 2);
+
+    CHECK(orderFunctions(docs, 6, ORDER_INCLUDE, indices));
+    CHECK(indices[0] == 0 && indices[1] == 1 && indices[2] == 2 && indices[3] == 3 && indices[4] == 4 && indices[5] == 5);
+    free(docs);
+}
+
+/**
+ * Checks the degenerate inputs: no function, one function and names shorter than a key.
+ */
+static void testDegenerate(void) {
+    FunctionDoc *docs = calloc(3, sizeof(FunctionDoc));
+    int indices[3] = { -1, -1, -1 };
+    CHECK(orderFunctions(docs, 0, ORDER_NAME, indices));
+    CHECK(indices[0] == -1);
+
+    setFunction(&docs[0], "a.c", "only");
+    CHECK(orderFunctions(docs, 1, ORDER_NAME, indices));
+    CHECK(indices[0] == 0);
+
+    /* Empty names and names that are a prefix of another */
+    setFunction(&docs[0], "a.c", "ab");
+    setFunction(&docs[1], "a.c", "");
+    setFunction(&docs[2], "a.c", "a");
+    CHECK(orderFunctions(docs, 3, ORDER_NAME, indices));
+    CHECK(indices[0] == 1 && indices[1] == 2 && indices[2] == 0);
+    free(docs);
+}
+
+/**
+ * Checks many functions against the reference ordering, with more than 256 modules so that
+ * the upper digits of the module identifiers are sorted, and with long shared name prefixes.
+ */
+static void testAgainstReference(void) {
+    int count = 600;
+    FunctionDoc *docs = calloc(count, sizeof(FunctionDoc));
+    srand(7);
+    for (int i = 0; i < count; i++) {
+        char moduleName[32], functionName[32];
+        snprintf(moduleName, sizeof(moduleName), "m%03d.%c", rand() % 300, rand() % 2 ? 'c' : 'h');
+        snprintf(functionName, sizeof(functionName), "%sprocessItem%c%c", rand() % 4 ? "" : "*", 'a' + rand() % 3, 'a' + rand() % 3);
+        setFunction(&docs[i], moduleName, functionName);
+    }
+    CHECK(matchesReference(docs, count, ORDER_NAME));
+    CHECK(matchesReference(docs, count, ORDER_SOURCE));
+
+    /* All functions in one module, so only the key digits differ */
+    for (int i = 0; i < count; i++) {
+        snprintf(docs[i].moduleName, sizeof(docs[i].moduleName), "single.c");
+    }
+    CHECK(matchesReference(docs, count, ORDER_NAME));
+    CHECK(matchesReference(docs, count, ORDER_SOURCE));
+    free(docs);
+}
+
+int main(void) {
+    testParseOutputOrder();
+    testSmallSet();
+    testDegenerate();
+    testAgainstReference();
+    return testResult("test_ordering");
+}
@@ -0,0 +1,132 @@
+/**
+ * Module test_output_template.c
+ * This module contains the unit tests of the output templates declared in output_template.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "output_template.h"
+#include "test.h"
+
+/**
+ * Compiles a template from a string.
+ * @param text The template text.
+ * @return The compiled template, or NULL if it is invalid.
+ */
+static ccdoc_template *compile(const char *text) {
+    return compileTemplate(text, strlen(text), "test");
+}
+
+/**
+ * Renders one section of a template into a static buffer.
+ * @param outputTemplate The compiled template.
+ * @param section The section to write.
+ * @param values Values of the fields, may be NULL.
+ * @return The rendered text.
+ */
+static const char *render(const ccdoc_template *outputTemplate, TemplateSection section, const TemplateValues *values) {
+    static char buffer[4096];
+    FILE *output = tmpfile();
+    renderTemplateSection(outputTemplate, section, values, output);
+    streamText(output, buffer, sizeof(buffer));
+    fclose(output);
+    return buffer;
+}
+
+/**
+ * Compiles a template holding only a function section and renders it for a function.
+ * @param body The function section without its marker.
+ * @param comment Comment holding the parameters, may be NULL.
+ * @return The rendered text, or "(invalid)" if the template does not compile.
+ */
+static const char *renderFunction(const char *body, const DocComment *comment) {
+    static char text[1024];
+    snprintf(text, sizeof(text), "{{@function}}\n%s", body);
+    ccdoc_template *outputTemplate = compile(text);
+    if (outputTemplate == NULL) {
+        return "(invalid)";
+    }
+    TemplateValues values;
+    memset(&values, 0, sizeof(values));
+    values.fields[FIELD_NAME] = "add_one";
+    values.fields[FIELD_BRIEF] = "";
+    values.comment = comment;
+    const char *result = render(outputTemplate, TEMPLATE_FUNCTION, &values);
+    destroyTemplate(outputTemplate);
+    return result;
+}
+
+/**
+ * Checks fields, conditions, comments and sections.
+ */
+static void testFields(void) {
+    CHECK_STRING(renderFunction("{{name}}", NULL), "add\\_one");
+    CHECK_STRING(renderFunction("{{&name}}", NULL), "add_one");
+    CHECK_STRING(renderFunction("{{ name }}", NULL), "add\\_one");
+    CHECK_STRING(renderFunction("{{?brief}}b{{/brief}}{{^brief}}n{{/brief}}", NULL), "n");
+    CHECK_STRING(renderFunction("a{{! ignored }}b", NULL), "ab");
+
+    ccdoc_template *outputTemplate = compile("{{@begin}}\nstart\n{{@end}}\nstop\n");
+    CHECK(outputTemplate != NULL);
+    if (outputTemplate != NULL) {
+        CHECK_STRING(render(outputTemplate, TEMPLATE_BEGIN, NULL), "start\n");
+        CHECK_STRING(render(outputTemplate, TEMPLATE_END, NULL), "stop\n");
+        CHECK_STRING(render(outputTemplate, TEMPLATE_FUNCTION, NULL), "");
+        destroyTemplate(outputTemplate);
+    }
+}
+
+/**
+ * Checks the parameter loop.
+ */
+static void testParams(void) {
+    DocComment comment;
+    memset(&comment, 0, sizeof(comment));
+    strcpy(comment.paramName[0], "a");
+    strcpy(comment.paramDesc[0], "first");
+    strcpy(comment.paramName[1], "b");
+    strcpy(comment.paramDesc[1], "second");
+    comment.paramCount = 2;
+    CHECK_STRING(renderFunction("{{#params}}{{paramName}}={{paramDesc}}{{^last}}, {{/last}}{{/params}}", &comment),
+                 "a=first, b=second");
+    CHECK_STRING(renderFunction("{{?params}}has{{/params}}", &comment), "has");
+    CHECK_STRING(renderFunction("{{^params}}none{{/params}}", NULL), "none");
+}
+
+/**
+ * Checks that runs of braces and braces around LaTeX are handled as text.
+ */
+static void testBraces(void) {
+    CHECK_STRING(renderFunction("\\texttt{{{name}}}", NULL), "\\texttt{add\\_one}");
+    CHECK_STRING(renderFunction("{{{{name}}}}", NULL), "{{add\\_one}}");
+    CHECK_STRING(renderFunction("\\newcommand{\\x}{{\\bf x}}", NULL), "\\newcommand{\\x}{{\\bf x}}");
+    CHECK_STRING(renderFunction("{{\\bf {{name}}}}", NULL), "{{\\bf add\\_one}}");
+    CHECK_STRING(renderFunction("{{}} {{ }} {{\\bf", NULL), "{{}} {{ }} {{\\bf");
+    CHECK_STRING(renderFunction("{{{\\bf x}}}", NULL), "{{{\\bf x}}}");
+}
+
+/**
+ * Checks the rejection of invalid templates.
+ */
+static void testInvalid(void) {
+    CHECK_STRING(renderFunction("{{nmae}}", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{name", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{! comment", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{?brief}}open", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{?brief}}x{{/name}}", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{paramName}}", NULL), "(invalid)");
+    CHECK_STRING(renderFunction("{{#brief}}x{{/brief}}", NULL), "(invalid)");
+    CHECK(compile("text {{@function}}\n") == NULL);
+    CHECK(compile("{{\\bf x}}{{@function}}\n") == NULL);
+    CHECK(compile("{{@function}}\n{{@function}}\n") == NULL);
+    CHECK(compile("{{@chapter}}\n") == NULL);
+    CHECK(compile("") == NULL);
+}
+
+int main(void) {
+    testFields();
+    testParams();
+    testBraces();
+    testInvalid();
+    return testResult("test_output_template");
+}
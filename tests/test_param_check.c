@@ -0,0 +1,174 @@
+/**
+ * Module test_param_check.c
+ * This module contains the unit tests of the parameter check declared in param_check.h.
+ * The documented functions are parsed from buffers, so the names recorded by the parse pass
+ * are checked together with the check itself.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ccdoc.h"
+#include "param_check.h"
+#include "test.h"
+
+/**
+ * Extracts the parameter names of a declarator into a static buffer.
+ * @param declarator The declarator.
+ * @return The names separated by single spaces, or "-" if the declarator has no parameter list.
+ */
+static const char *names(const char *declarator) {
+    static char buffer[256];
+    if (extractParameterNames(declarator, buffer, sizeof(buffer)) < 0) {
+        return "-";
+    }
+    return buffer;
+}
+
+/**
+ * Parses a buffer and runs the check on it.
+ * @param source The source code.
+ * @param report Buffer receiving the report.
+ * @param size Size of the buffer.
+ * @return The number of reported problems.
+ */
+static int checkSource(const char *source, char *report, size_t size) {
+    ccdoc_context *ctx = ccdocCreate();
+    FILE *reportFile = tmpfile();
+    ccdocAddBuffer(ctx, "p.c", source, strlen(source));
+    int problems = ccdocCheckParams(ctx, reportFile);
+    streamText(reportFile, report, size);
+    fclose(reportFile);
+    ccdocDestroy(ctx);
+    return problems;
+}
+
+/**
+ * Checks the extraction of parameter names from declarators.
+ */
+static void testExtractParameterNames(void) {
+    CHECK_STRING(names("add(int a, int b);"), "a b");
+    CHECK_STRING(names("f(void);"), "");
+    CHECK_STRING(names("f();"), "");
+    CHECK_STRING(names("log(const char *format, ...);"), "format");
+    CHECK_STRING(names("sort(int values[], size_t count, int (*compare)(const void *, const void *));"), "values count compare");
+    CHECK_STRING(names("f(struct tag, struct tag *p, enum color c);"), "p c");
+    CHECK_STRING(names("f(unsigned long, char **argv);"), "argv");
+    CHECK_STRING(names("noParameters;"), "-");
+
+    /* Unnamed parameters of typedef'd types */
+    CHECK_STRING(names("take(const Foo *, size_t);"), "");
+    CHECK_STRING(names("take(const Foo, Foo *, Foo);"), "");
+    CHECK_STRING(names("take(const Foo *const p, Foo *q, const Foo * const);"), "p q");
+    CHECK_STRING(names("take(Foo value);"), "value");
+}
+
+/**
+ * Checks that entries with a one-word description are checked like any other.
+ */
+static void testShortDescriptions(void) {
+    char report[4096];
+    int problems = checkSource(
+        "/**\n"
+        " * Adds.\n"
+        " * @param a first\n"
+        " * @param b the second value\n"
+        " * @param c bogus\n"
+        " */\n"
+        "int add(int a, int b);\n", report, sizeof(report));
+    CHECK(problems == 1);
+    CHECK(strstr(report, "@param c of add does not name a parameter") != NULL);
+    CHECK(strstr(report, "is not documented") == NULL);
+
+    /* An entry without any description still documents its parameter */
+    problems = checkSource(
+        "/**\n"
+        " * Negates.\n"
+        " * @param value\n"
+        " */\n"
+        "int negate(int value);\n", report, sizeof(report));
+    CHECK(problems == 0);
+}
+
+/**
+ * Checks that unnamed parameters are not reported as undocumented.
+ */
+static void testUnnamedParameters(void) {
+    char report[4096];
+    int problems = checkSource(
+        "/**\n"
+        " * Takes.\n"
+        " * @param size the number of bytes\n"
+        " */\n"
+        "void take(const Foo *, size_t size);\n", report, sizeof(report));
+    CHECK(problems == 0);
+    CHECK_STRING(report, "");
+}
+
+/**
+ * Checks the reports of missing, extra and misordered entries.
+ */
+static void testProblems(void) {
+    char report[4096];
+    int problems = checkSource(
+        "/**\n"
+        " * Copies.\n"
+        " * @param const char *source the text to copy\n"
+        " * @param destination the buffer receiving the text\n"
+        " * @param extra a parameter that does not exist\n"
+        " */\n"
+        "void copy(char *destination, const char *source, size_t size);\n", report, sizeof(report));
+    CHECK(problems == 3);
+    CHECK(strstr(report, "@param extra of copy does not name a parameter") != NULL);
+    CHECK(strstr(report, "parameter size of copy is not documented") != NULL);
+    CHECK(strstr(report, "@param entries of copy are not in prototype order (destination source size)") != NULL);
+
+    /* A repeated entry is reported, also when it names the parameter after its type */
+    problems = checkSource(
+        "/**\n"
+        " * Scales.\n"
+        " * @param int factor the factor\n"
+        " * @param factor the factor again\n"
+        " */\n"
+        "int scale(int factor);\n", report, sizeof(report));
+    CHECK(problems == 1);
+    CHECK(strstr(report, "@param factor of scale is documented more than once") != NULL);
+}
+
+/**
+ * Checks that the second word of an entry is only taken for the name after a type, so a
+ * misspelled name followed by a word of its description is reported.
+ */
+static void testMisspelledNames(void) {
+    char report[4096];
+    int problems = checkSource(
+        "/**\n"
+        " * Copies.\n"
+        " * @param dst destination buffer\n"
+        " * @param srcc src buffer to read\n"
+        " * @param n number of bytes\n"
+        " */\n"
+        "void copy(char *dst, const char *src, int n);\n", report, sizeof(report));
+    CHECK(problems == 2);
+    CHECK(strstr(report, "@param srcc of copy does not name a parameter") != NULL);
+    CHECK(strstr(report, "parameter src of copy is not documented") != NULL);
+
+    /* After a type word or a pointer the second word is the name */
+    problems = checkSource(
+        "/**\n"
+        " * Copies.\n"
+        " * @param char *dst destination buffer\n"
+        " * @param const char *src source buffer\n"
+        " * @param int n number of bytes\n"
+        " */\n"
+        "void copy(char *dst, const char *src, int n);\n", report, sizeof(report));
+    CHECK(problems == 0);
+}
+
+int main(void) {
+    testExtractParameterNames();
+    testShortDescriptions();
+    testUnnamedParameters();
+    testProblems();
+    testMisspelledNames();
+    return testResult("test_param_check");
+}
@@ -0,0 +1,110 @@
+/**
+ * Module test_parse_cache.c
+ * This module contains the unit tests of the shared parse cache declared in parse_cache.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "parse_cache.h"
+#include "test.h"
+
+/**
+ * @struct Lookup
+ * @brief A lookup made by a second thread.
+ */
+typedef struct {
+    ccdoc_cache *cache;               /* The shared cache. */
+    const ParsedFile *result;         /* Result of the lookup. */
+} Lookup;
+
+/**
+ * Body of the second thread: looks up the file the main thread is parsing.
+ * @param argument Pointer to the Lookup structure.
+ * @return Always NULL.
+ */
+static void *lookUp(void *argument) {
+    Lookup *lookup = argument;
+    lookup->result = findParsedFile(lookup->cache, "/src/a.h", 42, 100);
+    return NULL;
+}
+
+/**
+ * Checks that a file is parsed once and then answered from the cache.
+ */
+static void testStore(void) {
+    ccdoc_cache *cache = createParseCache();
+    ParsedFile parsed;
+    initParsedFile(&parsed);
+    CHECK(appendParsedInclude(&parsed, "b.h"));
+
+    CHECK(findParsedFile(cache, "/src/a.h", 42, 100) == NULL);
+    const ParsedFile *stored = storeParsedFile(cache, "/src/a.h", 42, 100, &parsed);
+    CHECK(stored != NULL && stored->includeCount == 1);
+    CHECK(parsed.includeCount == 0);
+    CHECK(findParsedFile(cache, "/src/a.h", 42, 100) == stored);
+
+    /* Another version or another path is a different file */
+    CHECK(findParsedFile(cache, "/src/a.h", 43, 100) == NULL);
+    CHECK(findParsedFile(cache, "/src/b.h", 42, 100) == NULL);
+    abandonParsedFile(cache, "/src/a.h", 43, 100);
+    abandonParsedFile(cache, "/src/b.h", 42, 100);
+
+    long hits, misses;
+    parseCacheStatistics(cache, &hits, &misses);
+    CHECK(hits == 1 && misses == 3);
+    destroyParseCache(cache);
+}
+
+/**
+ * Checks that a thread looking up a file being parsed waits for its result.
+ */
+static void testWaitForParse(void) {
+    ccdoc_cache *cache = createParseCache();
+    CHECK(findParsedFile(cache, "/src/a.h", 42, 100) == NULL);
+
+    Lookup lookup = { cache, NULL };
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, lookUp, &lookup) == 0);
+
+    ParsedFile parsed;
+    initParsedFile(&parsed);
+    CHECK(appendParsedInclude(&parsed, "b.h"));
+    const ParsedFile *stored = storeParsedFile(cache, "/src/a.h", 42, 100, &parsed);
+    pthread_join(thread, NULL);
+    CHECK(stored != NULL && lookup.result == stored);
+
+    long hits, misses;
+    parseCacheStatistics(cache, &hits, &misses);
+    CHECK(hits == 1 && misses == 1);
+    destroyParseCache(cache);
+}
+
+/**
+ * Checks that an abandoned parse hands the file to the next thread looking it up.
+ */
+static void testAbandon(void) {
+    ccdoc_cache *cache = createParseCache();
+    CHECK(findParsedFile(cache, "/src/a.h", 42, 100) == NULL);
+
+    Lookup lookup = { cache, (const ParsedFile *)&lookup };
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, lookUp, &lookup) == 0);
+    abandonParsedFile(cache, "/src/a.h", 42, 100);
+    pthread_join(thread, NULL);
+    CHECK(lookup.result == NULL);
+
+    /* The second thread parses the file now, so a third lookup would wait for it */
+    ParsedFile parsed;
+    initParsedFile(&parsed);
+    const ParsedFile *stored = storeParsedFile(cache, "/src/a.h", 42, 100, &parsed);
+    CHECK(stored != NULL && findParsedFile(cache, "/src/a.h", 42, 100) == stored);
+    destroyParseCache(cache);
+}
+
+int main(void) {
+    testStore();
+    testWaitForParse();
+    testAbandon();
+    return testResult("test_parse_cache");
+}
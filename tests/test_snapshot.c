@@ -0,0 +1,281 @@
+/**
+ * Module test_snapshot.c
+ * This module contains the unit tests of the snapshots declared in snapshot.h and of their
+ * comparison declared in api_diff.h. Snapshots are written to temporary files and, for the
+ * malformed cases, patched byte by byte before they are read back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "api_diff.h"
+#include "test.h"
+
+/* Size of the header of a snapshot file. */
+#define HEADER_SIZE 20
+
+/* Size of one record of a snapshot file. */
+#define RECORD_SIZE 52
+
+/**
+ * Fills in a documented function.
+ * @param funcDoc The function to fill in.
+ * @param moduleName The file the function comes from.
+ * @param returnType The return type.
+ * @param functionName The name as stored by the prototype parser.
+ * @param param Documented parameter as "name description", or NULL for none.
+ * @param returnVal Documented return value.
+ */
+static void setFunction(FunctionDoc *funcDoc, const char *moduleName, const char *returnType, const char *functionName,
+                        const char *param, const char *returnVal) {
+    memset(funcDoc, 0, sizeof(FunctionDoc));
+    snprintf(funcDoc->moduleName, sizeof(funcDoc->moduleName), "%s", moduleName);
+    snprintf(funcDoc->returnType, sizeof(funcDoc->returnType), "%s", returnType);
+    snprintf(funcDoc->functionName, sizeof(funcDoc->functionName), "%s", functionName);
+    snprintf(funcDoc->comment.returnVal, sizeof(funcDoc->comment.returnVal), "%s", returnVal);
+    if (param != NULL) {
+        sscanf(param, "%255s %1023[^\n]", funcDoc->comment.paramName[0], funcDoc->comment.paramDesc[0]);
+        funcDoc->comment.paramCount = 1;
+    }
+}
+
+/**
+ * Writes functions as a snapshot into a buffer.
+ * @param functionDocs The functions, written in array order.
+ * @param count Count of functions.
+ * @param buffer Buffer receiving the snapshot.
+ * @param size Size of the buffer.
+ * @return Number of bytes of the snapshot, or 0 if it could not be written.
+ */
+static size_t snapshotBytes(const FunctionDoc *functionDocs, int count, unsigned char *buffer, size_t size) {
+    int indices[8];
+    for (int i = 0; i < count; i++) {
+        indices[i] = i;
+    }
+    FILE *file = tmpfile();
+    size_t length = 0;
+    if (writeSnapshot(file, functionDocs, indices, count)) {
+        rewind(file);
+        length = fread(buffer, 1, size, file);
+    }
+    fclose(file);
+    return length;
+}
+
+/**
+ * Reads a snapshot from a buffer.
+ * @param bytes The content of the snapshot file.
+ * @param length Number of bytes.
+ * @return The snapshot, or NULL if it is rejected.
+ */
+static ccdoc_snapshot *loadBytes(const unsigned char *bytes, size_t length) {
+    FILE *file = tmpfile();
+    fwrite(bytes, 1, length, file);
+    rewind(file);
+    ccdoc_snapshot *snapshot = readSnapshot(file, "test");
+    fclose(file);
+    return snapshot;
+}
+
+/**
+ * Stores a 32-bit little-endian integer into a snapshot image.
+ * @param out Pointer to the 4 bytes to overwrite.
+ * @param value The value.
+ */
+static void patchUint32(unsigned char *out, unsigned long value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/**
+ * Compares two snapshots into a buffer.
+ * @param oldSnapshot The old snapshot.
+ * @param newSnapshot The new snapshot.
+ * @param format Format of the report.
+ * @param report Buffer receiving the report.
+ * @param size Size of the buffer.
+ * @return The report.
+ */
+static const char *diffText(const ccdoc_snapshot *oldSnapshot, const ccdoc_snapshot *newSnapshot, DiffFormat format,
+                            char *report, size_t size) {
+    FILE *file = tmpfile();
+    CHECK(diffSnapshots(oldSnapshot, newSnapshot, format, file));
+    streamText(file, report, size);
+    fclose(file);
+    return report;
+}
+
+/**
+ * Checks that functions survive the round trip through a snapshot file.
+ */
+static void testRoundTrip(void) {
+    FunctionDoc *docs = calloc(3, sizeof(FunctionDoc));
+    unsigned char bytes[4096];
+    setFunction(&docs[0], "list.h", "int", "listLength(const List *list);", "list The list.", "The length.");
+    setFunction(&docs[1], "list.c", "List", "*listCreate(void);", NULL, "");
+    setFunction(&docs[2], "tree.c", "void", "treeFree(Tree *tree);", "tree The tree.", "");
+
+    size_t length = snapshotBytes(docs, 3, bytes, sizeof(bytes));
+    CHECK(length > HEADER_SIZE + 3 * RECORD_SIZE);
+    ccdoc_snapshot *snapshot = loadBytes(bytes, length);
+    CHECK(snapshot != NULL);
+    if (snapshot != NULL) {
+        CHECK(snapshotSymbolCount(snapshot) == 3);
+        const SnapshotSymbol *symbol = snapshotSymbolAt(snapshot, 0);
+        CHECK_STRING(symbol->module, "list.c");
+        CHECK_STRING(symbol->identifier, "listLength");
+        CHECK_STRING(symbol->prototype, "int listLength(const List *list);");
+        CHECK_STRING(symbol->params, "list: The list.");
+        CHECK_STRING(symbol->returnText, "The length.");
+
+        /* Pointer declarators are not part of the identifier; the header shares its module */
+        symbol = snapshotSymbolAt(snapshot, 1);
+        CHECK_STRING(symbol->identifier, "listCreate");
+        CHECK_STRING(symbol->params, "");
+        CHECK(snapshotSymbolAt(snapshot, 0)->keyHash != symbol->keyHash);
+        CHECK(snapshotSymbolAt(snapshot, 3) == NULL);
+        CHECK(snapshotSymbolAt(snapshot, -1) == NULL);
+    }
+    destroySnapshot(snapshot);
+
+    /* An empty run gives an empty snapshot */
+    length = snapshotBytes(docs, 0, bytes, sizeof(bytes));
+    CHECK(length == HEADER_SIZE);
+    snapshot = loadBytes(bytes, length);
+    CHECK(snapshot != NULL && snapshotSymbolCount(snapshot) == 0);
+    destroySnapshot(snapshot);
+    free(docs);
+}
+
+/**
+ * Checks that malformed snapshot files are rejected.
+ */
+static void testMalformed(void) {
+    FunctionDoc *docs = calloc(2, sizeof(FunctionDoc));
+    unsigned char bytes[4096];
+    unsigned char patched[4096];
+    setFunction(&docs[0], "a.c", "int", "f(int x);", "x The value.", "The result.");
+    setFunction(&docs[1], "a.c", "void", "g(void);", NULL, "");
+    size_t length = snapshotBytes(docs, 2, bytes, sizeof(bytes));
+    size_t stringsStart = HEADER_SIZE + 2 * RECORD_SIZE;
+
+    CHECK(loadBytes(bytes, 0) == NULL);
+    CHECK(loadBytes(bytes, HEADER_SIZE - 1) == NULL);
+
+    /* Each truncation point, up to the final null character of the string table */
+    CHECK(loadBytes(bytes, HEADER_SIZE + RECORD_SIZE) == NULL);
+    CHECK(loadBytes(bytes, stringsStart) == NULL);
+    CHECK(loadBytes(bytes, length - 1) == NULL);
+
+    memcpy(patched, bytes, length);
+    patched[0] = 'X';
+    CHECK(loadBytes(patched, length) == NULL);
+
+    memcpy(patched, bytes, length);
+    patchUint32(patched + 8, 2);
+    CHECK(loadBytes(patched, length) == NULL);
+
+    /* Counts far beyond the size of the file */
+    memcpy(patched, bytes, length);
+    patchUint32(patched + 12, 0x7FFFFFFFUL);
+    CHECK(loadBytes(patched, length) == NULL);
+    memcpy(patched, bytes, length);
+    patchUint32(patched + 12, 1000000);
+    CHECK(loadBytes(patched, length) == NULL);
+    memcpy(patched, bytes, length);
+    patchUint32(patched + 16, 0xFFFFFFFFUL);
+    CHECK(loadBytes(patched, length) == NULL);
+
+    /* A string offset outside the string table */
+    memcpy(patched, bytes, length);
+    patchUint32(patched + HEADER_SIZE + 32, (unsigned long)(length - stringsStart));
+    CHECK(loadBytes(patched, length) == NULL);
+
+    /* A string table that does not end with a null character */
+    memcpy(patched, bytes, length);
+    patched[length - 1] = 'x';
+    CHECK(loadBytes(patched, length) == NULL);
+
+    /* No functions, but a string table without its terminator */
+    memcpy(patched, bytes, HEADER_SIZE);
+    patchUint32(patched + 12, 0);
+    patchUint32(patched + 16, 1);
+    patched[HEADER_SIZE] = 'x';
+    CHECK(loadBytes(patched, HEADER_SIZE + 1) == NULL);
+    free(docs);
+}
+
+/**
+ * Checks the comparison of two snapshots and the report formats.
+ */
+static void testDiff(void) {
+    FunctionDoc *docs = calloc(8, sizeof(FunctionDoc));
+    unsigned char bytes[4096];
+    char report[8192];
+
+    setFunction(&docs[0], "a.c", "int", "same(int x);", "x The value.", "The result.");
+    setFunction(&docs[1], "a.c", "int", "retyped(int x);", "x The value.", "");
+    setFunction(&docs[2], "a.c", "void", "gone(void);", NULL, "");
+    setFunction(&docs[3], "a.h", "void", "redocumented(int x);", "x Old text.", "Nothing.");
+    ccdoc_snapshot *oldSnapshot = loadBytes(bytes, snapshotBytes(docs, 4, bytes, sizeof(bytes)));
+
+    setFunction(&docs[0], "a.c", "void", "added(\"quoted\");", NULL, "");
+    setFunction(&docs[1], "a.c", "long", "retyped(int x);", "x The value.", "");
+    setFunction(&docs[2], "a.c", "int", "same(int x);", "x The value.", "The result.");
+    setFunction(&docs[3], "a.c", "void", "redocumented(int x);", "x New text.", "Still nothing.");
+    ccdoc_snapshot *newSnapshot = loadBytes(bytes, snapshotBytes(docs, 4, bytes, sizeof(bytes)));
+    CHECK(oldSnapshot != NULL && newSnapshot != NULL);
+    if (oldSnapshot == NULL || newSnapshot == NULL) {
+        destroySnapshot(oldSnapshot);
+        destroySnapshot(newSnapshot);
+        free(docs);
+        return;
+    }
+
+    diffText(oldSnapshot, newSnapshot, DIFF_JSON, report, sizeof(report));
+    CHECK(strstr(report, "\"added\":[\n    {\"module\":\"a.c\",\"name\":\"added\",\"prototype\":\"void added(\\\"quoted\\\");\"}\n  ]") != NULL);
+    CHECK(strstr(report, "\"removed\":[\n    {\"module\":\"a.c\",\"name\":\"gone\"") != NULL);
+    CHECK(strstr(report, "{\"module\":\"a.c\",\"name\":\"retyped\",\"changes\":{\"prototype\":{\"old\":\"int retyped(int x);\",\"new\":\"long retyped(int x);\"}}}") != NULL);
+    CHECK(strstr(report, "\"name\":\"redocumented\",\"changes\":{\"params\":{\"old\":\"x: Old text.\",\"new\":\"x: New text.\"},\"return\":") != NULL);
+    CHECK(strstr(report, "\"name\":\"same\"") == NULL);
+
+    diffText(oldSnapshot, newSnapshot, DIFF_MARKDOWN, report, sizeof(report));
+    CHECK(strstr(report, "## Added functions (1)") != NULL);
+    CHECK(strstr(report, "## Removed functions (1)") != NULL);
+    CHECK(strstr(report, "## Changed functions (2)") != NULL);
+
+    diffText(oldSnapshot, newSnapshot, DIFF_LATEX, report, sizeof(report));
+    CHECK(strstr(report, "\\begin{document}") != NULL && strstr(report, "\\end{document}") != NULL);
+
+    /* A snapshot compared with itself has no changes */
+    diffText(newSnapshot, newSnapshot, DIFF_JSON, report, sizeof(report));
+    CHECK_STRING(report, "{\n  \"added\":[],\n  \"removed\":[],\n  \"changed\":[]\n}\n");
+
+    destroySnapshot(oldSnapshot);
+    destroySnapshot(newSnapshot);
+    free(docs);
+}
+
+/**
+ * Checks the parsing of report format names, including invalid ones.
+ */
+static void testParseDiffFormat(void) {
+    DiffFormat format = DIFF_LATEX;
+    CHECK(parseDiffFormat("json", &format) && format == DIFF_JSON);
+    CHECK(parseDiffFormat("markdown", &format) && format == DIFF_MARKDOWN);
+    CHECK(parseDiffFormat("latex", &format) && format == DIFF_LATEX);
+    CHECK(!parseDiffFormat("", &format));
+    CHECK(!parseDiffFormat("JSON", &format));
+    CHECK(!parseDiffFormat("md", &format));
+    CHECK(format == DIFF_LATEX);
+}
+
+int main(void) {
+    testRoundTrip();
+    testMalformed();
+    testDiff();
+    testParseDiffFormat();
+    return testResult("test_snapshot");
+}
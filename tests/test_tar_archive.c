@@ -0,0 +1,193 @@
+/**
+ * Module test_tar_archive.c
+ * This module contains the unit tests of the tar reader declared in tar_archive.h.
+ * The archives are built block by block in a temporary stream.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tar_archive.h"
+#include "test.h"
+
+/**
+ * Writes a header block with a valid checksum.
+ * @param stream The stream receiving the block.
+ * @param name Name of the member.
+ * @param type Type flag of the member.
+ * @param size Size of the member, written in octal.
+ * @param base256 true to write the size field as all ones in base-256 instead.
+ */
+static void writeHeader(FILE *stream, const char *name, char type, size_t size, bool base256) {
+    unsigned char block[512];
+    memset(block, 0, sizeof(block));
+    snprintf((char *)block, 100, "%s", name);
+    if (base256) {
+        memset(block + 124, 0xFF, 12);
+    } else {
+        snprintf((char *)block + 124, 12, "%011zo", size);
+    }
+    block[156] = (unsigned char)type;
+    memcpy(block + 257, "ustar", 6);
+    memset(block + 148, ' ', 8);
+    unsigned sum = 0;
+    for (int i = 0; i < 512; i++) {
+        sum += block[i];
+    }
+    snprintf((char *)block + 148, 8, "%06o", sum);
+    fwrite(block, 1, sizeof(block), stream);
+}
+
+/**
+ * Writes the content of a member padded to whole blocks.
+ * @param stream The stream receiving the content.
+ * @param data The content.
+ * @param size Number of bytes of content.
+ */
+static void writeData(FILE *stream, const char *data, size_t size) {
+    static const char zeros[512];
+    fwrite(data, 1, size, stream);
+    fwrite(zeros, 1, (512 - size % 512) % 512, stream);
+}
+
+/**
+ * Writes a regular member.
+ * @param stream The stream receiving the member.
+ * @param name Name of the member.
+ * @param data Content of the member as a string.
+ */
+static void writeMember(FILE *stream, const char *name, const char *data) {
+    writeHeader(stream, name, '0', strlen(data), false);
+    writeData(stream, data, strlen(data));
+}
+
+/**
+ * Writes the end-of-archive marker and rewinds the stream.
+ * @param stream The stream holding the archive.
+ */
+static void finishArchive(FILE *stream) {
+    static const char zeros[1024];
+    fwrite(zeros, 1, sizeof(zeros), stream);
+    rewind(stream);
+}
+
+/**
+ * Checks reading regular members, long names and replaced members.
+ */
+static void testMembers(void) {
+    FILE *stream = tmpfile();
+    writeMember(stream, "./a.c", "int a;\n");
+    writeHeader(stream, "dir/", '5', 0, false);
+    writeHeader(stream, "././@LongLink", 'L', 11, false);
+    writeData(stream, "long/name.h", 11);
+    writeMember(stream, "ignored", "int b;\n");
+    writeMember(stream, "a.c", "int c;\n");
+    finishArchive(stream);
+
+    ccdoc_archive *archive = readTarArchive(stream, 0);
+    fclose(stream);
+    CHECK(archive != NULL);
+    if (archive == NULL) {
+        return;
+    }
+    size_t size = 0;
+    CHECK(archiveMemberCount(archive) == 2);
+    CHECK_STRING(findArchiveMember(archive, "./a.c", &size), "int c;\n");
+    CHECK(size == 7);
+    CHECK_STRING(findArchiveMember(archive, "long/name.h", &size), "int b;\n");
+    CHECK(findArchiveMember(archive, "ignored", &size) == NULL);
+    CHECK_STRING(archiveMemberName(archive, 0), "a.c");
+    CHECK(archiveMemberName(archive, 2) == NULL);
+    destroyArchive(archive);
+}
+
+/**
+ * Checks that a member over the limit is cut one byte past the limit, like a file on disk,
+ * without ending the archive.
+ */
+static void testOversizedMember(void) {
+    char big[2000];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+
+    FILE *stream = tmpfile();
+    writeMember(stream, "big.c", big);
+    writeMember(stream, "small.c", "int s;\n");
+    finishArchive(stream);
+
+    ccdoc_archive *archive = readTarArchive(stream, 1000);
+    fclose(stream);
+    CHECK(archive != NULL);
+    if (archive != NULL) {
+        size_t size;
+        const char *data = findArchiveMember(archive, "big.c", &size);
+        CHECK(data != NULL && size == 1001 && strlen(data) == 1001);
+        CHECK_STRING(findArchiveMember(archive, "small.c", &size), "int s;\n");
+        destroyArchive(archive);
+    }
+}
+
+/**
+ * Checks that a base-256 size of all ones neither wraps the allocation nor reads past the stream.
+ */
+static void testHugeSize(void) {
+    FILE *stream = tmpfile();
+    writeHeader(stream, "huge.c", '0', 0, true);
+    writeData(stream, "int h;\n", 7);
+    finishArchive(stream);
+    CHECK(readTarArchive(stream, 0) == NULL);
+    fclose(stream);
+
+    stream = tmpfile();
+    writeHeader(stream, "././@LongLink", 'L', 0, true);
+    finishArchive(stream);
+    CHECK(readTarArchive(stream, 0) == NULL);
+    fclose(stream);
+}
+
+/**
+ * Checks the rejection of malformed archives.
+ */
+static void testMalformed(void) {
+    /* A corrupted checksum */
+    FILE *stream = tmpfile();
+    writeMember(stream, "a.c", "int a;\n");
+    fseek(stream, 0, SEEK_SET);
+    fputc('b', stream);
+    fseek(stream, 0, SEEK_END);
+    finishArchive(stream);
+    CHECK(readTarArchive(stream, 0) == NULL);
+    fclose(stream);
+
+    /* A member cut short */
+    stream = tmpfile();
+    writeHeader(stream, "a.c", '0', 4096, false);
+    writeData(stream, "int a;\n", 7);
+    rewind(stream);
+    CHECK(readTarArchive(stream, 0) == NULL);
+    fclose(stream);
+
+    /* A header cut short */
+    stream = tmpfile();
+    writeMember(stream, "a.c", "int a;\n");
+    fwrite("partial", 1, 7, stream);
+    rewind(stream);
+    CHECK(readTarArchive(stream, 0) == NULL);
+    fclose(stream);
+
+    /* No end-of-archive marker is accepted */
+    stream = tmpfile();
+    writeMember(stream, "a.c", "int a;\n");
+    rewind(stream);
+    ccdoc_archive *archive = readTarArchive(stream, 0);
+    CHECK(archive != NULL && archiveMemberCount(archive) == 1);
+    destroyArchive(archive);
+    fclose(stream);
+}
+
+int main(void) {
+    testMembers();
+    testOversizedMember();
+    testHugeSize();
+    testMalformed();
+    return testResult("test_tar_archive");
+}
@@ -0,0 +1,317 @@
+/**
+ * Module test_trace.c
+ * This module contains the unit tests of the timeline recorder declared in trace.h.
+ * The written document is read back with a small JSON parser, which collects the spans so
+ * their nesting can be checked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "ccdoc.h"
+#include "trace.h"
+#include "test.h"
+
+/* Maximal number of spans collected from a document. */
+#define MAX_SPANS 4096
+
+/**
+ * @struct Span
+ * @brief One complete event read back from a trace document.
+ */
+typedef struct {
+    long long tid;                    /* Thread of the span. */
+    long long ts;                     /* Start timestamp. */
+    long long dur;                    /* Duration. */
+    bool complete;                    /* The span has the phase "X". */
+} Span;
+
+/**
+ * @struct JSONReader
+ * @brief State of the parser reading a trace document.
+ */
+typedef struct {
+    const char *p;                    /* Next character to read. */
+    Span spans[MAX_SPANS];            /* Spans of the traceEvents array. */
+    int spanCount;                    /* Count of spans. */
+    char detail[256];                 /* Detail of the last span that has one. */
+} JSONReader;
+
+/**
+ * Skips white space.
+ * @param reader The parser.
+ */
+static void skipWhite(JSONReader *reader) {
+    while (*reader->p == ' ' || *reader->p == '\n' || *reader->p == '\r' || *reader->p == '\t') {
+        reader->p++;
+    }
+}
+
+/**
+ * Reads a string, decoding the escapes a trace may hold.
+ * @param reader The parser, positioned at the opening quote.
+ * @param text Buffer receiving the string.
+ * @param size Size of the buffer.
+ * @return true if the string is valid, false otherwise.
+ */
+static bool readString(JSONReader *reader, char *text, size_t size) {
+    size_t length = 0;
+    if (*reader->p++ != '"') {
+        return false;
+    }
+    while (*reader->p != '"') {
+        char c = *reader->p++;
+        if ((unsigned char)c < 0x20) {
+            return false;
+        }
+        if (c == '\\') {
+            c = *reader->p++;
+            if (c == 'n') {
+                c = '\n';
+            } else if (c == 't') {
+                c = '\t';
+            } else if (c == 'u') {
+                char hex[5] = { 0 };
+                for (int i = 0; i < 4; i++) {
+                    if (!isxdigit((unsigned char)reader->p[i])) {
+                        return false;
+                    }
+                    hex[i] = reader->p[i];
+                }
+                c = (char)strtol(hex, NULL, 16);
+                reader->p += 4;
+            } else if (c != '"' && c != '\\' && c != '/' && c != 'r' && c != 'b' && c != 'f') {
+                return false;
+            }
+        }
+        if (length + 1 < size) {
+            text[length++] = c;
+        }
+    }
+    reader->p++;
+    text[length] = '\0';
+    return true;
+}
+
+/**
+ * Reads a value and records the fields of the spans, which are the objects at depth 2.
+ * @param reader The parser.
+ * @param depth Nesting of the value: 0 for the document, 2 for a span.
+ * @param key Name of the member holding the value, empty for an array element.
+ * @return true if the value is valid, false otherwise.
+ */
+static bool readValue(JSONReader *reader, int depth, const char *key) {
+    char text[256];
+    skipWhite(reader);
+    if (*reader->p == '{' || *reader->p == '[') {
+        char close = *reader->p == '{' ? '}' : ']';
+        bool object = close == '}';
+        if (object && depth == 2) {
+            if (reader->spanCount == MAX_SPANS) {
+                return false;
+            }
+            memset(&reader->spans[reader->spanCount++], 0, sizeof(Span));
+        }
+        reader->p++;
+        skipWhite(reader);
+        if (*reader->p == close) {
+            reader->p++;
+            return true;
+        }
+        for (;;) {
+            char member[64] = "";
+            skipWhite(reader);
+            if (object) {
+                if (!readString(reader, member, sizeof(member))) {
+                    return false;
+                }
+                skipWhite(reader);
+                if (*reader->p++ != ':') {
+                    return false;
+                }
+            }
+            if (!readValue(reader, depth + 1, member)) {
+                return false;
+            }
+            skipWhite(reader);
+            if (*reader->p == close) {
+                reader->p++;
+                return true;
+            }
+            if (*reader->p++ != ',') {
+                return false;
+            }
+        }
+    }
+
+    Span *span = depth == 3 ? &reader->spans[reader->spanCount - 1] : NULL;
+    if (*reader->p == '"') {
+        if (!readString(reader, text, sizeof(text))) {
+            return false;
+        }
+        if (span != NULL && strcmp(key, "ph") == 0) {
+            span->complete = strcmp(text, "X") == 0;
+        }
+        if (depth == 4 && strcmp(key, "detail") == 0) {
+            snprintf(reader->detail, sizeof(reader->detail), "%s", text);
+        }
+        return true;
+    }
+    if (*reader->p == '-' || isdigit((unsigned char)*reader->p)) {
+        char *end;
+        long long value = strtoll(reader->p, &end, 10);
+        reader->p = end;
+        if (span != NULL) {
+            if (strcmp(key, "tid") == 0) {
+                span->tid = value;
+            } else if (strcmp(key, "ts") == 0) {
+                span->ts = value;
+            } else if (strcmp(key, "dur") == 0) {
+                span->dur = value;
+            }
+        }
+        return true;
+    }
+    static const char *const WORDS[] = { "true", "false", "null" };
+    for (int i = 0; i < 3; i++) {
+        if (strncmp(reader->p, WORDS[i], strlen(WORDS[i])) == 0) {
+            reader->p += strlen(WORDS[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Compares spans by thread, then by start, then longest first, used with qsort.
+ * @param a Pointer to the first span.
+ * @param b Pointer to the second span.
+ * @return Negative, zero or positive value as with strcmp.
+ */
+static int compareSpans(const void *a, const void *b) {
+    const Span *left = a;
+    const Span *right = b;
+    if (left->tid != right->tid) {
+        return left->tid < right->tid ? -1 : 1;
+    }
+    if (left->ts != right->ts) {
+        return left->ts < right->ts ? -1 : 1;
+    }
+    return left->dur > right->dur ? -1 : left->dur < right->dur;
+}
+
+/**
+ * Checks that the spans of every thread nest: each span ends before the span enclosing it.
+ * @param spans The spans; they are sorted.
+ * @param count Count of spans.
+ * @return true if all spans are complete and balanced, false otherwise.
+ */
+static bool balancedSpans(Span *spans, int count) {
+    long long ends[MAX_SPANS];
+    int depth = 0;
+    qsort(spans, count, sizeof(Span), compareSpans);
+    for (int i = 0; i < count; i++) {
+        if (!spans[i].complete || spans[i].dur < 0) {
+            return false;
+        }
+        if (i > 0 && spans[i].tid != spans[i - 1].tid) {
+            depth = 0;
+        }
+        while (depth > 0 && ends[depth - 1] <= spans[i].ts) {
+            depth--;
+        }
+        if (depth > 0 && spans[i].ts + spans[i].dur > ends[depth - 1]) {
+            return false;
+        }
+        ends[depth++] = spans[i].ts + spans[i].dur;
+    }
+    return true;
+}
+
+/**
+ * Writes a trace and reads it back.
+ * @param trace The recorder.
+ * @param reader The parser receiving the spans.
+ * @return true if the document is valid JSON, false otherwise.
+ */
+static bool readTrace(const Trace *trace, JSONReader *reader) {
+    static char text[1 << 20];
+    FILE *stream = tmpfile();
+    bool written = traceWrite(trace, stream);
+    streamText(stream, text, sizeof(text));
+    fclose(stream);
+
+    reader->p = text;
+    reader->spanCount = 0;
+    reader->detail[0] = '\0';
+    if (!written || !readValue(reader, 0, "")) {
+        return false;
+    }
+    skipWhite(reader);
+    return *reader->p == '\0';
+}
+
+/**
+ * Checks that details with characters special in JSON are escaped.
+ */
+static void testEscapedDetail(void) {
+    static JSONReader reader;
+    Trace *trace = traceCreate();
+    CHECK(trace != NULL);
+    CHECK(readTrace(trace, &reader));
+    CHECK(reader.spanCount == 0);
+
+    long long start = traceBegin(trace);
+    traceEnd(trace, 3, "processFile", "parse", "dir\\\"odd\"\tname\n.c", start);
+    CHECK(readTrace(trace, &reader));
+    CHECK(reader.spanCount == 1 && reader.spans[0].tid == 3);
+    CHECK_STRING(reader.detail, "dir\\\"odd\"\tname\n.c");
+    traceDestroy(trace);
+}
+
+/**
+ * Checks that the spans of parsing and emitting a buffer form a valid, balanced document.
+ */
+static void testContextSpans(void) {
+    static JSONReader reader;
+    static const char SOURCE[] =
+        "/**\n"
+        " * @brief Adds two numbers.\n"
+        " * @param a the first number\n"
+        " * @param b the second number\n"
+        " */\n"
+        "int add(int a, int b);\n"
+        "/**\n"
+        " * @brief Negates a number.\n"
+        " * @param value the number\n"
+        " */\n"
+        "int negate(int value) {\n"
+        "    return -value;\n"
+        "}\n";
+    Trace *trace = traceCreate();
+    ccdoc_context *first = ccdocCreate();
+    ccdoc_context *second = ccdocCreate();
+    FILE *output = tmpfile();
+    ccdocSetTrace(first, trace, 1);
+    ccdocSetTrace(second, trace, 2);
+    CHECK(ccdocAddBuffer(first, "math.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocAddBuffer(second, "other.c", SOURCE, strlen(SOURCE)));
+    CHECK(ccdocEmit(first, output));
+    CHECK(ccdocEmit(second, output));
+    fclose(output);
+
+    CHECK(readTrace(trace, &reader));
+    CHECK(reader.spanCount >= 10);
+    CHECK(balancedSpans(reader.spans, reader.spanCount));
+    CHECK(reader.spans[0].tid == 1 && reader.spans[reader.spanCount - 1].tid == 2);
+    ccdocDestroy(first);
+    ccdocDestroy(second);
+    traceDestroy(trace);
+}
+
+int main(void) {
+    testEscapedDetail();
+    testContextSpans();
+    return testResult("test_trace");
+}
@@ -0,0 +1,145 @@
+/**
+ * Module trace.c
+ * This module implements the timeline recorder declared in trace.h.
+ * Spans are kept in memory as complete events and written as JSON at the end of the run.
+ * Every entry point returns immediately when no recorder is given, so disabled tracing costs
+ * only a pointer check per span. Recording is serialized with a mutex so that contexts on
+ * several threads can share one recorder.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "trace.h"
+#include "utility.h"
+
+/**
+ * @struct TraceEvent
+ * @brief Represents one recorded span.
+ */
+typedef struct {
+    const char *name;                 /* Name of the span. */
+    const char *category;             /* Category of the span. */
+    char detail[256];                 /* Additional text such as a file name. */
+    int threadId;                     /* Identifier of the executing thread. */
+    long long start;                  /* Start timestamp in microseconds. */
+    long long duration;               /* Duration in microseconds. */
+} TraceEvent;
+
+/**
+ * @struct Trace
+ * @brief Growable array of recorded spans.
+ */
+struct Trace {
+    TraceEvent *events;               /* Recorded spans. */
+    int eventCount;                   /* Count of recorded spans. */
+    int eventCapacity;                /* Allocated size of the events array. */
+    long long origin;                 /* Timestamp at creation, used as time zero. */
+    pthread_mutex_t lock;             /* Protects the events array. */
+};
+
+/**
+ * Creates an empty trace recorder whose time zero is the moment of creation.
+ * @return Pointer to the recorder, or NULL if memory could not be allocated.
+ */
+Trace *traceCreate(void) {
+    Trace *trace = calloc(1, sizeof(Trace));
+    if (trace == NULL) {
+        fprintf(stderr, "Error: Unable to allocate trace recorder\n");
+        return NULL;
+    }
+    trace->origin = currentMicroseconds();
+    pthread_mutex_init(&trace->lock, NULL);
+    return trace;
+}
+
+/**
+ * Releases a trace recorder and all recorded spans.
+ * @param trace The recorder to destroy, may be NULL.
+ */
+void traceDestroy(Trace *trace) {
+    if (trace != NULL) {
+        pthread_mutex_destroy(&trace->lock);
+        free(trace->events);
+        free(trace);
+    }
+}
+
+/**
+ * Returns the start timestamp of a span.
+ * @param trace The recorder, or NULL when tracing is disabled.
+ * @return Timestamp in microseconds, or 0 when tracing is disabled.
+ */
+long long traceBegin(const Trace *trace) {
+    if (trace == NULL) {
+        return 0;
+    }
+    return currentMicroseconds();
+}
+
+/**
+ * Records a span that started at the given timestamp and ends now.
+ * Spans are stored as complete events, so nesting follows from their timestamps.
+ * @param trace The recorder, or NULL when tracing is disabled.
+ * @param threadId Identifier of the thread that executed the span.
+ * @param name Name of the span, must be a string literal.
+ * @param category Category of the span, must be a string literal.
+ * @param detail Additional text such as a file name, may be NULL.
+ * @param start Timestamp returned by traceBegin.
+ */
+void traceEnd(Trace *trace, int threadId, const char *name, const char *category, const char *detail, long long start) {
+    if (trace == NULL) {
+        return;
+    }
+    long long end = currentMicroseconds();
+    pthread_mutex_lock(&trace->lock);
+
+    /* Grow the array of events if it is full */
+    if (trace->eventCount == trace->eventCapacity) {
+        int capacity = trace->eventCapacity ? trace->eventCapacity * 2 : 256;
+        TraceEvent *events = realloc(trace->events, capacity * sizeof(TraceEvent));
+        if (events == NULL) {
+            pthread_mutex_unlock(&trace->lock);
+            return;
+        }
+        trace->events = events;
+        trace->eventCapacity = capacity;
+    }
+
+    TraceEvent *event = &trace->events[trace->eventCount++];
+    event->name = name;
+    event->category = category;
+    event->threadId = threadId;
+    event->start = start - trace->origin;
+    event->duration = end - start;
+    snprintf(event->detail, sizeof(event->detail), "%s", detail ? detail : "");
+    pthread_mutex_unlock(&trace->lock);
+}
+
+/**
+ * Writes all recorded spans as a Chrome Trace Event JSON document.
+ * @param trace The recorder holding the spans.
+ * @param outputFile The file where the JSON document is written.
+ * @return true on success, false if an argument is invalid.
+ */
+bool traceWrite(const Trace *trace, FILE *outputFile) {
+    if (trace == NULL || outputFile == NULL) {
+        return false;
+    }
+
+    fprintf(outputFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int i = 0; i < trace->eventCount; i++) {
+        const TraceEvent *event = &trace->events[i];
+        fprintf(outputFile, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+                event->name, event->category, event->threadId, event->start, event->duration);
+        if (event->detail[0] != '\0') {
+            fprintf(outputFile, ",\"args\":{\"detail\":");
+            writeJSONString(outputFile, event->detail);
+            fprintf(outputFile, "}");
+        }
+        fprintf(outputFile, "}%s\n", i + 1 < trace->eventCount ? "," : "");
+    }
+    fprintf(outputFile, "]}\n");
+    return true;
+}
@@ -0,0 +1,70 @@
+/**
+ * Module trace.h
+ * This module contains function prototypes for recording timeline spans and writing them
+ * in the Chrome Trace Event format, which can be loaded in Perfetto or about:tracing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* ____________________________________________________________________________
+
+    Structures and Datatypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * @struct Trace
+ * @brief Opaque recorder collecting the spans of one run.
+ * A recorder may be shared by contexts running on different threads.
+ */
+typedef struct Trace Trace;
+
+/* ____________________________________________________________________________
+
+    Function Prototypes
+   ____________________________________________________________________________
+*/
+
+/**
+ * Creates an empty trace recorder.
+ * @return Pointer to the recorder, or NULL if memory could not be allocated.
+ */
+Trace *traceCreate(void);
+
+/**
+ * Releases a trace recorder and all recorded spans.
+ * @param trace The recorder to destroy, may be NULL.
+ */
+void traceDestroy(Trace *trace);
+
+/**
+ * Returns the start timestamp of a span.
+ * @param trace The recorder, or NULL when tracing is disabled.
+ * @return Timestamp in microseconds, or 0 when tracing is disabled.
+ */
+long long traceBegin(const Trace *trace);
+
+/**
+ * Records a span that started at the given timestamp and ends now.
+ * @param trace The recorder, or NULL when tracing is disabled.
+ * @param threadId Identifier of the thread that executed the span.
+ * @param name Name of the span, must be a string literal.
+ * @param category Category of the span, must be a string literal.
+ * @param detail Additional text such as a file name, may be NULL.
+ * @param start Timestamp returned by traceBegin.
+ */
+void traceEnd(Trace *trace, int threadId, const char *name, const char *category, const char *detail, long long start);
+
+/**
+ * Writes all recorded spans as a Chrome Trace Event JSON document.
+ * @param trace The recorder holding the spans.
+ * @param outputFile The file where the JSON document is written.
+ * @return true on success, false if an argument is invalid.
+ */
+bool traceWrite(const Trace *trace, FILE *outputFile);
+
+#endif 
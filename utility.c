@@ -8,6 +8,9 @@
 #include "utility.h"
 #include <string.h>
 #include <ctype.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
 
 /**
  * Trims leading and trailing whitespace from a string.
@@ -33,3 +36,132 @@ void trimLine(const char *input, char *output) {
     strncpy(output, start, end - start + 1);
     output[end - start + 1] = '\0';
 }
+
+/**
+ * Writes a string as a quoted JSON string literal.
+ * Quotes, backslashes and control characters are escaped, all other bytes are written unchanged.
+ * @param outputFile The file where the literal is written.
+ * @param str The string to be written.
+ */
+void writeJSONString(FILE *outputFile, const char *str) {
+    fputc('"', outputFile);
+    for (const char *p = str; *p; p++) {
+        switch (*p) {
+            case '"': fputs("\\\"", outputFile); break;
+            case '\\': fputs("\\\\", outputFile); break;
+            case '\n': fputs("\\n", outputFile); break;
+            case '\r': fputs("\\r", outputFile); break;
+            case '\t': fputs("\\t", outputFile); break;
+            default:
+                if ((unsigned char)*p < 0x20) {
+                    fprintf(outputFile, "\\u%04x", (unsigned char)*p);
+                } else {
+                    fputc(*p, outputFile);
+                }
+        }
+    }
+    fputc('"', outputFile);
+}
+
+/**
+ * Writes a string as LaTeX text, escaping the characters LaTeX treats specially.
+ * @param outputFile The file where the text is written.
+ * @param str The string to be written.
+ */
+void writeLaTeXString(FILE *outputFile, const char *str) {
+    while (*str) {
+        /* Runs of ordinary characters are written at once */
+        size_t length = strcspn(str, "\\^~{}_&%$#");
+        fwrite(str, 1, length, outputFile);
+        str += length;
+        switch (*str) {
+            case '\0': return;
+            case '\\': fputs("\\textbackslash{}", outputFile); break;
+            case '^': fputs("\\textasciicircum{}", outputFile); break;
+            case '~': fputs("\\textasciitilde{}", outputFile); break;
+            default:
+                fputc('\\', outputFile);
+                fputc(*str, outputFile);
+        }
+        str++;
+    }
+}
+
+/**
+ * Builds the module name of a file, under which a header and its source file are grouped.
+ * The module of a header is named after its source file, as in the LaTeX output.
+ * @param filename The name of the file.
+ * @param moduleName Buffer receiving the module name.
+ * @param size Size of the buffer.
+ */
+void moduleNameOfFile(const char *filename, char *moduleName, size_t size) {
+    snprintf(moduleName, size, "%s", filename);
+    size_t length = strlen(moduleName);
+    if (length >= 2 && strcmp(moduleName + length - 2, ".h") == 0) {
+        moduleName[length - 1] = 'c';
+    }
+}
+
+/**
+ * Extracts the identifier of a function from the name stored by the prototype parser.
+ * Leading pointer declarators are skipped and the parameter list is cut off,
+ * so "*create(void)" gives "create".
+ * @param functionName The function name, possibly with pointer declarators and parameters.
+ * @param identifier Buffer receiving the identifier.
+ * @param size Size of the buffer.
+ */
+void functionIdentifier(const char *functionName, char *identifier, size_t size) {
+    const char *start = functionName;
+    while (*start == '*' || isspace((unsigned char)*start)) {
+        start++;
+    }
+
+    size_t length = 0;
+    while (start[length] != '\0' && start[length] != '(' && !isspace((unsigned char)start[length])) {
+        length++;
+    }
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(identifier, start, length);
+    identifier[length] = '\0';
+}
+
+/**
+ * Resolves a file name to an absolute path without symbolic links and relative components.
+ * Two names of the same file give the same canonical path.
+ * @param filename The name of an existing file.
+ * @param path Buffer receiving the canonical path.
+ * @param size Size of the buffer.
+ * @return true on success, false if the file does not exist or the path does not fit.
+ */
+bool canonicalPath(const char *filename, char *path, size_t size) {
+#ifdef _WIN32
+    return _fullpath(path, filename, size) != NULL;
+#else
+    char *resolved = realpath(filename, NULL);
+    if (resolved == NULL) {
+        return false;
+    }
+    bool fits = strlen(resolved) < size;
+    if (fits) {
+        strcpy(path, resolved);
+    }
+    free(resolved);
+    return fits;
+#endif
+}
+
+/**
+ * Reads a monotonic clock.
+ * @return Current time in microseconds.
+ */
+long long currentMicroseconds(void) {
+    struct timespec now;
+#ifdef _WIN32
+    timespec_get(&now, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+    return (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
@@ -8,6 +8,10 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
 /* ____________________________________________________________________________
 
     Function Prototypes
@@ -21,4 +25,49 @@
  */
 void trimLine(const char *input, char *output);
 
+/**
+ * @brief Writes a string as a quoted JSON string literal.
+ * @param outputFile The file where the literal is written.
+ * @param str The string to be written.
+ */
+void writeJSONString(FILE *outputFile, const char *str);
+
+/**
+ * @brief Writes a string as LaTeX text, escaping the characters LaTeX treats specially.
+ * @param outputFile The file where the text is written.
+ * @param str The string to be written.
+ */
+void writeLaTeXString(FILE *outputFile, const char *str);
+
+/**
+ * @brief Builds the module name of a file, under which a header and its source file are grouped.
+ * @param filename The name of the file.
+ * @param moduleName Buffer receiving the module name.
+ * @param size Size of the buffer.
+ */
+void moduleNameOfFile(const char *filename, char *moduleName, size_t size);
+
+/**
+ * @brief Extracts the identifier of a function from the name stored by the prototype parser.
+ * @param functionName The function name, possibly with pointer declarators and parameters.
+ * @param identifier Buffer receiving the identifier.
+ * @param size Size of the buffer.
+ */
+void functionIdentifier(const char *functionName, char *identifier, size_t size);
+
+/**
+ * @brief Resolves a file name to an absolute path without symbolic links and relative components.
+ * @param filename The name of an existing file.
+ * @param path Buffer receiving the canonical path.
+ * @param size Size of the buffer.
+ * @return true on success, false if the file does not exist or the path does not fit.
+ */
+bool canonicalPath(const char *filename, char *path, size_t size);
+
+/**
+ * @brief Reads a monotonic clock.
+ * @return Current time in microseconds.
+ */
+long long currentMicroseconds(void);
+
 #endif 